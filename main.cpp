@@ -1,6 +1,10 @@
+#include <chrono>
 #include <iostream>
 #include <string>
-#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
 #include <opencv2/opencv.hpp>
 #include <opencv2/core.hpp>
 #include <opencv2/highgui.hpp>
@@ -11,79 +15,349 @@ extern "C"
 #include "vc.h"
 }
 
-void vc_timer(void)
+#include "vc_control.hpp"
+#include "vc_hud.hpp"
+#include "vc_output.hpp"
+#include "vc_overlay.hpp"
+#include "vc_pipeline.hpp"
+#include "vc_pool.hpp"
+#include "vc_results.hpp"
+#include "vc_server.hpp"
+#include "vc_source.hpp"
+#include "vc_stage.h"
+#include "vc_streams.hpp"
+#include "vc_trace.h"
+
+// Escrever o valor da resistência por cima do blob
+void vc_draw_resistance_value(VCOverlay &overlay, const OVC *blob, const RVC *resistor)
 {
-	static bool running = false;
-	static std::chrono::steady_clock::time_point previousTime = std::chrono::steady_clock::now();
+	// Declaração de variáveis
+	char str[32];
+	int x, y;
 
-	if (!running)
+	// Cálculo da posição do texto
+	x = blob->x;
+	y = blob->y - blob->height / 3;
+
+	// Escrever o valor da resistência na imagem
+	snprintf(str, sizeof(str), "Res: %.10g", resistor->value);
+	overlay.add_text(str, x, y);
+
+	// Escrever à frente os valores com a tolerância da resistência
+	// Min
+	snprintf(str, sizeof(str), "Min: %.10g", resistor->value * (1.0 - resistor->tolerance / 100.0));
+	overlay.add_text(str, x, y - 30);
+	// Max
+	snprintf(str, sizeof(str), "Max: %.10g", resistor->value * (1.0 + resistor->tolerance / 100.0));
+	overlay.add_text(str, x, y - 60);
+}
+
+// Texto como string JSON (sem as aspas): aspas, barras invertidas (ex.: caminhos do Windows) e
+// caracteres de controlo escapados
+static std::string vc_json_escape(const char *text)
+{
+	std::string out;
+
+	for (const char *c = text; *c != '\0'; c++)
+	{
+		if ((*c == '"') || (*c == '\\'))
+		{
+			out += '\\';
+			out += *c;
+		}
+		else if ((unsigned char)*c < 0x20)
+		{
+			char code[8];
+			snprintf(code, sizeof(code), "\\u%04x", (unsigned char)*c);
+			out += code;
+		}
+		else
+			out += *c;
+	}
+	return out;
+}
+
+// Modo de benchmark: descodifica as frames para memória e repete o processamento sem janela,
+// para medir só o pipeline de deteção. O resultado é um objeto JSON (uma linha).
+// Uma sequência de frames sem compressão é processada diretamente no ficheiro mapeado.
+int vc_benchmark(VCVideoSource &source, const char *input, int nruns, int maxframes, const char *filename, const VCBlobFilter *filter)
+{
+	int width = source.width;
+	int height = source.height;
+	size_t framesize = (size_t)width * height * 3;
+
+	// Descodificar as frames para memória (fora da medição)
+	int ntotalframes = source.ntotalframes;
+	if ((maxframes > 0) && (maxframes < ntotalframes))
+		ntotalframes = maxframes;
+	bool zerocopy = source.raw.is_open() && !source.raw.compressed();
+	std::vector<unsigned char> cache;
+	std::vector<unsigned char *> frames;
+	if (!zerocopy)
+		cache.reserve(framesize * MAX_VC(ntotalframes, 1));
+
+	IVC image;
+	int nframes = 0;
+	while (((maxframes <= 0) || (nframes < maxframes)) && source.read(&image, false))
 	{
-		running = true;
+		if (zerocopy)
+			frames.push_back(image.data);
+		else
+			cache.insert(cache.end(), image.data, image.data + framesize);
+		nframes++;
 	}
-	else
+	if (nframes == 0)
 	{
-		std::chrono::steady_clock::time_point currentTime = std::chrono::steady_clock::now();
-		std::chrono::steady_clock::duration elapsedTime = currentTime - previousTime;
+		std::cerr << "Erro: o vídeo não tem frames!\n";
+		return 1;
+	}
+	// Só agora: a cache pode ter mudado de sítio ao crescer
+	for (int i = 0; !zerocopy && (i < nframes); i++)
+		frames.push_back(cache.data() + framesize * i);
+
+	VCThreadPool pool;
+	VCPipeline pipeline(width, height, pool);
+	if (filter != NULL)
+		pipeline.set_blob_filter(*filter);
+	image = {NULL, width, height, 3, 255, width * 3};
+
+	// Uma passagem de aquecimento (caches, tabela de cores, páginas das imagens) que não conta
+	image.data = frames[0];
+	pipeline.process(&image);
+	vc_stage_reset();
+
+	// Contagens das deteções, para confirmar que builds diferentes fazem o mesmo trabalho
+	long long ndetections = 0, ndecoded = 0;
+	unsigned long long starttime = vc_stage_now();
+	for (int run = 0; run < nruns; run++)
+	{
+		for (int i = 0; i < nframes; i++)
+		{
+			VCStageTimer timer(VC_STAGE_FRAME);
 
-		// Tempo em segundos.
-		std::chrono::duration<double> time_span = std::chrono::duration_cast<std::chrono::duration<double>>(elapsedTime);
-		double nseconds = time_span.count();
+			image.data = frames[i];
+			pipeline.process(&image);
 
-		std::cout << "Tempo decorrido: " << nseconds << "segundos" << std::endl;
-		std::cout << "Pressione qualquer tecla para continuar...\n";
-		std::cin.get();
+			for (const VCDetection &d : pipeline.detections())
+			{
+				ndetections++;
+				ndecoded += d.decoded;
+			}
+		}
 	}
+	double elapsed = (vc_stage_now() - starttime) / 1e9;
+
+	// Pico de memória residente (em KB no Linux, em bytes no macOS)
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	long peakrss = usage.ru_maxrss / 1024;
+#else
+	long peakrss = usage.ru_maxrss;
+#endif
+
+	FILE *file = (filename != NULL) ? fopen(filename, "w") : stdout;
+	if (file == NULL)
+	{
+		std::cerr << "Erro ao abrir o ficheiro " << filename << "!\n";
+		return 1;
+	}
+
+	long long nprocessed = (long long)nframes * nruns;
+	fprintf(file, "{\"input\":\"%s\",\"width\":%d,\"height\":%d,\"frames\":%d,\"runs\":%d,\"threads\":%u,"
+				  "\"seconds\":%.6f,\"fps\":%.3f,"
+				  "\"latency_us\":{\"mean\":%.3f,\"p50\":%.3f,\"p95\":%.3f,\"p99\":%.3f,\"max\":%.3f},"
+				  "\"peak_rss_kb\":%ld,\"cache_kb\":%lld,\"detections\":%lld,\"decoded\":%lld}\n",
+			vc_json_escape(input).c_str(), width, height, nframes, nruns, pool.size(),
+			elapsed, nprocessed / elapsed,
+			elapsed * 1e6 / nprocessed,
+			vc_stage_percentile(VC_STAGE_FRAME, 50.0) / 1000.0,
+			vc_stage_percentile(VC_STAGE_FRAME, 95.0) / 1000.0,
+			vc_stage_percentile(VC_STAGE_FRAME, 99.0) / 1000.0,
+			vc_stage_percentile(VC_STAGE_FRAME, 100.0) / 1000.0,
+			peakrss, (long long)(cache.size() / 1024), ndetections, ndecoded);
+	if (file != stdout)
+		fclose(file);
+
+	// Tabela das etapas, para consulta
+	vc_stage_report(stderr);
+
+	return 0;
 }
 
-// Escrever o valor da resistência na imagem IVC por cima do blob
-void vc_draw_resistance_value(IVC *srcdst, OVC *blob, int resistencia)
+// Processar vários vídeos em simultâneo no mesmo pool de threads (até maxframes frames de cada um),
+// com o registo de eventos em tracefile (NULL = sem registo)
+int vc_streams(const std::vector<const char *> &inputs, double budget, int maxframes, const char *tracefile, int apiPreference,
+			   const VCBlobFilter *filter)
 {
-	// Declaração de variáveis
-	char str[12];
-	int x, y;
-
-	// Cálculo da posição do texto
-	x = blob->x;
-	y = blob->y - blob->height / 3;
+	VCThreadPool pool;
+	VCStreamRunner runner(pool);
 
-	// Converter a imagem IVC para uma imagem OpenCV
-	cv::Mat frame(srcdst->height, srcdst->width, CV_8UC3, srcdst->data);
+	for (const char *input : inputs)
+		if (!runner.add(input, budget, apiPreference, filter))
+			return 1;
 
-	// Escrever o valor da resistência na imagem
-	snprintf(str, sizeof(str), "Res: %d", resistencia);
-	cv::putText(frame, str, cv::Point(x, y), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 0, 0), 2);
-	cv::putText(frame, str, cv::Point(x, y), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(255, 255, 255), 1);
+	if (tracefile != NULL)
+		vc_trace_start();
+	runner.run(maxframes);
+	if (tracefile != NULL)
+		vc_trace_write(tracefile);
 
-	// Escrever à frente os valores com tolerância de 5%
-	// Min
-	snprintf(str, sizeof(str), "Min: %0.f", resistencia * 0.95);
-	cv::putText(frame, str, cv::Point(x, y - 30), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 0, 0), 2);
-	cv::putText(frame, str, cv::Point(x, y - 30), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(255, 255, 255), 1);
-	snprintf(str, sizeof(str), "Max: %0.f", resistencia * 1.05);
-	// Max
-	cv::putText(frame, str, cv::Point(x, y - 60), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 0, 0), 2);
-	cv::putText(frame, str, cv::Point(x, y - 60), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(255, 255, 255), 1);
+	printf("%d streams, %u threads, budget %.1f ms (latencies in us)\n", runner.count(), pool.size(), budget);
+	runner.report(stdout);
+	vc_stage_report(stdout);
 
-	// Converter a imagem OpenCV para uma imagem IVC
-	memcpy(srcdst->data, frame.data, srcdst->width * srcdst->height * 3);
+	return 0;
 }
 
-int main(void)
+int main(int argc, char *argv[])
 {
-	// Decralação de uma variável para capturar o vídeo
-	cv::VideoCapture capture;
+	// Ficheiro de vídeo a processar
+	const char *input = "/Users/zecastro/Desktop/VC_Trabalho/video_resistors.mp4";
+	// Período (em frames) da escrita das estatísticas das etapas; 0 = só no fim
+	int statsperiod = 0;
+	// Ficheiro para o registo de eventos (Chrome trace); NULL = sem registo
+	const char *tracefile = NULL;
+	// Modo de benchmark: número de repetições, limite de frames em memória e ficheiro do resultado
+	int benchruns = 0, benchframes = 0;
+	const char *benchfile = NULL;
+	// Número máximo de frames processadas de cada vídeo; 0 = até ao fim
+	int maxframes = 0;
+	// Limites das bandas por contornos: usados na descodificação e marcados no vídeo
+	bool bandedges = false;
+	// Gravar as frames lidas numa sequência em bruto (para repetir sem descodificar), com LZ4
+	const char *recordfile = NULL;
+	bool recordlz4 = false;
+	// Gravar o vídeo anotado (numa thread própria): ficheiro, formato, capacidade da fila e se o
+	// ciclo espera pela gravação (em vez de descartar frames) quando a fila está cheia
+	const char *outputfile = NULL;
+	int outputformat = VC_OUTPUT_VIDEO;
+	int outputqueue = 8;
+	bool outputblock = false;
+	// Resultados de cada frame para processamento a jusante (formato pela extensão, "-" = stdout)
+	const char *resultsfile = NULL;
+	// Servidor dos resultados em direto ("tcp:PORTA" ou caminho de um socket Unix), formato
+	// (jsonl, csv ou binary) e frames em fila por subscritor
+	const char *serveaddress = NULL;
+	int serveformat = VC_RESULTS_JSONL;
+	int servequeue = 64;
+	// Sem janela (ex.: gravação do vídeo anotado num servidor)
+	bool window = true;
+	// Vários vídeos (processados em conjunto, sem janela) e o limite de latência de cada frame (ms)
+	std::vector<const char *> inputs;
+	double budget = 0.0;
+	// Tempo real: o vídeo é lido ao ritmo do frame rate, as frames atrasadas são saltadas e a
+	// qualidade baixa enquanto o processamento não cumprir o limite (por omissão, um período)
+	bool realtime = false;
+	// Regras dos blobs candidatos (ficheiro de configuração); NULL = regras por omissão
+	const char *filterfile = NULL;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc)
+			statsperiod = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+			tracefile = argv[++i];
+		else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc)
+			benchruns = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--bench-frames") == 0 && i + 1 < argc)
+			benchframes = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--bench-out") == 0 && i + 1 < argc)
+			benchfile = argv[++i];
+		else if (strcmp(argv[i], "--max-frames") == 0 && i + 1 < argc)
+			maxframes = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--edges") == 0)
+			bandedges = true;
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+			recordfile = argv[++i];
+		else if (strcmp(argv[i], "--lz4") == 0)
+			recordlz4 = true;
+		else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+			outputfile = argv[++i], outputformat = VC_OUTPUT_VIDEO;
+		else if (strcmp(argv[i], "--output-raw") == 0 && i + 1 < argc)
+			outputfile = argv[++i], outputformat = VC_OUTPUT_RAW;
+		else if (strcmp(argv[i], "--output-queue") == 0 && i + 1 < argc)
+			outputqueue = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--output-block") == 0)
+			outputblock = true;
+		else if (strcmp(argv[i], "--results") == 0 && i + 1 < argc)
+			resultsfile = argv[++i];
+		else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc)
+			serveaddress = argv[++i];
+		else if (strcmp(argv[i], "--serve-format") == 0 && i + 1 < argc)
+		{
+			i++;
+			serveformat = (strcmp(argv[i], "csv") == 0) ? VC_RESULTS_CSV : (strcmp(argv[i], "binary") == 0) ? VC_RESULTS_BINARY
+																											 : VC_RESULTS_JSONL;
+		}
+		else if (strcmp(argv[i], "--serve-queue") == 0 && i + 1 < argc)
+			servequeue = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--no-window") == 0)
+			window = false;
+		else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc)
+			budget = atof(argv[++i]);
+		else if (strcmp(argv[i], "--realtime") == 0)
+			realtime = true;
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			filterfile = argv[++i];
+		else if (argv[i][0] != '-')
+			inputs.push_back(argv[i]);
+	}
+	if (inputs.size() == 1)
+		input = inputs[0];
+	// Com os resultados em stdout ("--results -"), as informações e estatísticas vão para stderr
+	bool resultsstdout = (resultsfile != NULL) && (strcmp(resultsfile, "-") == 0);
+	FILE *status = resultsstdout ? stderr : stdout;
+	std::ostream &statusstream = resultsstdout ? std::cerr : std::cout;
+
+	VCBlobFilter blobfilter;
+	if ((filterfile != NULL) && !blobfilter.load(filterfile))
+		return 1;
+	const VCBlobFilter *filter = (filterfile != NULL) ? &blobfilter : NULL;
+
+	// Decralação de uma variável para capturar o vídeo (ou ler uma sequência de frames em bruto)
+	VCVideoSource source;
 	// Escolha de qual método usar para ler
+#ifdef __APPLE__
 	int apiPreference = cv::CAP_AVFOUNDATION;
+#else
+	int apiPreference = cv::CAP_ANY;
+#endif
+	if (inputs.size() > 1)
+	{
+		// As opções de um só vídeo não têm efeito com vários vídeos: recusar em vez de as ignorar
+		const struct
+		{
+			const char *option;
+			bool given;
+		} single[] = {{"--results", resultsfile != NULL}, {"--serve", serveaddress != NULL}, {"--output", outputfile != NULL},
+					  {"--record", recordfile != NULL}, {"--realtime", realtime}, {"--edges", bandedges},
+					  {"--stats", statsperiod > 0}, {"--bench", benchruns > 0}, {"--bench-frames", benchframes > 0},
+					  {"--bench-out", benchfile != NULL}};
+		for (const auto &s : single)
+			if (s.given)
+			{
+				std::cerr << "Erro: " << s.option << " só pode ser usado com um vídeo (foram dados " << inputs.size() << ").\n";
+				return 1;
+			}
+		return vc_streams(inputs, budget, maxframes, tracefile, apiPreference, filter);
+	}
+
 	// Captura do vídeo
-	capture.open("/Users/zecastro/Desktop/VC_Trabalho/video_resistors.mp4", apiPreference);
 	// Verificar foi possível abrir o ficheiro
-	if (!capture.isOpened())
+	if (!source.open(input, apiPreference))
 	{
 		// Em caso de falha, imprime mensagem de erro para o terminal
 		std::cerr << "Erro ao abrir o ficheiro de v�deo!\n";
 		return 1;
 	}
 
+	// Cópia das frames lidas, em paralelo com o processamento
+	if ((recordfile != NULL) && !source.record.open(recordfile, source.width, source.height, 3, source.fps, recordlz4 ? VC_FRAMES_LZ4 : VC_FRAMES_RAW))
+		return 1;
+
+	if (benchruns > 0)
+		return vc_benchmark(source, input, benchruns, benchframes, benchfile, filter);
+
 	// Estrutura para armazenar informações do vídeo
 	struct
 	{
@@ -93,42 +367,109 @@ int main(void)
 		int nframe;
 	} video;
 
-	// Declaração de variável para melhor legibilidade do código
-	std::string str;
 	// Declaração de variável para armazenar a tecla premida pelo utilizador
 	int key = 0;
 
 	// Total de frames do vídeo
-	video.ntotalframes = (int)capture.get(cv::CAP_PROP_FRAME_COUNT);
-	std::cout << "Total de frames: " << video.ntotalframes << std::endl;
+	video.ntotalframes = source.ntotalframes;
+	statusstream << "Total de frames: " << video.ntotalframes << std::endl;
 	// Frame rate do vídeo
-	video.fps = (int)capture.get(cv::CAP_PROP_FPS);
-	std::cout << "Frame rate: " << video.fps << std::endl;
+	video.fps = source.fps;
+	statusstream << "Frame rate: " << video.fps << std::endl;
 	// Resolução do vídeo
-	video.width = (int)capture.get(cv::CAP_PROP_FRAME_WIDTH);
-	video.height = (int)capture.get(cv::CAP_PROP_FRAME_HEIGHT);
-	std::cout << "Resolução: " << video.width << "x" << video.height << std::endl;
+	video.width = source.width;
+	video.height = source.height;
+	statusstream << "Resolução: " << video.width << "x" << video.height << std::endl;
+	video.nframe = 0;
 
 	// Criação de uma janela
-	cv::namedWindow("VC - VIDEO", cv::WINDOW_AUTOSIZE);
+	if (window)
+		cv::namedWindow("VC - VIDEO", cv::WINDOW_AUTOSIZE);
 	// Verificar se a janela foi criada
-	if (!cv::getWindowProperty("VC - VIDEO", cv::WND_PROP_AUTOSIZE))
+	if (window && !cv::getWindowProperty("VC - VIDEO", cv::WND_PROP_AUTOSIZE))
 	{
 		// Se a janela não for criada, imprime uma mensagem de erro e terminar o programa
 		std::cerr << "Erro ao criar a janela!\n";
 		return 1;
 	}
 
+	// Pool de threads para classificar os blobs em paralelo
+	VCThreadPool pool;
+	// Deteção das resistências (as imagens intermédias são criadas uma única vez)
+	VCPipeline pipeline(video.width, video.height, pool);
+	pipeline.set_band_edges(bandedges);
+	if (filter != NULL)
+		pipeline.set_blob_filter(*filter);
+	// Controlador do modo de tempo real
+	unsigned long long period = (video.fps > 0) ? 1000000000ULL / video.fps : 33333333ULL;
+	VCLatencyController control((budget > 0.0) ? (unsigned long long)(budget * 1e6) : period, period);
+	// Anotações de cada frame, desenhadas de uma só vez
+	VCOverlay overlay;
+	// Gravação do vídeo anotado, sem atrasar o ciclo
+	VCVideoOutput output(outputqueue, !outputblock);
+	if ((outputfile != NULL) && !output.open(outputfile, outputformat, video.width, video.height, video.fps))
+		return 1;
+	// Resultados de cada frame, escritos numa thread própria
+	VCResultsSink results;
+	if ((resultsfile != NULL) && !results.open(resultsfile, VCResultsSink::format_from_name(resultsfile)))
+		return 1;
+	// e enviados em direto aos subscritores ligados
+	VCResultsServer server(servequeue);
+	if ((serveaddress != NULL) && !server.open(serveaddress, serveformat))
+		return 1;
+
+	// Informações do vídeo no canto da frame: só o número da frame muda entre frames
+	VCHud hud(4, 20, 25, 25);
+	char hudline[64];
+	snprintf(hudline, sizeof(hudline), "RESOLUCAO: %dx%d", video.width, video.height);
+	hud.set_line(0, hudline);
+	snprintf(hudline, sizeof(hudline), "TOTAL DE FRAMES: %d", video.ntotalframes);
+	hud.set_line(1, hudline);
+	snprintf(hudline, sizeof(hudline), "FRAME RATE: %d", video.fps);
+	hud.set_line(2, hudline);
+
 	// Iniciar o cronómetro
-	vc_timer();
+	unsigned long long starttime = vc_stage_now();
+	int nprocessed = 0;
+	if (tracefile != NULL)
+		vc_trace_start();
+	control.start(starttime);
 
 	// Ciclo para capturar e processar cada frame do vídeo
-	// Declaração de uma variável para armazenar o frame do vídeo
-	cv::Mat frame;
-	while (key != 'q')
+	// Declaração de uma variável para a frame do vídeo (IVC sobre os dados da frame, sem cópia)
+	IVC image;
+	while ((key != 'q') && ((maxframes <= 0) || (nprocessed < maxframes)))
 	{
+		if (realtime)
+		{
+			// Esperar pela chegada da próxima frame e saltar as que já não cumprem o limite
+			unsigned long long wait = control.wait(source.position, vc_stage_now());
+			if (wait > 0)
+				std::this_thread::sleep_for(std::chrono::nanoseconds(wait));
+			while (!control.admit(source.position, vc_stage_now()) && source.skip())
+			{
+			}
+
+			// Qualidade decidida pelo controlador
+			const VCQuality &quality = control.quality();
+			pipeline.set_level(quality.level);
+			pipeline.set_detection_interval(quality.interval);
+		}
+		unsigned long long framestart = vc_stage_now();
+
+		// Tempo total da frame
+		vc_trace_frame(nprocessed + 1);
+		VCStageTimer frametimer(VC_STAGE_FRAME);
+
+		// Leitura (descodificação) do frame
+		bool read;
+		{
+			VCStageTimer timer(VC_STAGE_DECODE);
+			read = source.read(&image, true);
+		}
+
 		// Verifica se o frame foi lido corretamente e se o número de frames lidos é o último
-		if (!capture.read(frame) && video.nframe != video.ntotalframes)
+		if (!read && video.nframe != video.ntotalframes)
 		{
 			// Em caso de erro, imprime mensagem de erro para o terminal
 			std::cerr << "Erro: não foi possível ler o frame do vídeo!\n";
@@ -136,108 +477,119 @@ int main(void)
 		}
 
 		// Verifica se o frame está vazio
-		if (frame.empty())
+		if (!read)
 		{
 			// Quebra o ciclo // O programa só deve entrar aqui se o vídeo acabar!
 			break;
 		}
 
 		// Número do frame a processar
-		video.nframe = (int)capture.get(cv::CAP_PROP_POS_FRAMES);
+		video.nframe = source.position;
 
 		// Escrita de informações do vídeo no frame
-		str = std::string("RESOLUCAO: ").append(std::to_string(video.width)).append("x").append(std::to_string(video.height));
-		cv::putText(frame, str, cv::Point(20, 25), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 0, 0), 2);
-		cv::putText(frame, str, cv::Point(20, 25), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(255, 255, 255), 1);
-		str = std::string("TOTAL DE FRAMES: ").append(std::to_string(video.ntotalframes));
-		cv::putText(frame, str, cv::Point(20, 50), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 0, 0), 2);
-		cv::putText(frame, str, cv::Point(20, 50), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(255, 255, 255), 1);
-		str = std::string("FRAME RATE: ").append(std::to_string(video.fps));
-		cv::putText(frame, str, cv::Point(20, 75), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 0, 0), 2);
-		cv::putText(frame, str, cv::Point(20, 75), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(255, 255, 255), 1);
-		str = std::string("N. DA FRAME: ").append(std::to_string(video.nframe));
-		cv::putText(frame, str, cv::Point(20, 100), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 0, 0), 2);
-		cv::putText(frame, str, cv::Point(20, 100), cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(255, 255, 255), 1);
-
-		// Criação de novas imagens IVC
-		IVC *img[9];
-
-		// TODO: Retirar a criação de novas imagens a cada processo, usar sempre a mesma.
-
-		// Atribuição de valor a um imagem IVC
-		img[0] = vc_image_new(video.width, video.height, 3, 255);
-
-		// Cópia do frame do vídeo para a imagem IVC
-		memcpy(img[0]->data, frame.data, video.width * video.height * 3);
-
-		// Transformação de uma imagem BGR para RGB
-		img[1] = vc_image_new(video.width, video.height, 3, 255);
-		vc_bgr_to_rgb(img[0], img[1]);
-
-		// Transformação de uma imagem RGB para HSV
-		img[2] = vc_image_new(video.width, video.height, 3, 255);
-		vc_rgb_to_hsv(img[1], img[2]);
-
-		// Segmentação de uma imagem HSV
-		img[3] = vc_image_new(video.width, video.height, 1, 255);
-		vc_hsv_segmentation(img[2], img[3], 20, 50, 37, 100, 10, 100);
-
-		// Dilatar e erodir a imagem para remover ruído
-		// NÃO USAMOS PORQUE: não tem ganhos visíveis e aumenta o tempo de processamento
-		// vc_binary_close(img[3], img[4], 3, 3);
-
-		// // Pesquisa de blobs
-		int nblobs;
-		img[4] = vc_image_new(video.width, video.height, 1, 255);
-		OVC *blobs = vc_binary_blob_labelling(img[3], img[4], &nblobs);
-		if (blobs != NULL)
+		snprintf(hudline, sizeof(hudline), "N. DA FRAME: %d", video.nframe);
+		hud.set_line(3, hudline);
+		overlay.clear();
+
+		// Segmentação, blobs e descodificação das bandas
+		pipeline.process(&image);
+		results.write(video.nframe, pipeline.detections());
+		server.publish(video.nframe, pipeline.detections());
+
+		// Percorrer os blobs (em tempo real, as anotações são a primeira coisa a deixar de ser feita)
+		bool annotate = !realtime || control.quality().overlay;
+		for (const VCDetection &d : pipeline.detections())
 		{
-			// Informação dos blobs
-			vc_binary_blob_info(img[4], blobs, nblobs);
+			if (!annotate)
+				break;
+			// Desenhar as bordas e o centro de gravidade
+			overlay.add_blob(&d.blob);
+			// Limites das bandas (linhas verticais na altura do blob)
+			for (int i = 0; i < d.nboundaries; i++)
+				overlay.add_box(d.boundary[i], d.blob.y, 1, d.blob.height);
+			// Desenhar o valor da resistência
+			if (d.decoded)
+				vc_draw_resistance_value(overlay, &d.blob, &d.resistor);
+		}
 
-			// Percorrer os blobs
-			for (int i = 0; i < nblobs; i++)
-			{
-				// Limpeza de blobs indesejados
-				if (blobs[i].width > 100 && blobs[i].height < 100)
-				{
-					// Desenhar o centro de gravidade
-					vc_draw_of_gravity(img[0], &blobs[i]);
-					// Desenhar as bordas na imagem HSV
-					vc_draw_border_box(img[0], &blobs[i]);
-					// Identificar as cores presentes na borda do blob
-					int resistencia = vc_filtro_resistencias(img[2], &blobs[i]);
-					// Desenhar a resistência da resistência
-					vc_draw_resistance_value(img[0], &blobs[i], resistencia);
-				}
-			}
+		if (annotate)
+		{
+			VCStageTimer timer(VC_STAGE_OVERLAY);
+
+			// Desenhar todas as anotações da frame e o HUD diretamente no frame
+			overlay.render(&image);
+			hud.render(&image);
+		}
+
+		// Cópia da frame anotada para a fila de gravação
+		if (output.is_open())
+		{
+			VCStageTimer timer(VC_STAGE_OUTPUT);
+			output.submit(&image);
 		}
 
-		// Copiar a imagem IVC para o frame
-		memcpy(frame.data, img[0]->data, video.width * video.height * 3);
+		if (window)
+		{
+			VCStageTimer timer(VC_STAGE_DISPLAY);
+
+			// Exibe o frame
+			cv::imshow("VC - VIDEO", source.frame);
 
-		// Libertar memória das imagens
-		vc_image_free(img[0]);
-		vc_image_free(img[1]);
-		vc_image_free(img[2]);
-		vc_image_free(img[3]);
-		vc_image_free(img[4]);
+			// Sair da aplicação, se o utilizador premir a tecla 'q'
+			key = cv::waitKey(1);
+		}
 
-		// Exibe o frame
-		cv::imshow("VC - VIDEO", frame);
+		// Custo e latência da frame (índice na origem) para as decisões do controlador
+		if (realtime)
+			control.done(video.nframe - 1, framestart, vc_stage_now());
 
-		// Sair da aplicação, se o utilizador premir a tecla 'q'
-		key = cv::waitKey(1);
+		// Estatísticas periódicas das etapas
+		nprocessed++;
+		if (statsperiod > 0 && nprocessed % statsperiod == 0)
+		{
+			vc_stage_report(status);
+			if (realtime)
+				control.report(status);
+		}
 	}
 
-	// Para o timer e exibe o tempo decorrido
-	vc_timer();
+	// Para o cronómetro e exibe o tempo decorrido e as estatísticas das etapas
+	double elapsed = (vc_stage_now() - starttime) / 1e9;
+	fprintf(status, "Elapsed: %.3f s, %d frames, %.1f fps\n", elapsed, nprocessed, elapsed > 0 ? nprocessed / elapsed : 0.0);
+	// Terminar a gravação antes da tabela, para incluir todas as frames escritas
+	if (output.is_open())
+	{
+		output.close();
+		output.report(status);
+	}
+	if (results.is_open())
+	{
+		results.close();
+		results.report(status);
+	}
+	if (server.is_open())
+	{
+		server.report(status);
+		server.close();
+	}
+	if (realtime)
+		control.report(status);
+	vc_stage_report(status);
+	if (tracefile != NULL)
+		vc_trace_write(tracefile);
 
 	// Fecha a janela
-	cv::destroyWindow("VC - VIDEO");
+	if (window)
+		cv::destroyWindow("VC - VIDEO");
 
 	// Fecha o ficheiro de v�deo
-	capture.release();
+	source.capture.release();
+	if (source.record.is_open())
+	{
+		int nrecorded = source.record.count();
+		if (source.record.close())
+			fprintf(status, "Gravadas %d frames em %s\n", nrecorded, recordfile);
+	}
 
 	return 0;
 }
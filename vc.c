@@ -15,193 +15,508 @@
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+#include <stdint.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
 #include "vc.h"
+#include "vc_stage.h"
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-//            FUN��ES: ALOCAR E LIBERTAR UMA IMAGEM
+//      FUNÇÕES: CÓDIGO DE CORES DAS RESISTÊNCIAS (IEC 60062)
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-// Filtro de vermelho para detetar resistores dentro de um blob
-int vc_filtro_resistencias(IVC *srcdst, OVC *blob)
+// Quantização da tabela HSV -> cor (H com 7 bits, S e V com 5 bits: 128 KB)
+#define VC_LUT_HBITS 7
+#define VC_LUT_SBITS 5
+#define VC_LUT_VBITS 5
+#define VC_LUT_INDEX(h, s, v) ((((h) >> (8 - VC_LUT_HBITS)) << (VC_LUT_SBITS + VC_LUT_VBITS)) | (((s) >> (8 - VC_LUT_SBITS)) << VC_LUT_VBITS) | ((v) >> (8 - VC_LUT_VBITS)))
+
+// Número de linhas amostradas no centro do blob e votos mínimos para uma coluna ter cor
+#define VC_BAND_ROWS 5
+#define VC_BAND_MIN_VOTES 2
+
+// Intervalos HSV de cada cor (H em graus [0,360], S e V em percentagem [0,100]).
+// Os limites são exclusivos e, se hmin > hmax, o intervalo de H dá a volta aos 360 graus.
+// A ordem da tabela é a prioridade: a primeira cor que contém o pixel ganha.
+// Castanho: alargado em relação à versão anterior (H 10..25, V < 51) para H 355..25 e V < 58,
+// medido nas bandas castanhas do vídeo, que ficam abaixo de 10 graus e mais claras. Em H
+// sobrepõe-se ao vermelho (350..10), mas não em V: o vermelho só começa em V 60.
+typedef struct
 {
-	int x, y;
-	int index;
-	int H, S, V;
-	int area;
-	int red, green, blue, black, brown, orange;
-	int total;
-	float red_percentage;
-	float green_percentage;
-	float blue_percentage;
-	float black_percentage;
-	float brown_percentage;
-	float orange_percentage;
-	int blackPos = 0;
-	int redPos = 0;
-	int greenPos = 0;
-	int bluePos = 0;
-	int brownPos = 0;
-	int orangePos = 0;
-
-	struct resistor
-	{
-		char stripe1[10];
-		char stripe2[10];
-		int stripe3;
-	};
-
-	// Get area of the box
-	area = blob->width * blob->height;
-
-	// Initialize color counters
-	red = green = blue = black = brown = orange = 0;
-
-	// Reset percentage values
-	red_percentage = green_percentage = blue_percentage = black_percentage = brown_percentage = orange_percentage = 0.0f;
-
-	// Iterate through 5 horizontal lines in the blob's bounding box center
-	for (y = blob->y + blob->height / 2 - 2; y < blob->y + blob->height / 2 + 3; y++)
-	{
-		// Iterate through each pixel in the blob's bounding box
-		for (x = blob->x; x < blob->x + blob->width; x++)
+	int color;
+	int hmin, hmax;
+	int smin, smax;
+	int vmin, vmax;
+} VC_COLOR_RANGE;
+
+static const VC_COLOR_RANGE vc_color_ranges[] = {
+	{VC_COLOR_BLACK, -1, 361, -1, 30, -1, 34},
+	{VC_COLOR_RED, 350, 10, 45, 75, 60, 80},
+	{VC_COLOR_ORANGE, 5, 17, 65, 80, 80, 100},
+	{VC_COLOR_GREEN, 85, 110, 15, 45, 25, 55},
+	{VC_COLOR_BLUE, 180, 215, 20, 50, 30, 55},
+	{VC_COLOR_BROWN, 355, 25, 30, 52, 30, 58},
+	{VC_COLOR_VIOLET, 260, 320, 20, 60, 20, 60},
+	{VC_COLOR_YELLOW, 45, 65, 70, 100, 60, 100},
+	{VC_COLOR_GOLD, 30, 45, 58, 75, 60, 80},
+	{VC_COLOR_GREY, -1, 361, -1, 12, 34, 65},
+	{VC_COLOR_SILVER, -1, 361, -1, 12, 65, 85},
+	{VC_COLOR_WHITE, -1, 361, -1, 12, 85, 101},
+};
+
+// Multiplicador de cada cor
+static const double vc_color_multiplier[VC_NCOLORS] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e-1, 1e-2};
+
+// Tolerância de cada cor em percentagem (-1 = não é uma cor de tolerância)
+static const float vc_color_tolerance[VC_NCOLORS] = {-1.0f, 1.0f, 2.0f, 0.05f, 0.02f, 0.5f, 0.25f, 0.1f, 0.01f, -1.0f, 5.0f, 10.0f};
+
+// Cor (BGR) usada para marcar os pixeis classificados
+static const unsigned char vc_color_bgr[VC_NCOLORS][3] = {
+	{255, 255, 255}, {0, 255, 255}, {0, 0, 255}, {0, 165, 255}, {0, 255, 255}, {0, 255, 0}, {255, 200, 150}, {211, 0, 148}, {128, 128, 128}, {255, 255, 255}, {0, 215, 255}, {192, 192, 192}};
+
+// Tabela HSV -> cor, preenchida uma única vez por vc_color_table_init()
+static unsigned char vc_color_table[1 << (VC_LUT_HBITS + VC_LUT_SBITS + VC_LUT_VBITS)];
+#ifdef _WIN32
+static INIT_ONCE vc_color_table_once = INIT_ONCE_STATIC_INIT;
+#else
+static pthread_once_t vc_color_table_once = PTHREAD_ONCE_INIT;
+#endif
+
+// Cada célula é classificada pelo seu centro, convertido para graus/percentagem como em vc_hsv_segmentation()
+static void vc_color_table_fill(void)
+{
+	int hq, sq, vq, i;
+	int h, s, v;
+	int nranges = sizeof(vc_color_ranges) / sizeof(vc_color_ranges[0]);
+	const VC_COLOR_RANGE *r;
+	unsigned char color;
+
+	for (hq = 0; hq < (1 << VC_LUT_HBITS); hq++)
+	{
+		for (sq = 0; sq < (1 << VC_LUT_SBITS); sq++)
 		{
-			index = y * srcdst->bytesperline + x * srcdst->channels;
-			H = (int)((float)srcdst->data[index] / 255.0f * 360.0f);
-			S = (int)((float)srcdst->data[index + 1] / 255.0f * 100.0f);
-			V = (int)((float)srcdst->data[index + 2] / 255.0f * 100.0f);
-
-			// Determine the color name based on HSV values
-			// Black
-			if ((H > 0 && H < 360) && (S > 0 && S < 30) && (V > 0 && V < 30))
+			for (vq = 0; vq < (1 << VC_LUT_VBITS); vq++)
 			{
-				srcdst->data[index] = 255;
-				srcdst->data[index + 1] = 255;
-				srcdst->data[index + 2] = 255;
-				black++;
-				blackPos = x;
-			}
-			// Red
-			else if ((H > 0 && H < 10) && (S > 45 && S < 75) && (V > 60 && V < 80))
-			{
-				srcdst->data[index] = 0;
-				srcdst->data[index + 1] = 0;
-				srcdst->data[index + 2] = 255;
-				red++;
-				redPos = x;
+				// Centro da célula, convertido para graus e percentagem
+				h = (int)((float)((hq << (8 - VC_LUT_HBITS)) + (1 << (7 - VC_LUT_HBITS))) / 255.0f * 360.0f);
+				s = (int)((float)((sq << (8 - VC_LUT_SBITS)) + (1 << (7 - VC_LUT_SBITS))) / 255.0f * 100.0f);
+				v = (int)((float)((vq << (8 - VC_LUT_VBITS)) + (1 << (7 - VC_LUT_VBITS))) / 255.0f * 100.0f);
+
+				color = VC_COLOR_NONE;
+				for (i = 0; i < nranges; i++)
+				{
+					r = &vc_color_ranges[i];
+
+					if ((s <= r->smin) || (s >= r->smax) || (v <= r->vmin) || (v >= r->vmax))
+						continue;
+					if ((r->hmin <= r->hmax) ? ((h > r->hmin) && (h < r->hmax)) : ((h > r->hmin) || (h < r->hmax)))
+					{
+						color = (unsigned char)r->color;
+						break;
+					}
+				}
+
+				vc_color_table[(hq << (VC_LUT_SBITS + VC_LUT_VBITS)) | (sq << VC_LUT_VBITS) | vq] = color;
 			}
-			// Orange
-			else if ((H > 5 && H < 17) && (S > 65 && S < 80) && (V > 80 && V < 100))
+		}
+	}
+
+}
+
+#ifdef _WIN32
+static BOOL CALLBACK vc_color_table_fill_once(PINIT_ONCE once, PVOID param, PVOID *context)
+{
+	(void)once;
+	(void)param;
+	(void)context;
+	vc_color_table_fill();
+	return TRUE;
+}
+#endif
+
+// Preencher a tabela de classificação de cores (só na primeira chamada). Pode ser chamada de
+// várias threads ao mesmo tempo: as outras esperam que a tabela fique completa.
+int vc_color_table_init(void)
+{
+#ifdef _WIN32
+	InitOnceExecuteOnce(&vc_color_table_once, vc_color_table_fill_once, NULL, NULL);
+#else
+	pthread_once(&vc_color_table_once, vc_color_table_fill);
+#endif
+
+	return 1;
+}
+
+// Classificar um pixel HSV (H, S e V em [0,255]) numa das cores do código
+int vc_color_classify(unsigned char h, unsigned char s, unsigned char v)
+{
+	vc_color_table_init();
+
+	return vc_color_table[VC_LUT_INDEX(h, s, v)];
+}
+
+// Descodificar uma sequência de bandas lida num só sentido
+static int vc_resistor_decode_order(const int *bands, int nbands, RVC *res)
+{
+	int ndigits = (nbands <= 4) ? 2 : 3;
+	int multiplier = bands[ndigits];
+	float tolerance = 20.0f; // Sem banda de tolerância: 20%
+	double digits = 0.0;
+	int i;
+
+	// Os dígitos vão de preto a branco e o primeiro não pode ser preto
+	for (i = 0; i < ndigits; i++)
+	{
+		if ((bands[i] < VC_COLOR_BLACK) || (bands[i] > VC_COLOR_WHITE))
+			return 0;
+		digits = digits * 10.0 + bands[i];
+	}
+	if (bands[0] == VC_COLOR_BLACK)
+		return 0;
+
+	if ((multiplier < 0) || (multiplier >= VC_NCOLORS))
+		return 0;
+
+	if (nbands > 3)
+	{
+		if ((bands[ndigits + 1] < 0) || (bands[ndigits + 1] >= VC_NCOLORS))
+			return 0;
+		tolerance = vc_color_tolerance[bands[ndigits + 1]];
+		if (tolerance < 0.0f)
+			return 0;
+	}
+
+	// Sexta banda: coeficiente de temperatura (não entra no valor)
+	if ((nbands == 6) && ((bands[5] < 0) || (bands[5] >= VC_NCOLORS)))
+		return 0;
+
+	res->nbands = nbands;
+	for (i = 0; i < nbands; i++)
+		res->bands[i] = bands[i];
+	res->multiplier = vc_color_multiplier[multiplier];
+	res->value = digits * res->multiplier;
+	res->tolerance = tolerance;
+
+	return 1;
+}
+
+// Descodificar o valor de uma resistência a partir das cores das bandas (3 a 6 bandas).
+// Se a leitura da esquerda para a direita não for válida tenta-se o sentido inverso (res->reversed = 1).
+int vc_resistor_decode(const int *bands, int nbands, RVC *res)
+{
+	int reversed[VC_MAX_BANDS];
+	int i;
+
+	if ((bands == NULL) || (res == NULL))
+		return 0;
+	if ((nbands < 3) || (nbands > VC_MAX_BANDS))
+		return 0;
+
+	res->reversed = 0;
+	if (vc_resistor_decode_order(bands, nbands, res))
+		return 1;
+
+	for (i = 0; i < nbands; i++)
+		reversed[i] = bands[nbands - 1 - i];
+
+	res->reversed = 1;
+	return vc_resistor_decode_order(reversed, nbands, res);
+}
+
+// Acrescentar um segmento de cor à lista de bandas.
+// Segmentos estreitos são ignorados e um segmento da mesma cor da última banda, e próximo dela, prolonga-a.
+// Devolve 0 se a lista de bandas exceder VC_MAX_BANDS.
+// *partial conta os segmentos dourados/prateados rejeitados só por serem estreitos.
+static int vc_band_append(int *bands, int *bandstart, int *bandend, int *nbands, int *partial, int color, int start, int end, int minrun, int maxgap)
+{
+	if ((color == VC_COLOR_NONE) || (end - start < minrun))
+		return 1;
+
+	// Dourado e prateado confundem-se com reflexos no corpo: exigem uma banda mais larga
+	if (((color == VC_COLOR_GOLD) || (color == VC_COLOR_SILVER)) && (end - start < 2 * minrun))
+	{
+		(*partial)++;
+		return 1;
+	}
+
+	if ((*nbands > 0) && (bands[*nbands - 1] == color) && (start - bandend[*nbands - 1] <= maxgap))
+	{
+		bandend[*nbands - 1] = end;
+		return 1;
+	}
+
+	if (*nbands == VC_MAX_BANDS)
+		return 0;
+
+	bands[*nbands] = color;
+	bandstart[*nbands] = start;
+	bandend[*nbands] = end;
+	(*nbands)++;
+
+	return 1;
+}
+
+// Amostrar as VC_BAND_ROWS linhas do centro de um blob e classificar cada coluna pela cor mais
+// votada (uma consulta à tabela por pixel). Devolve um buffer (a libertar com free) com as
+// classes dos pixeis (nrows x ncolumns) seguidas das classes das colunas e de uma sentinela
+// VC_COLOR_NONE, ou NULL se o blob não tiver colunas suficientes. *x0 é a primeira coluna na imagem.
+static unsigned char *vc_band_sample(const IVC *src, const OVC *blob, IVC *debug, int *x0, int *ncolumns, int *nrows)
+{
+	const unsigned char *data = (const unsigned char *)src->data;
+	int bytesperline = src->bytesperline;
+	int channels = src->channels;
+	int x, y, c;
+	int x1, y0, y1;
+	long int pos;
+	unsigned char color;
+	unsigned char *pixels, *columns;
+	int votes[VC_NCOLORS + 1];
+
+	// Janela de amostragem: VC_BAND_ROWS linhas no centro do blob, limitadas à imagem
+	*x0 = MAX_VC(blob->x, 0);
+	x1 = MIN_VC(blob->x + blob->width, src->width);
+	y0 = MAX_VC(blob->y + blob->height / 2 - VC_BAND_ROWS / 2, 0);
+	y1 = MIN_VC(blob->y + blob->height / 2 + VC_BAND_ROWS / 2 + 1, src->height);
+	if ((x1 - *x0 < 3) || (y1 <= y0))
+		return NULL;
+	*ncolumns = x1 - *x0;
+	*nrows = y1 - y0;
+
+	pixels = (unsigned char *)malloc(*nrows * *ncolumns + *ncolumns + 1);
+	if (pixels == NULL)
+		return NULL;
+	columns = pixels + *nrows * *ncolumns;
+
+	vc_color_table_init();
+
+	for (x = *x0; x < x1; x++)
+	{
+		memset(votes, 0, sizeof(votes));
+
+		for (y = y0; y < y1; y++)
+		{
+			pos = y * bytesperline + x * channels;
+			color = vc_color_table[VC_LUT_INDEX(data[pos], data[pos + 1], data[pos + 2])];
+			pixels[(y - y0) * *ncolumns + (x - *x0)] = color;
+			votes[color]++;
+		}
+
+		color = VC_COLOR_NONE;
+		for (c = 0; c < VC_NCOLORS; c++)
+		{
+			if ((votes[c] >= VC_BAND_MIN_VOTES) && ((color == VC_COLOR_NONE) || (votes[c] > votes[color])))
+				color = (unsigned char)c;
+		}
+		columns[x - *x0] = color;
+	}
+	columns[*ncolumns] = VC_COLOR_NONE; // Sentinela para fechar o último segmento
+
+	// Marcar os pixeis classificados na imagem de debug
+	if (debug != NULL)
+	{
+		for (y = y0; y < y1; y++)
+		{
+			for (x = *x0; x < x1; x++)
 			{
-				srcdst->data[index] = 0;
-				srcdst->data[index + 1] = 165;
-				srcdst->data[index + 2] = 255;
-				orange++;
-				orangePos = x;
+				color = pixels[(y - y0) * *ncolumns + (x - *x0)];
+				if (color != VC_COLOR_NONE)
+				{
+					pos = y * debug->bytesperline + x * debug->channels;
+					debug->data[pos] = vc_color_bgr[color][0];
+					debug->data[pos + 1] = vc_color_bgr[color][1];
+					debug->data[pos + 2] = vc_color_bgr[color][2];
+				}
 			}
-			// Green
-			else if (H > 85 && H < 110 && S > 15 && S < 45 && V > 25 && V < 55)
+		}
+	}
+
+	return pixels;
+}
+
+// Descodificar as bandas encontradas (colunas bandstart..bandend das amostras) e preencher a
+// confiança de cada uma. Liberta pixels.
+// Três bandas com um segmento dourado/prateado estreito de mais (partial > 0) não são
+// descodificadas: seria uma resistência de 4 bandas lida como 20%.
+static int vc_band_decode(unsigned char *pixels, int ncolumns, int nrows, const int *bands, const int *bandstart, const int *bandend, int nbands, int partial, RVC *res)
+{
+	float confidence[VC_MAX_BANDS];
+	int x, y, i, hits;
+
+	if ((nbands == 3) && (partial > 0))
+	{
+		free(pixels);
+		return 0;
+	}
+
+	// Confiança de cada banda: fração dos pixeis amostrados na banda que têm a cor da banda
+	for (i = 0; i < nbands; i++)
+	{
+		hits = 0;
+		for (y = 0; y < nrows; y++)
+		{
+			for (x = bandstart[i]; x < bandend[i]; x++)
 			{
-				srcdst->data[index] = 0;
-				srcdst->data[index + 1] = 255;
-				srcdst->data[index + 2] = 0;
-				green++;
-				greenPos = x;
+				if (pixels[y * ncolumns + x] == bands[i])
+					hits++;
 			}
-			// Blue
-			else if (H > 180 && H < 215 && S > 20 && S < 50 && V > 30 && V < 55)
+		}
+		confidence[i] = (float)hits / (float)(nrows * (bandend[i] - bandstart[i]));
+	}
+
+	free(pixels);
+
+	if (vc_resistor_decode(bands, nbands, res) == 0)
+		return 0;
+
+	// A confiança segue a ordem de leitura das bandas
+	for (i = 0; i < nbands; i++)
+		res->confidence[i] = res->reversed ? confidence[nbands - 1 - i] : confidence[i];
+
+	return 1;
+}
+
+static int vc_band_check(const IVC *src, const OVC *blob, RVC *res, const IVC *debug)
+{
+	if ((src->width <= 0) || (src->height <= 0) || (src->data == NULL) || (blob == NULL) || (res == NULL))
+		return 0;
+	if (src->channels != 3)
+		return 0;
+	if ((debug != NULL) && ((debug->width != src->width) || (debug->height != src->height) || (debug->channels != 3)))
+		return 0;
+	return 1;
+}
+
+// Identificar as bandas de cor de uma resistência dentro de um blob e descodificar o seu valor.
+// Cada coluna do centro do blob é classificada por votação das linhas amostradas e as colunas
+// são agrupadas em segmentos (run-length) que dão origem às bandas.
+// A imagem HSV não é alterada, pelo que vários blobs podem ser classificados em paralelo.
+// Se debug != NULL, os pixeis classificados são pintados nessa imagem (BGR, com as dimensões de src).
+int vc_filtro_resistencias(const IVC *src, const OVC *blob, RVC *res, IVC *debug)
+{
+	int x, x0, ncolumns, nrows;
+	unsigned char *pixels, *columns;
+	int bands[VC_MAX_BANDS], bandstart[VC_MAX_BANDS], bandend[VC_MAX_BANDS];
+	int nbands = 0;
+	int partial = 0;
+	int minrun, maxgap, runstart;
+	int segcolor, segstart, segend;
+
+	if (!vc_band_check(src, blob, res, debug))
+		return 0;
+	pixels = vc_band_sample(src, blob, debug, &x0, &ncolumns, &nrows);
+	if (pixels == NULL)
+		return 0;
+	columns = pixels + nrows * ncolumns;
+
+	// Agrupar as colunas em segmentos (run-length). Segmentos da mesma cor separados por menos
+	// de maxgap colunas são fragmentos da mesma banda; bandas mais estreitas que minrun são ruído.
+	minrun = MAX_VC(3, ncolumns / 40);
+	maxgap = MAX_VC(2, ncolumns / 15);
+	segcolor = VC_COLOR_NONE;
+	segstart = segend = 0;
+	runstart = 0;
+	for (x = 1; x <= ncolumns; x++)
+	{
+		if (columns[x] == columns[runstart])
+			continue;
+
+		if (columns[runstart] != VC_COLOR_NONE)
+		{
+			if ((columns[runstart] == segcolor) && (runstart - segend <= maxgap))
 			{
-				srcdst->data[index] = 255;
-				srcdst->data[index + 1] = 200;
-				srcdst->data[index + 2] = 150;
-				blue++;
-				bluePos = x;
+				segend = x;
 			}
-			// Brown
-			else if (H > 10 && H < 25 && S > 30 && S < 52 && V > 30 && V < 51)
+			else
 			{
-				srcdst->data[index] = 0;
-				srcdst->data[index + 1] = 255;
-				srcdst->data[index + 2] = 255;
-				brown++;
-				brownPos = x;
+				if (vc_band_append(bands, bandstart, bandend, &nbands, &partial, segcolor, segstart, segend, minrun, maxgap) == 0)
+				{
+					free(pixels);
+					return 0;
+				}
+				segcolor = columns[runstart];
+				segstart = runstart;
+				segend = x;
 			}
 		}
-	}
 
-	/*
-	//// DEBUGGING //////////////////////////////////////////
-	// Compare the number of pixels of each color summed up and determine what's the percentage of each color compared to the total area
-	total = red + green + blue + black + brown + orange;
-	red_percentage = (float)red / total * 100;
-	green_percentage = (float)green / total * 100;
-	blue_percentage = (float)blue / total * 100;
-	black_percentage = (float)black / total * 100;
-	brown_percentage = (float)brown / total * 100;
-	orange_percentage = (float)orange / total * 100;
-
-	// Print the results
-	printf("Red: %.2f%%\n", red_percentage);
-	printf("Green: %.2f%%\n", green_percentage);
-	printf("Blue: %.2f%%\n", blue_percentage);
-	printf("Black: %.2f%%\n", black_percentage);
-	printf("Brown: %.2f%%\n", brown_percentage);
-	printf("Orange: %.2f%%\n", orange_percentage);
-	printf("Total: %d\n", total);
-	printf("Area: %d\n", area);
-	printf("\n\n");
-	*/
-
-	// Compare the widths and order the colors and store its color in the resistor struct
-	struct resistor res;
-	// green, blue and red
-	if (greenPos < bluePos && bluePos < redPos)
-	{
-		strcpy(res.stripe1, "5");
-		strcpy(res.stripe2, "6");
-		res.stripe3 = 100;
-	}
-	// brown, black, orange
-	else if (brownPos < blackPos && blackPos < orangePos)
-	{
-		strcpy(res.stripe1, "1");
-		strcpy(res.stripe2, "0");
-		res.stripe3 = 1000;
-	}
-	// brown, black, red
-	else if (brownPos < blackPos && blackPos < redPos)
-	{
-		strcpy(res.stripe1, "1");
-		strcpy(res.stripe2, "0");
-		res.stripe3 = 100;
-	}
-	// red, red and brown
-	else if (redPos < brownPos)
-	{
-		strcpy(res.stripe1, "2");
-		strcpy(res.stripe2, "2");
-		res.stripe3 = 10;
-	}
-	// red, red, red
-	else
+		runstart = x;
+	}
+	if (vc_band_append(bands, bandstart, bandend, &nbands, &partial, segcolor, segstart, segend, minrun, maxgap) == 0)
 	{
-		strcpy(res.stripe1, "2");
-		strcpy(res.stripe2, "2");
-		res.stripe3 = 100;
+		free(pixels);
+		return 0;
 	}
 
-	// Print the resistor value in ohms
-	// printf("Resistor value: %s %s %d\n", res.stripe1, res.stripe2, res.stripe3);
+	return vc_band_decode(pixels, ncolumns, nrows, bands, bandstart, bandend, nbands, partial, res);
+}
+
+// Como vc_filtro_resistencias, mas com os limites das bandas dados por contornos (colunas na
+// imagem, por ordem crescente, ex.: VCPipeline::set_band_edges) em vez das transições de cor:
+// cada intervalo entre dois limites consecutivos (e entre o blob e o primeiro/último limite)
+// tem a cor da maioria das suas colunas, se pelo menos metade delas tiver cor; senão é corpo.
+int vc_filtro_resistencias_limites(const IVC *src, const OVC *blob, const int *boundary, int nboundaries, RVC *res, IVC *debug)
+{
+	int x, i, c, x0, ncolumns, nrows;
+	unsigned char *pixels, *columns;
+	int votes[VC_NCOLORS + 1];
+	int bands[VC_MAX_BANDS], bandstart[VC_MAX_BANDS], bandend[VC_MAX_BANDS];
+	int nbands = 0;
+	int partial = 0;
+	int minrun, maxgap;
+	int start, end, color;
+
+	if (!vc_band_check(src, blob, res, debug) || ((boundary == NULL) && (nboundaries > 0)) || (nboundaries < 0))
+		return 0;
+	pixels = vc_band_sample(src, blob, debug, &x0, &ncolumns, &nrows);
+	if (pixels == NULL)
+		return 0;
+	columns = pixels + nrows * ncolumns;
 
-	// Concatenate the resistor value in ohms
-	char resistorValue[10];
-	strcpy(resistorValue, res.stripe1);
-	strcat(resistorValue, res.stripe2);
-	int resValue = atoi(resistorValue) * res.stripe3;
+	minrun = MAX_VC(3, ncolumns / 40);
+	maxgap = MAX_VC(2, ncolumns / 15);
+	start = 0;
+	for (i = 0; i <= nboundaries; i++)
+	{
+		// Fim do intervalo, em colunas da amostra (o último vai até ao fim do blob)
+		end = (i < nboundaries) ? MIN_VC(MAX_VC(boundary[i] - x0, 0), ncolumns) : ncolumns;
+		if (end <= start)
+			continue;
+
+		memset(votes, 0, sizeof(votes));
+		for (x = start; x < end; x++)
+			votes[columns[x]]++;
+
+		color = VC_COLOR_NONE;
+		for (c = 0; c < VC_NCOLORS; c++)
+		{
+			if ((color == VC_COLOR_NONE) || (votes[c] > votes[color]))
+				color = c;
+		}
+		if (votes[color] * 2 < end - start)
+			color = VC_COLOR_NONE;
 
-	// Print the resistor value in ohms
+		if (vc_band_append(bands, bandstart, bandend, &nbands, &partial, color, start, end, minrun, maxgap) == 0)
+		{
+			free(pixels);
+			return 0;
+		}
+		start = end;
+	}
 
-	// printf("Resistor value: %d\n", resValue);
-	return resValue;
+	return vc_band_decode(pixels, ncolumns, nrows, bands, bandstart, bandend, nbands, partial, res);
 }
 
 // Filters
@@ -371,327 +686,98 @@ int vc_gray_lowpass_median_filter(IVC *src, IVC *dst, int kernel)
 	return 1;
 }
 
-int vc_gray_gaussian_filter(IVC *src, IVC *dst)
+// vc_gray_gaussian_filter(), vc_gray_highpass_laplacian_filter() e vc_gray_edge_prewitt(): ver vc_kernels.cpp
+
+// Histogram
+int vc_color_equalize_image(IVC *src, IVC *dst)
 {
-	unsigned char *datasrc = (unsigned char *)src->data;
-	unsigned char *datadst = (unsigned char *)dst->data;
+	// histogram para a saturação e o valor da imagem
+	unsigned char *datasrc = src->data;
+	unsigned char *datadst = dst->data;
 	int width = src->width;
 	int height = src->height;
 	int bytesperline = src->bytesperline;
 	int channels = src->channels;
-	int x, y;
+	int x, y, i;
 	long int pos;
-	int i, j;
-	int size = (5 - 1) / 2;
-	int grad;
-	float mask[5][5] = {{1, 4, 7, 4, 1},
-						{4, 16, 26, 16, 4},
-						{7, 26, 41, 26, 7},
-						{4, 16, 26, 16, 4},
-						{1, 4, 7, 4, 1}};
+	int histogramsaturation[256] = {0}; // Initialize histogram arrays
+	int histogramvalue[256] = {0};
 
-	// Verifica��o de erros
-	if ((src->width <= 0) || (src->height <= 0) || (src->data == NULL))
+	// Check if destination image pointer is valid
+	if (datadst == NULL)
 	{
-		printf("vc_gray_gaussian_filter() - Erro nos parametros de entrada.\n");
+		printf("vc_color_equalize_image() - Invalid destination image pointer.\n");
 		return 0;
 	}
-	if (channels != 1)
+
+	// Initialize destination image to zeros
+	memset(datadst, 0, bytesperline * height);
+
+	// Calculate histograms for saturation and value
+	for (y = 0; y < height; y++)
 	{
-		printf("vc_gray_gaussian_filter() - A imagem de entrada n�o � de cinzentos.\n");
-		return 0;
+		for (x = 0; x < width; x++)
+		{
+			pos = y * bytesperline + x * channels;
+			histogramsaturation[datasrc[pos + 1]]++;
+			histogramvalue[datasrc[pos + 2]]++;
+		}
 	}
 
-	// Normaliza��o factor de escala
-	float norm_factor = 1.0f / 273.0f;
+	// Calculate cumulative distribution functions (CDF) for saturation and value
+	int cdfsaturation[256];
+	int cdfvalue[256];
+	cdfsaturation[0] = histogramsaturation[0];
+	cdfvalue[0] = histogramvalue[0];
+	for (i = 1; i < 256; i++)
+	{
+		cdfsaturation[i] = cdfsaturation[i - 1] + histogramsaturation[i];
+		cdfvalue[i] = cdfvalue[i - 1] + histogramvalue[i];
+	}
 
-	// Convolu��o para x e y
-	for (y = size; y < height - size; y++)
+	// Find the minimum non-zero CDF value for saturation and value
+	int cdf_min_saturation = 0;
+	int cdf_min_value = 0;
+	for (i = 0; i < 256; i++)
 	{
-		for (x = size; x < width - size; x++)
+		if (cdfsaturation[i] != 0)
 		{
-			pos = y * bytesperline + x * channels;
-			grad = 0;
+			cdf_min_saturation = cdfsaturation[i];
+			break;
+		}
+	}
+	for (i = 0; i < 256; i++)
+	{
+		if (cdfvalue[i] != 0)
+		{
+			cdf_min_value = cdfvalue[i];
+			break;
+		}
+	}
 
-			// M�scara de convolu��o: Gaussian
-			for (j = -size; j <= size; j++)
+	// Normalize the histogram
+	for (y = 0; y < height; y++)
+	{
+		for (x = 0; x < width; x++)
+		{
+			pos = y * bytesperline + x * channels;
+			// Ensure cdf_min is not zero to avoid division by zero
+			datadst[pos] = datasrc[pos];
+			if (cdfsaturation[255] - cdf_min_saturation != 0)
 			{
-				for (i = -size; i <= size; i++)
-				{
-					pos = (y + j) * bytesperline + (x + i) * channels;
-					grad += (int)(datasrc[pos]) * mask[j + 2][i + 2];
-				}
+				datadst[pos + 1] = (unsigned char)(((cdfsaturation[datasrc[pos + 1]] - cdf_min_saturation) / (float)(cdfsaturation[255] - cdf_min_saturation)) * 255);
+			}
+			if (cdfvalue[255] - cdf_min_value != 0)
+			{
+				datadst[pos + 2] = (unsigned char)(((cdfvalue[datasrc[pos + 2]] - cdf_min_value) / (float)(cdfvalue[255] - cdf_min_value)) * 255);
 			}
-
-			// Armazena o valor na imagem destino
-			pos = y * bytesperline + x * channels;
-			datadst[pos] = (unsigned char)(grad * norm_factor);
 		}
 	}
 
 	return 1;
 }
 
-int vc_gray_highpass_laplacian_filter(IVC *src, IVC *dst)
-{
-	unsigned char *datasrc = (unsigned char *)src->data;
-	unsigned char *datadst = (unsigned char *)dst->data;
-	int width = src->width;
-	int height = src->height;
-	int bytesperline = src->bytesperline;
-	int channels = src->channels;
-	int x, y;
-	long int pos;
-	int i, j;
-	int size = 3;
-	int mask[3][3] = {{0, -1, 0}, {-1, 4, -1}, {0, -1, 0}};
-	int mask2[3][3] = {{-1, -1, -1}, {-1, 8, -1}, {-1, -1, -1}};
-	int mask3[3][3] = {{1, -2, 1}, {-2, 4, -2}, {1, -2, 1}};
-	float norm_factor = 1.0f / 6.0f;
-	float norm_factor2 = 1.0f / 9.0f;
-	float norm_factor3 = 1.0f / 3.0f;
-	float grad;
-
-	// Verifica��o de erros
-	if ((src->width <= 0) || (src->height <= 0) || (src->data == NULL))
-	{
-		printf("vc_gray_highpass_laplacian_filter() - Erro nos parametros de entrada.\n");
-		return 0;
-	}
-	if (channels != 1)
-	{
-		printf("vc_gray_highpass_laplacian_filter() - A imagem de entrada n�o � de cinzentos.\n");
-		return 0;
-	}
-
-	// convolu��o para x e y
-	for (y = 0; y < height; y++)
-	{
-		for (x = 0; x < width; x++)
-		{
-			grad = 0;
-
-			// M�scara de convolu��o: Laplacian
-			for (j = 0; j < size; j++)
-			{
-				for (i = 0; i < size; i++)
-				{
-					pos = (y + j - 2) * bytesperline + (x + i - 2) * channels;
-					grad += (int)(datasrc[pos]) * mask[j][i];
-				}
-			}
-
-			grad = fabs(grad);
-
-			// Armazena o valor na imagem destino
-			pos = y * bytesperline + x * channels;
-			datadst[pos] = (unsigned char)(grad * norm_factor);
-		}
-	}
-
-	return 1;
-}
-
-// Contornos
-int vc_gray_edge_prewitt(IVC *src, IVC *dst, float th)
-{
-	unsigned char *datasrc = (unsigned char *)src->data;
-	unsigned char *datadst = (unsigned char *)dst->data;
-	int width = src->width;
-	int height = src->height;
-	int bytesperline = src->bytesperline;
-	int channels = src->channels;
-	int x, y;
-	long int pos;
-	int size = 3;
-	float grad, sumX, sumY;
-	float maskX[3][3] = {{-1, 0, 1}, {-1, 0, 1}, {-1, 0, 1}};
-	float maskY[3][3] = {{-1, -1, -1}, {0, 0, 0}, {1, 1, 1}};
-
-	// Verifica��o de erros
-	if ((src->width <= 0) || (src->height <= 0) || (src->data == NULL))
-	{
-		printf("vc_gray_edge_prewitt() - Erro nos parametros de entrada.\n");
-		return 0;
-	}
-	if (channels != 1)
-	{
-		printf("vc_gray_edge_prewitt() - A imagem de entrada n�o � de cinzentos.\n");
-		return 0;
-	}
-
-	// Limiar de detec��o de arestas
-	if ((th < 0) || (th > 1))
-	{
-		printf("vc_gray_edge_prewitt() - O limiar de detec��o de arestas tem que estar entre 0 e 1.\n");
-		return 0;
-	}
-
-	// Limpa imagem destino
-	memset(datadst, 0, bytesperline * height);
-
-	// C�lculo da magnitude do gradiente
-	for (y = 1; y < height - 1; y++)
-	{
-		for (x = 1; x < width - 1; x++)
-		{
-			pos = y * bytesperline + x * channels;
-			sumX = 0;
-			sumY = 0;
-
-			// M�scara de convolu��o: Prewitt
-			for (int l = 0; l < size; l++)
-			{
-				for (int m = 0; m < size; m++)
-				{
-					pos = (y + l - 1) * bytesperline + (x + m - 1) * channels;
-					sumX += (float)(datasrc[pos]) * maskX[l][m];
-					sumY += (float)(datasrc[pos]) * maskY[l][m];
-				}
-			}
-
-			// Magnitude do gradiente
-			grad = 1 * sqrt(2) * sqrt(sumX * sumX + sumY * sumY);
-
-			// Armazena o valor na imagem destino
-			datadst[y * bytesperline + x * channels] = (unsigned char)grad;
-		}
-	}
-
-	// Calcular histograma
-	int histogram[256] = {0};
-	for (y = 0; y < height; y++)
-	{
-		for (x = 0; x < width; x++)
-		{
-			pos = y * bytesperline + x * channels;
-			histogram[datadst[pos]]++;
-		}
-	}
-
-	// Calculate threshold value based on percentage
-	int threshold = 0;
-	int sum = 0;
-	int total_pixels = width * height;
-	float target_sum = total_pixels * th; // Convertendo o percentual em número de pixels
-
-	// Calculating threshold value based on histogram accumulation
-	for (int i = 0; i < 256; i++)
-	{
-		sum += histogram[i];
-		if (sum >= target_sum)
-		{
-			threshold = i;
-			break;
-		}
-	}
-
-	// Binarization of the image based on threshold
-	for (y = 0; y < height; y++)
-	{
-		for (x = 0; x < width; x++)
-		{
-			pos = y * bytesperline + x * channels;
-			if (datadst[pos] > threshold)
-				datadst[pos] = 255; // Pintar pixel de branco se a magnitude for maior que o limite
-			else
-				datadst[pos] = 0; // Pintar pixel de preto caso contrário
-		}
-	}
-
-	return 1;
-}
-
-// Histogram
-int vc_color_equalize_image(IVC *src, IVC *dst)
-{
-	// histogram para a saturação e o valor da imagem
-	unsigned char *datasrc = src->data;
-	unsigned char *datadst = dst->data;
-	int width = src->width;
-	int height = src->height;
-	int bytesperline = src->bytesperline;
-	int channels = src->channels;
-	int x, y, i;
-	long int pos;
-	int histogramsaturation[256] = {0}; // Initialize histogram arrays
-	int histogramvalue[256] = {0};
-
-	// Check if destination image pointer is valid
-	if (datadst == NULL)
-	{
-		printf("vc_color_equalize_image() - Invalid destination image pointer.\n");
-		return 0;
-	}
-
-	// Initialize destination image to zeros
-	memset(datadst, 0, bytesperline * height);
-
-	// Calculate histograms for saturation and value
-	for (y = 0; y < height; y++)
-	{
-		for (x = 0; x < width; x++)
-		{
-			pos = y * bytesperline + x * channels;
-			histogramsaturation[datasrc[pos + 1]]++;
-			histogramvalue[datasrc[pos + 2]]++;
-		}
-	}
-
-	// Calculate cumulative distribution functions (CDF) for saturation and value
-	int cdfsaturation[256];
-	int cdfvalue[256];
-	cdfsaturation[0] = histogramsaturation[0];
-	cdfvalue[0] = histogramvalue[0];
-	for (i = 1; i < 256; i++)
-	{
-		cdfsaturation[i] = cdfsaturation[i - 1] + histogramsaturation[i];
-		cdfvalue[i] = cdfvalue[i - 1] + histogramvalue[i];
-	}
-
-	// Find the minimum non-zero CDF value for saturation and value
-	int cdf_min_saturation = 0;
-	int cdf_min_value = 0;
-	for (i = 0; i < 256; i++)
-	{
-		if (cdfsaturation[i] != 0)
-		{
-			cdf_min_saturation = cdfsaturation[i];
-			break;
-		}
-	}
-	for (i = 0; i < 256; i++)
-	{
-		if (cdfvalue[i] != 0)
-		{
-			cdf_min_value = cdfvalue[i];
-			break;
-		}
-	}
-
-	// Normalize the histogram
-	for (y = 0; y < height; y++)
-	{
-		for (x = 0; x < width; x++)
-		{
-			pos = y * bytesperline + x * channels;
-			// Ensure cdf_min is not zero to avoid division by zero
-			datadst[pos] = datasrc[pos];
-			if (cdfsaturation[255] - cdf_min_saturation != 0)
-			{
-				datadst[pos + 1] = (unsigned char)(((cdfsaturation[datasrc[pos + 1]] - cdf_min_saturation) / (float)(cdfsaturation[255] - cdf_min_saturation)) * 255);
-			}
-			if (cdfvalue[255] - cdf_min_value != 0)
-			{
-				datadst[pos + 2] = (unsigned char)(((cdfvalue[datasrc[pos + 2]] - cdf_min_value) / (float)(cdfvalue[255] - cdf_min_value)) * 255);
-			}
-		}
-	}
-
-	return 1;
-}
-
-int vc_gray_equalize_image(IVC *src, IVC *dst)
+int vc_gray_equalize_image(IVC *src, IVC *dst)
 {
 	int x, y;
 	long int pos;
@@ -989,6 +1075,7 @@ OVC *vc_binary_blob_labelling(IVC *src, IVC *dst, int *nlabels)
 	int labeltable[256] = {0};
 	int labelarea[256] = {0};
 	int ranktable[256] = {0};
+	int labelxmin[256], labelymin[256], labelxmax[256], labelymax[256];
 	int label = 1;
 	int num, tmplabel;
 	OVC *blobs;
@@ -1010,6 +1097,8 @@ OVC *vc_binary_blob_labelling(IVC *src, IVC *dst, int *nlabels)
 		return NULL;
 	}
 
+	VC_STAGE_BEGIN(VC_STAGE_LABELLING);
+
 	// Copy binary image data to grayscale image
 	memcpy(datadst, datasrc, bytesperline * height);
 
@@ -1060,6 +1149,13 @@ OVC *vc_binary_blob_labelling(IVC *src, IVC *dst, int *nlabels)
 
 				if (minLabel == label)
 				{
+					// A imagem de etiquetas só guarda 255 etiquetas: os objetos seguintes são ignorados
+					if (label > 255)
+					{
+						datadst[posX] = 0;
+						continue;
+					}
+
 					labeltable[label] = label;
 					label++;
 				}
@@ -1121,7 +1217,17 @@ OVC *vc_binary_blob_labelling(IVC *src, IVC *dst, int *nlabels)
 		}
 	}
 
-	// Re-label the image after merging close blobs using union-find
+	// Re-label the image after merging close blobs using union-find.
+	// A caixa e a área de cada blob saem desta passagem (sem custo extra), para os filtros de
+	// tamanho poderem excluir blobs antes de vc_binary_blob_info
+	for (i = 0; i < 256; i++)
+	{
+		labelxmin[i] = width - 1;
+		labelymin[i] = height - 1;
+		labelxmax[i] = 0;
+		labelymax[i] = 0;
+		labelarea[i] = 0;
+	}
 	for (y = 1; y < height - 1; y++)
 	{
 		for (x = 1; x < width - 1; x++)
@@ -1130,7 +1236,18 @@ OVC *vc_binary_blob_labelling(IVC *src, IVC *dst, int *nlabels)
 
 			if (datadst[posX] != 0)
 			{
-				datadst[posX] = find(labeltable, datadst[posX]);
+				tmplabel = find(labeltable, datadst[posX]);
+				datadst[posX] = tmplabel;
+
+				labelarea[tmplabel]++;
+				if (labelxmin[tmplabel] > x)
+					labelxmin[tmplabel] = x;
+				if (labelymin[tmplabel] > y)
+					labelymin[tmplabel] = y;
+				if (labelxmax[tmplabel] < x)
+					labelxmax[tmplabel] = x;
+				if (labelymax[tmplabel] < y)
+					labelymax[tmplabel] = y;
 			}
 		}
 	}
@@ -1160,22 +1277,33 @@ OVC *vc_binary_blob_labelling(IVC *src, IVC *dst, int *nlabels)
 	if (*nlabels == 0)
 	{
 		// printf("vc_binary_blob_labelling() --> No objects found!\n");
+		VC_STAGE_END(VC_STAGE_LABELLING);
 		return NULL;
 	}
 
-	// Create list of blobs (objects) and fill the label
+	// Create list of blobs (objects) and fill the label, bounding box and area
 	blobs = (OVC *)calloc((*nlabels), sizeof(OVC));
 	if (blobs != NULL)
 	{
 		for (a = 0; a < (*nlabels); a++)
-			blobs[a].label = labeltable[a];
+		{
+			tmplabel = labeltable[a];
+			blobs[a].label = tmplabel;
+			blobs[a].x = labelxmin[tmplabel];
+			blobs[a].y = labelymin[tmplabel];
+			blobs[a].width = (labelxmax[tmplabel] - labelxmin[tmplabel]) + 1;
+			blobs[a].height = (labelymax[tmplabel] - labelymin[tmplabel]) + 1;
+			blobs[a].area = labelarea[tmplabel];
+		}
 	}
 	else
 	{
 		printf("vc_binary_blob_labelling() --> Memory Allocation Error!\n");
+		VC_STAGE_END(VC_STAGE_LABELLING);
 		return NULL;
 	}
 
+	VC_STAGE_END(VC_STAGE_LABELLING);
 	return blobs;
 }
 
@@ -1189,6 +1317,7 @@ int vc_binary_blob_info(IVC *src, OVC *blobs, int nblobs)
 	int x, y, i;
 	long int pos;
 	int xmin, ymin, xmax, ymax;
+	int x0, y0, x1, y1;
 	long int sumx, sumy;
 
 	// Verificao de erros
@@ -1197,6 +1326,8 @@ int vc_binary_blob_info(IVC *src, OVC *blobs, int nblobs)
 	if (channels != 1)
 		return 0;
 
+	VC_STAGE_BEGIN(VC_STAGE_BLOBINFO);
+
 	// Conta rea de cada blob
 	for (i = 0; i < nblobs; i++)
 	{
@@ -1208,11 +1339,24 @@ int vc_binary_blob_info(IVC *src, OVC *blobs, int nblobs)
 		sumx = 0;
 		sumy = 0;
 
+		// Só a caixa do blob, se vc_binary_blob_labelling a preencheu; a imagem toda, caso contrário
+		x0 = 1;
+		y0 = 1;
+		x1 = width - 2;
+		y1 = height - 2;
+		if ((blobs[i].width > 0) && (blobs[i].height > 0))
+		{
+			x0 = MAX_VC(blobs[i].x, 1);
+			y0 = MAX_VC(blobs[i].y, 1);
+			x1 = MIN_VC(blobs[i].x + blobs[i].width - 1, width - 2);
+			y1 = MIN_VC(blobs[i].y + blobs[i].height - 1, height - 2);
+		}
+
 		blobs[i].area = 0;
 
-		for (y = 1; y < height - 1; y++)
+		for (y = y0; y <= y1; y++)
 		{
-			for (x = 1; x < width - 1; x++)
+			for (x = x0; x <= x1; x++)
 			{
 				pos = y * bytesperline + x * channels;
 
@@ -1258,6 +1402,7 @@ int vc_binary_blob_info(IVC *src, OVC *blobs, int nblobs)
 		blobs[i].yc = sumy / MAX_VC(blobs[i].area, 1);
 	}
 
+	VC_STAGE_END(VC_STAGE_BLOBINFO);
 	return 1;
 }
 
@@ -1478,225 +1623,31 @@ int vc_binary_close(IVC *src, IVC *dst, int kernel, int kernel2)
 	return 1;
 }
 
-int vc_binary_erode(IVC *src, IVC *dst, int kernel)
-{
-	int width, height, channels, bytesperline;
-	long int pos, posk;
-	unsigned char *datasrc, *datadst;
+// vc_binary_erode(), vc_binary_dilate() e vc_gray_to_binary_niblack(): ver vc_kernels.cpp
 
-	// Verificação de erros
-	if ((src->width <= 0) || (src->height <= 0) || (src->data == NULL) || (dst->data == NULL))
-		return 0;
-	if (src->channels != 1)
+int vc_gray_to_binary_bernsen(IVC *src, IVC *dst, int kernel, int cMin)
+{
+	if (src == NULL || dst == NULL || src->data == NULL || dst->data == NULL)
+	{
+		printf("Error -> vc_gray_to_binary_midpoint():\n\tImage is empty!\n");
 		return 0;
-	if (dst->channels != 1)
+	}
+	if (src->width != dst->width || src->height != dst->height || src->channels != 1 || dst->channels != 1)
+	{
+		printf("Error -> vc_gray_to_binary_midpoint():\n\tImage is not grayscale!\n");
 		return 0;
+	}
 
-	// Atribuição das variáveis
-	width = src->width;
-	height = src->height;
-	channels = src->channels;
-	datasrc = (unsigned char *)src->data;
-	datadst = (unsigned char *)dst->data;
-	bytesperline = width * channels;
-	int offset = (kernel - 1) / 2; // Corrigindo a fórmula para calcular o offset
-
-	// Percorrer a imagem e aplicar a operação de erosão
-	for (int y = 0; y < height; y++)
-	{
-		for (int x = 0; x < width; x++)
-		{
-			pos = y * bytesperline + x * channels;
-			// Verificar se o pixel central é branco
-			if (datasrc[pos] == 255)
-			{
-				int erosion = 1; // Variável para indicar se ocorreu erosão
-				// Percorrer a vizinhança
-				for (int i = -offset; i <= offset; i++)
-				{
-					for (int j = -offset; j <= offset; j++)
-					{
-						int new_y = y + i;
-						int new_x = x + j;
-						if (new_y >= 0 && new_y < height && new_x >= 0 && new_x < width)
-						{
-							posk = new_y * bytesperline + new_x * channels;
-							// Se algum pixel na vizinhança for preto, realizar a erosão
-							if (datasrc[posk] == 0)
-							{
-								erosion = 0; // Não realizar erosão neste caso
-								break;		 // Sair do loop interno
-							}
-						}
-					}
-					if (erosion == 0)
-						break; // Sair do loop externo
-				}
-				// Se nenhum pixel na vizinhança for preto, realizar a erosão
-				if (erosion == 1)
-				{
-					datadst[pos] = 255; // Preencher o pixel central com branco
-				}
-				else
-				{
-					datadst[pos] = 0; // Caso contrário, preencher o pixel central com preto
-				}
-			}
-			else
-			{
-				datadst[pos] = 0; // Se o pixel central não for branco, preencher com preto
-			}
-		}
-	}
-
-	return 1;
-}
-
-int vc_binary_dilate(IVC *src, IVC *dst, int kernel)
-{
-	int width, height, channels, bytesperline;
-	long int pos, posk;
-	unsigned char *datasrc, *datadst;
-	int offset = (kernel - 1) / 2;
-
-	// Verificação de erros
-	if ((src->width <= 0) || (src->height <= 0) || (src->data == NULL) || (dst->data == NULL))
-		return 0;
-	if (src->channels != 1)
-		return 0;
-	if (dst->channels != 1)
-		return 0;
-
-	// Atribuição das variáveis
-	width = src->width;
-	height = src->height;
-	channels = src->channels;
-	datasrc = (unsigned char *)src->data;
-	datadst = (unsigned char *)dst->data;
-	bytesperline = width * channels;
-
-	// percorrer os pixeis e se encontrar um pixel branco, preencher a vizinhança com branco
-	for (int y = 0; y < height; y++)
-	{
-		for (int x = 0; x < width; x++)
-		{
-			pos = y * bytesperline + x * channels;
-			unsigned char pixel = 0; // Initialize to black
-
-			for (int i = -offset; i <= offset; i++)
-			{
-				for (int j = -offset; j <= offset; j++)
-				{
-					int new_y = y + i;
-					int new_x = x + j;
-
-					// Check boundaries
-					if (new_y >= 0 && new_y < height && new_x >= 0 && new_x < width)
-					{
-						posk = new_y * bytesperline + new_x * channels;
-						pixel |= datasrc[posk]; // Perform OR operation with neighboring pixel
-					}
-				}
-			}
-			datadst[pos] = pixel;
-		}
-	}
-	return 1;
-}
-
-int vc_gray_to_binary_niblack(IVC *src, IVC *dst, int kernel, float k)
-{
-	int x, y;
-	int width, height, channels, bytesperline;
-	long int pos, pos_dst, posk;
-	unsigned char *datasrc, *datadst, mean, sdeviation;
-	float offset, threshold;
-
-	// Verificação de erros
-	if ((src->width <= 0) || (src->height <= 0) || (src->channels <= 0) || (src->levels <= 0) || (src->data == NULL) || (dst->data == NULL))
-		return 0;
-
-	// Atribuição das variáveis
-	width = src->width;
-	height = src->height;
-	channels = src->channels;
-	datasrc = (unsigned char *)src->data;
-	datadst = (unsigned char *)dst->data;
-	offset = (kernel - 1) / 2;
-	bytesperline = width * channels;
-
-	// Percorrer todos os pixels para fazer a média e o desvio padrão
-	for (y = 0; y < height; y++)
-	{
-		for (x = 0; x < width; x++)
-		{
-			int sum = 0;
-			int count = 0;
-			for (int i = -offset; i <= offset; i++)
-			{
-				for (int j = -offset; j <= offset; j++)
-				{
-					int new_y = y + i;
-					int new_x = x + j;
-					if (new_y >= 0 && new_y < height && new_x >= 0 && new_x < width)
-					{
-						posk = (new_y * width + new_x) * channels; // Ajuste da fórmula de posição
-						sum += datasrc[posk];
-						count++;
-					}
-				}
-			}
-			mean = sum / count;
-			sdeviation = 0.0f;
-			for (int i = -offset; i <= offset; i++)
-			{
-				for (int j = -offset; j <= offset; j++)
-				{
-					int new_y = y + i;
-					int new_x = x + j;
-					if (new_y >= 0 && new_y < height && new_x >= 0 && new_x < width)
-					{
-						posk = (new_y * width + new_x) * channels; // Ajuste da fórmula de posição
-						sdeviation += (datasrc[posk] - mean) * (datasrc[posk] - mean);
-					}
-				}
-			}
-			sdeviation = sqrtf(sdeviation / (count > 0 ? count : 1)); // Evitar divisão por zero
-			threshold = mean + k * sdeviation;
-			pos_dst = (y * width + x) * channels; // Ajuste da fórmula de posição
-
-			if (datasrc[pos_dst] > threshold)
-				datadst[pos_dst] = 255;
-			else
-				datadst[pos_dst] = 0;
-		}
-	}
-	return 1; // Retornar 1 para indicar sucesso
-}
-
-int vc_gray_to_binary_bernsen(IVC *src, IVC *dst, int kernel, int cMin)
-{
-	if (src == NULL || dst == NULL || src->data == NULL || dst->data == NULL)
-	{
-		printf("Error -> vc_gray_to_binary_midpoint():\n\tImage is empty!\n");
-		return 0;
-	}
-	if (src->width != dst->width || src->height != dst->height || src->channels != 1 || dst->channels != 1)
-	{
-		printf("Error -> vc_gray_to_binary_midpoint():\n\tImage is not grayscale!\n");
-		return 0;
-	}
-
-	unsigned char *datasrc = (unsigned char *)src->data;
-	unsigned char *datadst = (unsigned char *)dst->data;
-	int width = src->width;
-	int height = src->height;
-	int channels_src = src->channels;
-	int channels_dst = dst->channels;
-	int bytesperline_src = src->width * src->channels;
-	int bytesperline_dst = dst->width * dst->channels;
-	int x, y;
-	long int pos_src, pos_dst;
+	unsigned char *datasrc = (unsigned char *)src->data;
+	unsigned char *datadst = (unsigned char *)dst->data;
+	int width = src->width;
+	int height = src->height;
+	int channels_src = src->channels;
+	int channels_dst = dst->channels;
+	int bytesperline_src = src->width * src->channels;
+	int bytesperline_dst = dst->width * dst->channels;
+	int x, y;
+	long int pos_src, pos_dst;
 
 	int sum = 0;
 	int count = 0;
@@ -1892,50 +1843,7 @@ int vc_gray_to_binary_global_mean(IVC *src, IVC *dst)
 	return 1;
 }
 
-// thresholding gray image
-int vc_gray_to_binary(IVC *src, IVC *dst, int threshold)
-{
-	if (src == NULL || dst == NULL || src->data == NULL || dst->data == NULL)
-	{
-		printf("Error -> vc_gray_to_binary():\n\tImage is empty!\n");
-		return 0;
-	}
-	if (src->width != dst->width || src->height != dst->height || src->channels != 1 || dst->channels != 1)
-	{
-		printf("Error -> vc_gray_to_binary():\n\tImage is not grayscale!\n");
-		return 0;
-	}
-
-	unsigned char *datasrc = (unsigned char *)src->data;
-	unsigned char *datadst = (unsigned char *)dst->data;
-	int width = src->width;
-	int height = src->height;
-	int channels_src = src->channels;
-	int channels_dst = dst->channels;
-	int x, y;
-	long int pos_src, pos_dst;
-
-	// thresholding
-	for (y = 0; y < height; y++)
-	{
-		for (x = 0; x < width; x++)
-		{
-			pos_src = y * width + x;
-			pos_dst = y * width + x;
-
-			if (datasrc[pos_src] > threshold)
-			{
-				datadst[pos_dst] = 255;
-			}
-			else
-			{
-				datadst[pos_dst] = 0;
-			}
-		}
-	}
-
-	return 1;
-}
+// thresholding gray image: vc_gray_to_binary() em vc_kernels.cpp
 
 // get area of the brain segmentation
 int vc_segmentation_area(IVC *src)
@@ -2015,39 +1923,7 @@ int vc_binary_area(IVC *src)
 	return count;
 }
 
-// Converter uma imagem BGR para uma imagem RGB
-int vc_bgr_to_rgb(IVC *src, IVC *dst)
-{
-	if (src == NULL || dst == NULL || src->data == NULL || dst->data == NULL)
-		return 0;
-	if (src->width != dst->width || src->height != dst->height || src->channels != 3 || dst->channels != 3)
-		return 0;
-
-	unsigned char *datasrc = (unsigned char *)src->data;
-	unsigned char *datadst = (unsigned char *)dst->data;
-	int width = src->width;
-	int height = src->height;
-	int channels_src = src->channels;
-	int channels_dst = dst->channels;
-	int x, y;
-	long int pos_src, pos_dst;
-
-	// converter imagem BGR para imagem RGB
-	for (y = 0; y < height; y++)
-	{
-		for (x = 0; x < width; x++)
-		{
-			pos_src = y * width * 3 + x * 3;
-			pos_dst = y * width * 3 + x * 3;
-
-			datadst[pos_dst] = datasrc[pos_src + 2];
-			datadst[pos_dst + 1] = datasrc[pos_src + 1];
-			datadst[pos_dst + 2] = datasrc[pos_src];
-		}
-	}
-
-	return 1;
-}
+// Converter uma imagem BGR para uma imagem RGB: vc_bgr_to_rgb() em vc_kernels.cpp
 
 // Convert a grayscale image to a 3-level image
 int vc_binary_to_3_channels(IVC *src, IVC *dst)
@@ -2167,50 +2043,7 @@ int vc_gray_to_rgb(IVC *src, IVC *dst)
 	return 1;
 }
 
-// Segmentar uma imagem HSV
-int vc_hsv_segmentation(IVC *src, IVC *dst, int hmin, int hmax, int smin, int smax, int vmin, int vmax)
-{
-	if (src == NULL || dst == NULL || src->data == NULL || dst->data == NULL)
-	{
-		printf("Error -> vc_hsv_segmentation():\n\tImage is empty!\n");
-		return 0;
-	}
-	if (src->width != dst->width || src->height != dst->height || src->channels != 3 || dst->channels != 1)
-	{
-		printf("Error -> vc_hsv_segmentation():\n\tImages dimensions or channels mismatch!\n");
-		return 0;
-	}
-
-	unsigned char *datasrc = (unsigned char *)src->data;
-	unsigned char *datadst = (unsigned char *)dst->data;
-	int width = src->width;
-	int height = src->height;
-	int channels_src = src->channels;
-	int channels_dst = dst->channels;
-	int x, y;
-	long int pos_src, pos_dst;
-	int h, s, v;
-
-	int size = width * height * channels_src;
-
-	for (int i = 0; i < size; i = i + channels_src)
-	{
-		h = (int)((float)datasrc[i] / 255.0f * 360.0f);
-		s = (int)((float)datasrc[i + 1] / 255.0f * 100.0f);
-		v = (int)((float)datasrc[i + 2] / 255.0f * 100.0f);
-
-		if ((h >= hmin && h <= hmax) && (s >= smin && s <= smax) && (v >= vmin && v <= vmax))
-		{
-			datadst[i / channels_src] = 255;
-		}
-		else
-		{
-			datadst[i / channels_src] = 0;
-		}
-	}
-
-	return 1;
-}
+// Segmentar uma imagem HSV: vc_hsv_segmentation() em vc_kernels.cpp
 
 // Transformar uma imagem HSV para uma imagem RGB
 int vc_hsv_to_rgb(IVC *src, IVC *dst)
@@ -2403,43 +2236,7 @@ int vc_rgb_to_hsv(IVC *src, IVC *dst)
 	return 1;
 }
 
-// Transformar uma imagem RGB para uma imagem cinzenta
-int vc_rgb_to_gray(IVC *src, IVC *dst)
-{
-	if (src == NULL || dst == NULL || src->data == NULL || dst->data == NULL)
-		return 0;
-	if (src->width != dst->width || src->height != dst->height || src->channels != 3 || dst->channels != 1)
-		return 0;
-
-	unsigned char *datasrc = (unsigned char *)src->data;
-	unsigned char *datadst = (unsigned char *)dst->data;
-	int width = src->width;
-	int height = src->height;
-	int channels_src = src->channels;
-	int channels_dst = dst->channels;
-	int bytesperline_src = width * channels_src;
-	int bytesperline_dst = width * channels_dst;
-	int x, y;
-	long int pos_src, pos_dst;
-	float rf, gf, bf;
-
-	for (y = 0; y < height; y++)
-	{
-		for (x = 0; x < width; x++)
-		{
-			pos_src = y * bytesperline_src + x * channels_src;
-			pos_dst = y * bytesperline_dst + x * channels_dst;
-
-			rf = (float)datasrc[pos_src];
-			gf = (float)datasrc[pos_src + 1];
-			bf = (float)datasrc[pos_src + 2];
-
-			datadst[pos_dst] = (unsigned char)((rf * 0.299) + (gf * 0.587) + (bf * 0.114));
-		}
-	}
-
-	return 1;
-}
+// Transformar uma imagem RGB para uma imagem cinzenta: vc_rgb_to_gray() em vc_kernels.cpp
 
 // Extrair o canal vermelho de uma imagem RGB
 int vc_rgb_get_red_gray(IVC *srcdst)
@@ -2525,61 +2322,7 @@ int vc_rgb_get_blue_gray(IVC *srcdst)
 	return 1;
 };
 
-// Inverter uma imagem a cores
-int vc_rgb_negative(IVC *srcdst)
-{
-	unsigned char *data = (unsigned char *)srcdst->data;
-	int width = srcdst->width;
-	int height = srcdst->height;
-	int bytesperline = srcdst->width * srcdst->channels;
-	int channels = srcdst->channels;
-	int x, y;
-	long int pos;
-	// Verificação de erros
-	if ((srcdst->width <= 0) || (srcdst->height <= 0) || (srcdst->data == NULL))
-		return 0;
-	if (channels != 3)
-		return 0;
-	// Inverte a imagem RGB
-	for (y = 0; y < height; y++)
-	{
-		for (x = 0; x < width; x++)
-		{
-			pos = y * bytesperline + x * channels;
-			data[pos] = 255 - data[pos];
-			data[pos + 1] = 255 - data[pos + 1];
-			data[pos + 2] = 255 - data[pos + 2];
-		}
-	}
-	return 1;
-}
-
-// Inverter uma imagem cinzenta
-int vc_gray_negative(IVC *srcdst)
-{
-	unsigned char *data = (unsigned char *)srcdst->data;
-	int width = srcdst->width;
-	int height = srcdst->height;
-	int bytesperline = srcdst->width * srcdst->channels;
-	int channels = srcdst->channels;
-	int x, y;
-	long int pos;
-	// Verificação de erros
-	if ((srcdst->width <= 0) || (srcdst->height <= 0) || (srcdst->data == NULL))
-		return 0;
-	if (channels != 1)
-		return 0;
-	// Inverte a imagem Gray
-	for (y = 0; y < height; y++)
-	{
-		for (x = 0; x < width; x++)
-		{
-			pos = y * bytesperline + x * channels;
-			data[pos] = 255 - data[pos];
-		}
-	}
-	return 1;
-}
+// Inverter uma imagem a cores/cinzenta: vc_rgb_negative() e vc_gray_negative() em vc_kernels.cpp
 
 // Alocar mem�ria para uma imagem
 IVC *vc_image_new(int width, int height, int channels, int levels)
@@ -2628,307 +2371,565 @@ IVC *vc_image_free(IVC *image)
 //    FUN��ES: LEITURA E ESCRITA DE IMAGENS (PBM, PGM E PPM)
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-char *netpbm_get_token(FILE *file, char *tok, int len)
+// Ficheiro inteiro em memória: mapeado (POSIX, cópia só das páginas alteradas) ou lido de uma
+// só vez (outros sistemas)
+typedef struct
+{
+	unsigned char *data;
+	size_t size;
+} VCFileMap;
+
+static int vc_file_map(const char *filename, VCFileMap *map)
+{
+#ifdef _WIN32
+	FILE *file = fopen(filename, "rb");
+	long int size;
+
+	if (file == NULL)
+		return 0;
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	map->data = (size > 0) ? (unsigned char *)malloc(size) : NULL;
+	map->size = (size_t)size;
+	if ((map->data == NULL) || (fread(map->data, 1, map->size, file) != map->size))
+	{
+		free(map->data);
+		fclose(file);
+		return 0;
+	}
+	fclose(file);
+	return 1;
+#else
+	struct stat st;
+	void *data;
+	int fd = open(filename, O_RDONLY);
+
+	if (fd < 0)
+		return 0;
+	if ((fstat(fd, &st) != 0) || (st.st_size <= 0))
+	{
+		close(fd);
+		return 0;
+	}
+
+	// MAP_PRIVATE com escrita: a imagem pode ser alterada sem mudar o ficheiro
+	data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return 0;
+	madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+	map->data = (unsigned char *)data;
+	map->size = (size_t)st.st_size;
+	return 1;
+#endif
+}
+
+static void vc_file_unmap(VCFileMap *map)
+{
+#ifdef _WIN32
+	free(map->data);
+#else
+	munmap(map->data, map->size);
+#endif
+	map->data = NULL;
+	map->size = 0;
+}
+
+// Próximo número do cabeçalho a partir de *pos, saltando espaços e comentários.
+// No fim *pos fica no carácter a seguir ao número.
+static int netpbm_header_int(const VCFileMap *map, size_t *pos, int *value)
 {
-	char *t;
-	int c;
+	size_t p = *pos;
+	long int v = 0;
+	int digits = 0;
 
 	for (;;)
 	{
-		while (isspace(c = getc(file)))
-			;
-		if (c != '#')
-			break;
-		do
-			c = getc(file);
-		while ((c != '\n') && (c != EOF));
-		if (c == EOF)
+		while ((p < map->size) && isspace(map->data[p]))
+			p++;
+		if ((p >= map->size) || (map->data[p] != '#'))
 			break;
+		while ((p < map->size) && (map->data[p] != '\n'))
+			p++;
+	}
+
+	while ((p < map->size) && isdigit(map->data[p]) && (v <= 0x7fffffff / 10))
+	{
+		v = v * 10 + (map->data[p++] - '0');
+		digits++;
 	}
 
-	t = tok;
+	*pos = p;
+	*value = (int)v;
+	return (digits > 0) && (v <= 0x7fffffff) && ((p >= map->size) || isspace(map->data[p]) || (map->data[p] == '#'));
+}
+
+// Interpreta o cabeçalho no próprio ficheiro mapeado. *offset: início dos pixeis;
+// *datasize: bytes de pixeis (verificados contra o tamanho do ficheiro).
+static int netpbm_parse_header(const VCFileMap *map, int *width, int *height, int *channels, int *levels, size_t *offset, size_t *datasize)
+{
+	size_t pos = 2;
 
-	if (c != EOF)
+	if ((map->size < 2) || (map->data[0] != 'P') || ((map->data[1] != '4') && (map->data[1] != '5') && (map->data[1] != '6')))
 	{
-		do
-		{
-			*t++ = c;
-			c = getc(file);
-		} while ((!isspace(c)) && (c != '#') && (c != EOF) && (t - tok < len - 1));
+#ifdef VC_DEBUG
+		printf("ERROR -> vc_read_image():\n\tFile is not a valid PBM, PGM or PPM file.\n\tBad magic number!\n");
+#endif
+		return 0;
+	}
 
-		if (c == '#')
-			ungetc(c, file);
+	*channels = (map->data[1] == '6') ? 3 : 1;
+	*levels = (map->data[1] == '4') ? 1 : 255;
+
+	if (!netpbm_header_int(map, &pos, width) || !netpbm_header_int(map, &pos, height) || (*width <= 0) || (*height <= 0) ||
+		((*levels != 1) && (!netpbm_header_int(map, &pos, levels) || (*levels <= 0) || (*levels > 255))))
+	{
+#ifdef VC_DEBUG
+		printf("ERROR -> vc_read_image():\n\tFile is not a valid PBM, PGM or PPM file.\n\tBad size!\n");
+#endif
+		return 0;
 	}
 
-	*t = 0;
+	// Um único espaço separa o cabeçalho dos pixeis
+	*offset = pos + 1;
+	if (*levels == 1)
+		*datasize = (size_t)(*width / 8 + ((*width % 8) ? 1 : 0)) * *height;
+	else
+		*datasize = (size_t)*width * *height * *channels;
+
+	if (*offset + *datasize > map->size)
+	{
+#ifdef VC_DEBUG
+		printf("ERROR -> vc_read_image():\n\tPremature EOF on file.\n");
+#endif
+		return 0;
+	}
 
-	return tok;
+	return 1;
 }
 
-long int unsigned_char_to_bit(unsigned char *datauchar, unsigned char *databit, int width, int height)
+// Empacotamento de bits por palavras: 8 pixeis de cada vez com aritmética de 64 bits (16 com SSE2)
+// em vez de um teste por bit. A disposição é a do PBM: primeiro pixel no bit mais significativo,
+// bit 1 = pixel 0 (preto). As linhas começam sempre num byte novo.
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define VC_PACK_WORDS // Os truques de 64 bits assumem que o byte 0 da palavra é o primeiro pixel
+#endif
+
+#ifdef VC_PACK_WORDS
+// 8 pixeis -> 1 byte: 0x80 nos bytes nulos (teste exato), depois os 8 bits altos são juntos no
+// byte de topo por uma multiplicação (0x8040201008040201 leva o bit do byte i para o bit 63 - i)
+static unsigned char vc_pack8(const unsigned char *pixels)
 {
-	int x, y;
-	int countbits;
-	long int pos, counttotalbytes;
-	unsigned char *p = databit;
+	uint64_t v, zero;
 
-	*p = 0;
-	countbits = 1;
-	counttotalbytes = 0;
+	memcpy(&v, pixels, 8);
+	zero = ~(((v & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | v) & 0x8080808080808080ULL;
+	return (unsigned char)(((zero >> 7) * 0x8040201008040201ULL) >> 56);
+}
 
-	for (y = 0; y < height; y++)
-	{
-		for (x = 0; x < width; x++)
-		{
-			pos = width * y + x;
+// 1 byte -> 8 pixeis 0/white: o byte é replicado, cada byte i fica só com o bit 7 - i e é reduzido
+// a 0/1 (a multiplicação por white não passa de um byte para o seguinte)
+static void vc_unpack8(unsigned char bits, unsigned char *pixels, unsigned char white)
+{
+	uint64_t v = ((uint64_t)(unsigned char)~bits * 0x0101010101010101ULL) & 0x0102040810204080ULL;
 
-			if (countbits <= 8)
-			{
-				// Numa imagem PBM:
-				// 1 = Preto
-				// 0 = Branco
-				//*p |= (datauchar[pos] != 0) << (8 - countbits);
+	v = (((v + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL) * white;
+	memcpy(pixels, &v, 8);
+}
+#endif
+
+#ifdef __SSE2__
+// Inversão dos bits de um byte (movemask devolve o primeiro pixel no bit menos significativo)
+static unsigned char vc_reverse8(unsigned int b)
+{
+	b = ((b & 0xF0) >> 4) | ((b & 0x0F) << 4);
+	b = ((b & 0xCC) >> 2) | ((b & 0x33) << 2);
+	b = ((b & 0xAA) >> 1) | ((b & 0x55) << 1);
+	return (unsigned char)b;
+}
+#endif
 
-				// Na nossa imagem:
-				// 1 = Branco
-				// 0 = Preto
-				*p |= (datauchar[pos] == 0) << (8 - countbits);
+// Uma linha de width pixeis de 1 canal (width bytes consecutivos) para (width + 7) / 8 bytes: o bit
+// a 1 (preto no PBM) é um pixel a 0, e o primeiro pixel vai para o bit mais significativo
+static void vc_pack_row(const unsigned char *pixels, unsigned char *bits, int width)
+{
+	int x = 0;
 
-				countbits++;
-			}
-			if ((countbits > 8) || (x == width - 1))
-			{
-				p++;
-				*p = 0;
-				countbits = 1;
-				counttotalbytes++;
-			}
-		}
+#ifdef __SSE2__
+	const __m128i zero = _mm_setzero_si128();
+	for (; x + 16 <= width; x += 16)
+	{
+		int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(pixels + x)), zero));
+		bits[x / 8] = vc_reverse8(mask & 0xFF);
+		bits[x / 8 + 1] = vc_reverse8(mask >> 8);
+	}
+#endif
+#ifdef VC_PACK_WORDS
+	for (; x + 8 <= width; x += 8)
+		bits[x / 8] = vc_pack8(pixels + x);
+#endif
+	// Resto da linha (e sistemas big-endian)
+	for (; x < width; x += 8)
+	{
+		unsigned char b = 0;
+		for (int i = 0; (i < 8) && (x + i < width); i++)
+			b |= (pixels[x + i] == 0) << (7 - i);
+		bits[x / 8] = b;
 	}
+}
 
-	return counttotalbytes;
+// (width + 7) / 8 bytes para uma linha de width pixeis 0/white
+static void vc_unpack_row(const unsigned char *bits, unsigned char *pixels, int width, unsigned char white)
+{
+	int x = 0;
+
+#ifdef VC_PACK_WORDS
+	for (; x + 8 <= width; x += 8)
+		vc_unpack8(bits[x / 8], pixels + x, white);
+#endif
+	for (; x < width; x++)
+		pixels[x] = (bits[x / 8] & (0x80 >> (x % 8))) ? 0 : white;
 }
 
-void bit_to_unsigned_char(unsigned char *databit, unsigned char *datauchar, int width, int height)
+long int unsigned_char_to_bit(unsigned char *datauchar, unsigned char *databit, int width, int height)
 {
-	int x, y;
-	int countbits;
-	long int pos;
-	unsigned char *p = databit;
+	int y;
+	int bytesperline = width / 8 + ((width % 8) ? 1 : 0);
+
+	for (y = 0; y < height; y++)
+		vc_pack_row(datauchar + (long int)y * width, databit + (long int)y * bytesperline, width);
+
+	return (long int)bytesperline * height;
+}
 
-	countbits = 1;
+void bit_to_unsigned_char(unsigned char *databit, unsigned char *datauchar, int width, int height)
+{
+	int y;
+	int bytesperline = width / 8 + ((width % 8) ? 1 : 0);
 
 	for (y = 0; y < height; y++)
-	{
-		for (x = 0; x < width; x++)
-		{
-			pos = width * y + x;
+		vc_unpack_row(databit + (long int)y * bytesperline, datauchar + (long int)y * width, width, 1);
+}
 
-			if (countbits <= 8)
-			{
-				// Numa imagem PBM:
-				// 1 = Preto
-				// 0 = Branco
-				// datauchar[pos] = (*p & (1 << (8 - countbits))) ? 1 : 0;
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//        FUNÇÕES: IMAGENS BINÁRIAS COM 1 BIT POR PIXEL
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-				// Na nossa imagem:
-				// 1 = Branco
-				// 0 = Preto
-				datauchar[pos] = (*p & (1 << (8 - countbits))) ? 0 : 1;
+BVC *vc_bitimage_new(int width, int height)
+{
+	BVC *image;
 
-				countbits++;
-			}
-			if ((countbits > 8) || (x == width - 1))
-			{
-				p++;
-				countbits = 1;
-			}
-		}
+	if ((width <= 0) || (height <= 0))
+		return NULL;
+
+	image = (BVC *)malloc(sizeof(BVC));
+	if (image == NULL)
+		return NULL;
+
+	image->width = width;
+	image->height = height;
+	image->bytesperline = (width + 7) / 8;
+	image->data = (unsigned char *)calloc((size_t)image->bytesperline * height, 1);
+	if (image->data == NULL)
+		return vc_bitimage_free(image);
+
+	return image;
+}
+
+BVC *vc_bitimage_free(BVC *image)
+{
+	if (image != NULL)
+	{
+		free(image->data);
+		free(image);
 	}
+
+	return NULL;
+}
+
+int vc_binary_pack(IVC *src, BVC *dst)
+{
+	int y;
+
+	if ((src == NULL) || (dst == NULL) || (src->data == NULL) || (dst->data == NULL))
+		return 0;
+	if ((src->channels != 1) || (src->width != dst->width) || (src->height != dst->height))
+		return 0;
+
+	for (y = 0; y < src->height; y++)
+		vc_pack_row(src->data + (long int)y * src->bytesperline, dst->data + (long int)y * dst->bytesperline, src->width);
+
+	return 1;
+}
+
+int vc_binary_unpack(BVC *src, IVC *dst, unsigned char white)
+{
+	int y;
+
+	if ((src == NULL) || (dst == NULL) || (src->data == NULL) || (dst->data == NULL))
+		return 0;
+	if ((dst->channels != 1) || (src->width != dst->width) || (src->height != dst->height))
+		return 0;
+
+	// white = 1 dá a mesma imagem que vc_read_image
+	for (y = 0; y < src->height; y++)
+		vc_unpack_row(src->data + (long int)y * src->bytesperline, dst->data + (long int)y * dst->bytesperline, src->width, white);
+
+	return 1;
 }
 
 IVC *vc_read_image(char *filename)
 {
-	FILE *file = NULL;
-	IVC *image = NULL;
-	unsigned char *tmp;
-	char tok[20];
-	long int size, sizeofbinarydata;
-	int width, height, channels;
-	int levels = 255;
-	int v;
+	VCFileMap map;
+	IVC *image;
+	int width, height, channels, levels;
+	size_t offset, datasize;
 
-	// Abre o ficheiro
-	if ((file = fopen(filename, "rb")) != NULL)
+	// O ficheiro é mapeado e o cabeçalho interpretado no próprio mapeamento; os pixeis são
+	// copiados (ou descompactados, em PBM) de uma só vez
+	if (!vc_file_map(filename, &map))
 	{
-		// Efectua a leitura do header
-		netpbm_get_token(file, tok, sizeof(tok));
-
-		if (strcmp(tok, "P4") == 0)
-		{
-			channels = 1;
-			levels = 1;
-		} // Se PBM (Binary [0,1])
-		else if (strcmp(tok, "P5") == 0)
-			channels = 1; // Se PGM (Gray [0,MAX_VC(level,255)])
-		else if (strcmp(tok, "P6") == 0)
-			channels = 3; // Se PPM (RGB [0,MAX_VC(level,255)])
-		else
-		{
 #ifdef VC_DEBUG
-			printf("ERROR -> vc_read_image():\n\tFile is not a valid PBM, PGM or PPM file.\n\tBad magic number!\n");
+		printf("ERROR -> vc_read_image():\n\tFile not found.\n");
 #endif
+		return NULL;
+	}
 
-			fclose(file);
-			return NULL;
-		}
+	if (!netpbm_parse_header(&map, &width, &height, &channels, &levels, &offset, &datasize))
+	{
+		vc_file_unmap(&map);
+		return NULL;
+	}
+
+	// Aloca memória para imagem
+	image = vc_image_new(width, height, channels, levels);
+	if (image == NULL)
+	{
+		vc_file_unmap(&map);
+		return NULL;
+	}
 
-		if (levels == 1) // PBM
-		{
-			if (sscanf(netpbm_get_token(file, tok, sizeof(tok)), "%d", &width) != 1 ||
-				sscanf(netpbm_get_token(file, tok, sizeof(tok)), "%d", &height) != 1)
-			{
 #ifdef VC_DEBUG
-				printf("ERROR -> vc_read_image():\n\tFile is not a valid PBM file.\n\tBad size!\n");
+	printf("\nchannels=%d w=%d h=%d levels=%d\n", image->channels, image->width, image->height, levels);
 #endif
 
-				fclose(file);
-				return NULL;
-			}
+	if (levels == 1)
+		bit_to_unsigned_char(map.data + offset, image->data, image->width, image->height);
+	else
+		memcpy(image->data, map.data + offset, datasize);
 
-			// Aloca mem�ria para imagem
-			image = vc_image_new(width, height, channels, levels);
-			if (image == NULL)
-				return NULL;
+	vc_file_unmap(&map);
 
-			sizeofbinarydata = (image->width / 8 + ((image->width % 8) ? 1 : 0)) * image->height;
-			tmp = (unsigned char *)malloc(sizeofbinarydata);
-			if (tmp == NULL)
-				return 0;
+	return image;
+}
 
-#ifdef VC_DEBUG
-			printf("\nchannels=%d w=%d h=%d levels=%d\n", image->channels, image->width, image->height, levels);
-#endif
+// Imagem mapeada: a IVC é o primeiro membro, por isso um IVC * devolvido por vc_image_map()
+// aponta também para a estrutura completa
+typedef struct
+{
+	IVC image;
+	VCFileMap map;
+} VCMappedImage;
 
-			if ((v = fread(tmp, sizeof(unsigned char), sizeofbinarydata, file)) != sizeofbinarydata)
-			{
+IVC *vc_image_map(const char *filename)
+{
+	VCMappedImage *mapped;
+	int width, height, channels, levels;
+	size_t offset, datasize;
+
+	mapped = (VCMappedImage *)malloc(sizeof(VCMappedImage));
+	if (mapped == NULL)
+		return NULL;
+
+	if (!vc_file_map(filename, &mapped->map))
+	{
 #ifdef VC_DEBUG
-				printf("ERROR -> vc_read_image():\n\tPremature EOF on file.\n");
+		printf("ERROR -> vc_image_map():\n\tFile not found.\n");
 #endif
+		free(mapped);
+		return NULL;
+	}
 
-				vc_image_free(image);
-				fclose(file);
-				free(tmp);
-				return NULL;
-			}
-
-			bit_to_unsigned_char(tmp, image->data, image->width, image->height);
+	if (!netpbm_parse_header(&mapped->map, &width, &height, &channels, &levels, &offset, &datasize))
+	{
+		vc_file_unmap(&mapped->map);
+		free(mapped);
+		return NULL;
+	}
 
-			free(tmp);
-		}
-		else // PGM ou PPM
-		{
-			if (sscanf(netpbm_get_token(file, tok, sizeof(tok)), "%d", &width) != 1 ||
-				sscanf(netpbm_get_token(file, tok, sizeof(tok)), "%d", &height) != 1 ||
-				sscanf(netpbm_get_token(file, tok, sizeof(tok)), "%d", &levels) != 1 || levels <= 0 || levels > 255)
-			{
+	// Em PBM cada pixel ocupa um bit: não há vista possível sobre o ficheiro
+	if (levels == 1)
+	{
 #ifdef VC_DEBUG
-				printf("ERROR -> vc_read_image():\n\tFile is not a valid PGM or PPM file.\n\tBad size!\n");
+		printf("ERROR -> vc_image_map():\n\tPBM files must be read with vc_read_image().\n");
 #endif
+		vc_file_unmap(&mapped->map);
+		free(mapped);
+		return NULL;
+	}
 
-				fclose(file);
-				return NULL;
-			}
+	mapped->image.data = mapped->map.data + offset;
+	mapped->image.width = width;
+	mapped->image.height = height;
+	mapped->image.channels = channels;
+	mapped->image.levels = levels;
+	mapped->image.bytesperline = width * channels;
 
-			// Aloca mem�ria para imagem
-			image = vc_image_new(width, height, channels, levels);
-			if (image == NULL)
-				return NULL;
+	return &mapped->image;
+}
 
-#ifdef VC_DEBUG
-			printf("\nchannels=%d w=%d h=%d levels=%d\n", image->channels, image->width, image->height, levels);
-#endif
+IVC *vc_image_unmap(IVC *image)
+{
+	if (image != NULL)
+	{
+		VCMappedImage *mapped = (VCMappedImage *)image;
+
+		vc_file_unmap(&mapped->map);
+		free(mapped);
+	}
 
-			size = image->width * image->height * image->channels;
+	return NULL;
+}
 
-			if ((v = fread(image->data, sizeof(unsigned char), size, file)) != size)
-			{
+BVC *vc_read_pbm(char *filename)
+{
+	VCFileMap map;
+	BVC *image;
+	int width, height, channels, levels;
+	size_t offset, datasize;
+
+	if (!vc_file_map(filename, &map))
+	{
 #ifdef VC_DEBUG
-				printf("ERROR -> vc_read_image():\n\tPremature EOF on file.\n");
+		printf("ERROR -> vc_read_pbm():\n\tFile not found.\n");
 #endif
+		return NULL;
+	}
 
-				vc_image_free(image);
-				fclose(file);
-				return NULL;
-			}
-		}
-
-		fclose(file);
+	if (!netpbm_parse_header(&map, &width, &height, &channels, &levels, &offset, &datasize))
+	{
+		vc_file_unmap(&map);
+		return NULL;
 	}
-	else
+	if (levels != 1)
 	{
 #ifdef VC_DEBUG
-		printf("ERROR -> vc_read_image():\n\tFile not found.\n");
+		printf("ERROR -> vc_read_pbm():\n\tFile is not a PBM (P4) file.\n");
 #endif
+		vc_file_unmap(&map);
+		return NULL;
 	}
 
+	// O BVC tem a disposição do P4: basta uma cópia
+	image = vc_bitimage_new(width, height);
+	if (image != NULL)
+		memcpy(image->data, map.data + offset, datasize);
+
+	vc_file_unmap(&map);
+
 	return image;
 }
 
-int vc_write_image(char *filename, IVC *image)
+// Escreve o cabeçalho e os pixeis com uma única chamada ao sistema (o ficheiro é reservado
+// com o tamanho final antes da escrita)
+static int vc_write_file(const char *filename, const char *header, size_t headersize, const unsigned char *data, size_t datasize)
 {
-	FILE *file = NULL;
-	unsigned char *tmp;
-	long int totalbytes, sizeofbinarydata;
+#ifdef _WIN32
+	FILE *file = fopen(filename, "wb");
+	int ok;
 
-	if (image == NULL)
+	if (file == NULL)
 		return 0;
+	ok = (fwrite(header, 1, headersize, file) == headersize) && (fwrite(data, 1, datasize, file) == datasize);
+	return (fclose(file) == 0) && ok;
+#else
+	struct iovec iov[2];
+	int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
 
-	if ((file = fopen(filename, "wb")) != NULL)
-	{
-		if (image->levels == 1)
-		{
-			sizeofbinarydata = (image->width / 8 + ((image->width % 8) ? 1 : 0)) * image->height + 1;
-			tmp = (unsigned char *)malloc(sizeofbinarydata);
-			if (tmp == NULL)
-				return 0;
-
-			fprintf(file, "%s %d %d\n", "P4", image->width, image->height);
+	if (fd < 0)
+		return 0;
 
-			totalbytes = unsigned_char_to_bit(image->data, tmp, image->width, image->height);
-			printf("Total = %ld\n", totalbytes);
-			if (fwrite(tmp, sizeof(unsigned char), totalbytes, file) != totalbytes)
-			{
-#ifdef VC_DEBUG
-				fprintf(stderr, "ERROR -> vc_read_image():\n\tError writing PBM, PGM or PPM file.\n");
+#ifdef __linux__
+	posix_fallocate(fd, 0, (off_t)(headersize + datasize)); // Sem suporte (ex.: alguns sistemas de ficheiros) não é erro
 #endif
 
-				fclose(file);
-				free(tmp);
-				return 0;
-			}
+	iov[0].iov_base = (void *)header;
+	iov[0].iov_len = headersize;
+	iov[1].iov_base = (void *)data;
+	iov[1].iov_len = datasize;
+
+	// writev pode escrever menos do que o pedido: continuar a partir daí
+	while (iov[0].iov_len + iov[1].iov_len > 0)
+	{
+		ssize_t n = writev(fd, (iov[0].iov_len > 0) ? iov : iov + 1, (iov[0].iov_len > 0) ? 2 : 1);
 
-			free(tmp);
+		if (n <= 0)
+		{
+			close(fd);
+			return 0;
 		}
-		else
+		for (int i = 0; (i < 2) && (n > 0); i++)
 		{
-			fprintf(file, "%s %d %d 255\n", (image->channels == 1) ? "P5" : "P6", image->width, image->height);
+			size_t k = ((size_t)n < iov[i].iov_len) ? (size_t)n : iov[i].iov_len;
+			iov[i].iov_base = (char *)iov[i].iov_base + k;
+			iov[i].iov_len -= k;
+			n -= (ssize_t)k;
+		}
+	}
 
-			if (fwrite(image->data, image->bytesperline, image->height, file) != image->height)
-			{
-#ifdef VC_DEBUG
-				fprintf(stderr, "ERROR -> vc_read_image():\n\tError writing PBM, PGM or PPM file.\n");
+	return close(fd) == 0;
 #endif
+}
 
-				fclose(file);
-				return 0;
-			}
-		}
+int vc_write_image(char *filename, IVC *image)
+{
+	char header[64];
+	int headersize;
+	unsigned char *tmp;
+	long int totalbytes, sizeofbinarydata;
+	int ok;
 
-		fclose(file);
+	if ((image == NULL) || (image->data == NULL))
+		return 0;
 
-		return 1;
+	if (image->levels == 1)
+	{
+		sizeofbinarydata = (image->width / 8 + ((image->width % 8) ? 1 : 0)) * image->height + 1;
+		tmp = (unsigned char *)malloc(sizeofbinarydata);
+		if (tmp == NULL)
+			return 0;
+
+		headersize = snprintf(header, sizeof(header), "%s %d %d\n", "P4", image->width, image->height);
+		totalbytes = unsigned_char_to_bit(image->data, tmp, image->width, image->height);
+		ok = vc_write_file(filename, header, (size_t)headersize, tmp, (size_t)totalbytes);
+
+		free(tmp);
+	}
+	else
+	{
+		headersize = snprintf(header, sizeof(header), "%s %d %d 255\n", (image->channels == 1) ? "P5" : "P6", image->width, image->height);
+		ok = vc_write_file(filename, header, (size_t)headersize, image->data, (size_t)image->bytesperline * image->height);
 	}
 
-	return 0;
+#ifdef VC_DEBUG
+	if (!ok)
+		fprintf(stderr, "ERROR -> vc_write_image():\n\tError writing PBM, PGM or PPM file.\n");
+#endif
+
+	return ok;
+}
+
+int vc_write_pbm(char *filename, BVC *image)
+{
+	char header[64];
+	int headersize;
+
+	if ((image == NULL) || (image->data == NULL))
+		return 0;
+
+	headersize = snprintf(header, sizeof(header), "%s %d %d\n", "P4", image->width, image->height);
+	return vc_write_file(filename, header, (size_t)headersize, image->data, (size_t)image->bytesperline * image->height);
 }
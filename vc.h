@@ -7,6 +7,9 @@
 //             [  DUARTE DUQUE - dduque@ipca.pt  ]
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
+#ifndef VC_H
+#define VC_H
+
 #define VC_DEBUG
 #define MAX_VC(a, b) (a > b ? a : b)
 #define MIN_VC(a, b) (a < b ? a : b)
@@ -25,6 +28,15 @@ typedef struct
 	int bytesperline; // width * channels
 } IVC;
 
+// Imagem binária com 1 bit por pixel, na disposição do PBM (P4): cada linha começa num byte novo,
+// o primeiro pixel é o bit mais significativo e o bit a 1 é preto (pixel 0 numa IVC)
+typedef struct
+{
+	unsigned char *data;
+	int width, height;
+	int bytesperline; // (width + 7) / 8
+} BVC;
+
 typedef struct
 {
 	int x, y, width, height;
@@ -39,20 +51,75 @@ typedef struct
 	int levels;
 } OVC;
 
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//          CÓDIGO DE CORES DAS RESISTÊNCIAS (IEC 60062)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// Cores do código (o índice é o dígito que a cor representa)
+#define VC_COLOR_BLACK 0
+#define VC_COLOR_BROWN 1
+#define VC_COLOR_RED 2
+#define VC_COLOR_ORANGE 3
+#define VC_COLOR_YELLOW 4
+#define VC_COLOR_GREEN 5
+#define VC_COLOR_BLUE 6
+#define VC_COLOR_VIOLET 7
+#define VC_COLOR_GREY 8
+#define VC_COLOR_WHITE 9
+#define VC_COLOR_GOLD 10
+#define VC_COLOR_SILVER 11
+#define VC_COLOR_NONE 12 // Corpo da resistência ou fundo
+#define VC_NCOLORS 12
+
+#define VC_MAX_BANDS 6
+
+typedef struct
+{
+	int nbands;
+	int bands[VC_MAX_BANDS]; // Cores das bandas, pela ordem de leitura
+	float confidence[VC_MAX_BANDS]; // Fração dos pixeis de cada banda com a cor da banda [0,1]
+	int reversed;					 // 1 se as bandas foram lidas da direita para a esquerda
+	double value;					 // Valor em ohms
+	double multiplier;
+	float tolerance; // Em percentagem
+} RVC;
+
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 //                    PROT�TIPOS DE FUN��ES
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
+// Resistências
+int vc_color_table_init(void);
+int vc_color_classify(unsigned char h, unsigned char s, unsigned char v);
+int vc_resistor_decode(const int *bands, int nbands, RVC *res);
+int vc_filtro_resistencias(const IVC *src, const OVC *blob, RVC *res, IVC *debug);
+int vc_filtro_resistencias_limites(const IVC *src, const OVC *blob, const int *boundary, int nboundaries, RVC *res, IVC *debug);
+
 // Filters
-int vc_filtro_resistencias(IVC *srcdst, OVC *blob);
 
 int vc_gray_lowpass_min_filter(IVC *src, IVC *dst, int kernel);
 int vc_gray_lowpass_median_filter(IVC *src, IVC *dst, int kernel);
 int vc_gray_gaussian_filter(IVC *src, IVC *dst);
 int vc_gray_highpass_laplacian_filter(IVC *src, IVC *dst);
-
-// Contornos
+#define VC_LAPLACIAN_4 0		 // Vizinhança 4, |L| / 6
+#define VC_LAPLACIAN_8 1		 // Vizinhança 8, |L| / 9
+#define VC_LAPLACIAN_DIAGONAL 2 // [1 -2 1] x [1 -2 1], |L| / 3
+int vc_gray_laplacian_filter(IVC *src, IVC *dst, int variant);
+
+// Contornos: dst = 255 onde a magnitude do gradiente ultrapassa o percentil th (0..1) da imagem.
+// A magnitude é dividida pelo ganho de cada máscara e fica em níveis de cinzento (0..255): um
+// degrau de 100 níveis dá 100 com qualquer operador, saturando só acima de um degrau de 255
 int vc_gray_edge_prewitt(IVC *src, IVC *dst, float th);
+int vc_gray_edge_sobel(IVC *src, IVC *dst, float th);
+int vc_gray_edge_scharr(IVC *src, IVC *dst, float th);
+#define VC_EDGE_PREWITT 0 // [-1 0 1] x [1 1 1], ganho 3
+#define VC_EDGE_SOBEL 1	  // [-1 0 1] x [1 2 1], ganho 4
+#define VC_EDGE_SCHARR 2  // [-1 0 1] x [3 10 3], ganho 16
+#define VC_EDGE_L1 0   // |gx| + |gy|
+#define VC_EDGE_LINF 1 // max(|gx|, |gy|)
+#define VC_EDGE_L2 2   // sqrt(gx^2 + gy^2)
+int vc_gray_edge(IVC *src, IVC *dst, int op, int norm, float th);
+int vc_gray_edge_canny(IVC *src, IVC *dst, int low, int high); // low, high: limiares de |gx| + |gy| (0..2040)
 
 // Histograma
 int vc_color_equalize_image(IVC *src, IVC *dst);
@@ -88,6 +155,7 @@ int vc_segmentation_area(IVC *src);
 
 // FUN��ES: CONVERS�O DE IMAGENS
 int vc_bgr_to_rgb(IVC *src, IVC *dst);
+int vc_bgr_to_rgb_half(IVC *src, IVC *dst); // dst com metade da largura e altura (média de 2x2)
 int vc_binary_to_3_channels(IVC *src, IVC *dst);
 int vc_gray_to_rgb(IVC *src, IVC *dst);
 int vc_hsv_to_rgb(IVC *src, IVC *dst);
@@ -112,3 +180,17 @@ IVC *vc_image_free(IVC *image);
 // FUN��ES: LEITURA E ESCRITA DE IMAGENS (PBM, PGM E PPM)
 IVC *vc_read_image(char *filename);
 int vc_write_image(char *filename, IVC *image);
+// Vista sobre um PGM/PPM mapeado em memória (sem cópia dos pixeis; as alterações não chegam ao
+// ficheiro). Libertar com vc_image_unmap(), nunca com vc_image_free().
+IVC *vc_image_map(const char *filename);
+IVC *vc_image_unmap(IVC *image);
+
+// FUNÇÕES: IMAGENS BINÁRIAS COM 1 BIT POR PIXEL
+BVC *vc_bitimage_new(int width, int height);
+BVC *vc_bitimage_free(BVC *image);
+int vc_binary_pack(IVC *src, BVC *dst);	  // Pixel 0 -> bit 1 (preto), outro valor -> bit 0
+int vc_binary_unpack(BVC *src, IVC *dst, unsigned char white); // Bit 1 -> 0, bit 0 -> white
+BVC *vc_read_pbm(char *filename);			  // Os bits do ficheiro são copiados sem conversão
+int vc_write_pbm(char *filename, BVC *image);
+
+#endif // VC_H
@@ -0,0 +1,642 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//              MICROBENCHMARKS DAS FUNÇÕES DE vc.h
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+// Cada função é medida em VGA, 720p, 1080p e 4K e, quando aplicável, com vários tamanhos de
+// kernel (3, 5, 7, 11) ou densidades de máscara (5%, 25%, 50%). São reportados bytes/s e pixels/s.
+//
+// As imagens são sintéticas (gradiente com ruído, sempre a mesma semente). Com a variável de
+// ambiente VC_BENCH_FRAME=<ficheiro.ppm> usa-se uma frame do vídeo, repetida até à resolução pedida
+// (ex.: ffmpeg -i video_resistors.mp4 -vframes 1 -ss 10 frame.ppm).
+//
+// Resultados em JSON para comparar versões:
+//   ./vc_bench --benchmark_format=json --benchmark_out=bench.json
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <map>
+#include <math.h>
+#include <memory>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <tuple>
+#include <vector>
+
+extern "C"
+{
+#include "vc.h"
+}
+
+#include "vc_blobs.hpp"
+#include "vc_results.hpp"
+
+struct VCBenchResolution
+{
+	const char *name;
+	int width, height;
+};
+
+static const VCBenchResolution resolutions[] = {{"VGA", 640, 480}, {"720p", 1280, 720}, {"1080p", 1920, 1080}, {"4K", 3840, 2160}};
+static const int kernels[] = {3, 5, 7, 11};
+static const int densities[] = {5, 25, 50};
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//                      IMAGENS DE ENTRADA
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+struct VCImageDeleter
+{
+	void operator()(IVC *image) const { vc_image_free(image); }
+};
+typedef std::unique_ptr<IVC, VCImageDeleter> VCImagePtr;
+
+// As imagens de entrada são criadas uma vez por tipo e resolução e nunca são alteradas
+static std::map<std::tuple<char, int, int, int>, VCImagePtr> image_cache;
+
+static IVC *bench_copy(const IVC *src)
+{
+	IVC *dst = vc_image_new(src->width, src->height, src->channels, src->levels);
+	memcpy(dst->data, src->data, (size_t)src->bytesperline * src->height);
+	return dst;
+}
+
+// Imagem RGB (sintética ou a frame do vídeo repetida)
+static IVC *bench_rgb(int width, int height)
+{
+	VCImagePtr &image = image_cache[std::make_tuple('c', width, height, 0)];
+	if (image)
+		return image.get();
+
+	image.reset(vc_image_new(width, height, 3, 255));
+	unsigned char *data = image->data;
+
+	static IVC *frame = NULL;
+	static bool loaded = false;
+	if (!loaded)
+	{
+		const char *filename = getenv("VC_BENCH_FRAME");
+		if (filename != NULL)
+			frame = vc_read_image((char *)filename);
+		if ((frame != NULL) && (frame->channels != 3))
+			frame = vc_image_free(frame);
+		loaded = true;
+	}
+
+	unsigned int seed = 12345;
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			long int pos = (long int)y * image->bytesperline + x * 3;
+
+			if (frame != NULL)
+			{
+				memcpy(&data[pos], &frame->data[(y % frame->height) * frame->bytesperline + (x % frame->width) * 3], 3);
+			}
+			else
+			{
+				seed = seed * 1103515245 + 12345;
+				int noise = (int)((seed >> 16) & 31) - 16;
+				data[pos] = (unsigned char)MIN_VC(MAX_VC(x * 255 / width + noise, 0), 255);
+				data[pos + 1] = (unsigned char)MIN_VC(MAX_VC(y * 255 / height + noise, 0), 255);
+				data[pos + 2] = (unsigned char)MIN_VC(MAX_VC((x + y) * 255 / (width + height) - noise, 0), 255);
+			}
+		}
+	}
+
+	return image.get();
+}
+
+static IVC *bench_gray(int width, int height)
+{
+	VCImagePtr &image = image_cache[std::make_tuple('g', width, height, 0)];
+	if (!image)
+	{
+		image.reset(vc_image_new(width, height, 1, 255));
+		vc_rgb_to_gray(bench_rgb(width, height), image.get());
+	}
+	return image.get();
+}
+
+static IVC *bench_hsv(int width, int height)
+{
+	VCImagePtr &image = image_cache[std::make_tuple('h', width, height, 0)];
+	if (!image)
+	{
+		image.reset(vc_image_new(width, height, 3, 255));
+		vc_rgb_to_hsv(bench_rgb(width, height), image.get());
+	}
+	return image.get();
+}
+
+// Máscara binária com 24 retângulos (grelha 6x4) que ocupam density% da imagem.
+// Poucos objetos grandes, como na segmentação real (a etiquetagem só suporta 255 etiquetas).
+static IVC *bench_mask(int width, int height, int density)
+{
+	VCImagePtr &image = image_cache[std::make_tuple('m', width, height, density)];
+	if (image)
+		return image.get();
+
+	image.reset(vc_image_new(width, height, 1, 255));
+	memset(image->data, 0, (size_t)image->bytesperline * height);
+
+	int cellw = width / 6, cellh = height / 4;
+	int rectw = (int)(cellw * sqrt(density / 100.0)), recth = (int)(cellh * sqrt(density / 100.0));
+	for (int cy = 0; cy < 4; cy++)
+	{
+		for (int cx = 0; cx < 6; cx++)
+		{
+			int x0 = cx * cellw + (cellw - rectw) / 2, y0 = cy * cellh + (cellh - recth) / 2;
+			for (int y = y0; y < y0 + recth; y++)
+				memset(&image->data[(long int)y * image->bytesperline + x0], 255, rectw);
+		}
+	}
+
+	return image.get();
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//                        REGISTO
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// Resolução e argumento (tamanho do kernel, densidade da máscara ou 0) de um caso
+struct VCBenchCase
+{
+	int width, height, arg;
+};
+
+// Regista fn para todas as resoluções e argumentos.
+// setup prepara as imagens fora da medição e devolve a função medida e os bytes lidos por chamada.
+static void bench_register(const char *name, const char *argname, const int *args, int nargs,
+						   const std::function<std::pair<std::function<void()>, long long>(const VCBenchCase &)> &setup)
+{
+	for (const VCBenchResolution &r : resolutions)
+	{
+		for (int a = 0; a < (nargs > 0 ? nargs : 1); a++)
+		{
+			VCBenchCase c = {r.width, r.height, nargs > 0 ? args[a] : 0};
+			std::string fullname = std::string(name) + "/" + r.name;
+			if (nargs > 0)
+				fullname += "/" + std::string(argname) + ":" + std::to_string(c.arg);
+
+			benchmark::RegisterBenchmark(fullname.c_str(), [c, setup](benchmark::State &state)
+										 {
+											 std::pair<std::function<void()>, long long> run = setup(c);
+											 for (auto _ : state)
+											 {
+												 run.first();
+												 benchmark::ClobberMemory();
+											 }
+											 long long pixels = (long long)c.width * c.height;
+											 state.SetBytesProcessed(state.iterations() * run.second);
+											 state.counters["pixels/s"] = benchmark::Counter((double)(state.iterations() * pixels), benchmark::Counter::kIsRate);
+										 })
+				->Unit(benchmark::kMillisecond);
+		}
+	}
+}
+
+// Função de imagem para imagem: src(canais de entrada) -> dst(canais de saída)
+typedef IVC *(*VCBenchSource)(int width, int height);
+
+static IVC *bench_mask25(int width, int height)
+{
+	return bench_mask(width, height, 25);
+}
+
+static void bench_filter(const char *name, VCBenchSource source, int dstchannels, const std::function<void(IVC *, IVC *)> &fn)
+{
+	bench_register(name, NULL, NULL, 0, [=](const VCBenchCase &c)
+				   {
+					   IVC *src = source(c.width, c.height);
+					   std::shared_ptr<IVC> dst(vc_image_new(c.width, c.height, dstchannels, 255), vc_image_free);
+					   return std::make_pair(std::function<void()>([=]()
+																   { fn(src, dst.get()); }),
+											 (long long)src->bytesperline * c.height);
+				   });
+}
+
+static void bench_filter_kernel(const char *name, VCBenchSource source, const std::function<void(IVC *, IVC *, int)> &fn)
+{
+	bench_register(name, "kernel", kernels, sizeof(kernels) / sizeof(kernels[0]), [=](const VCBenchCase &c)
+				   {
+					   IVC *src = source(c.width, c.height);
+					   std::shared_ptr<IVC> dst(vc_image_new(c.width, c.height, 1, 255), vc_image_free);
+					   return std::make_pair(std::function<void()>([=]()
+																   { fn(src, dst.get(), c.arg); }),
+											 (long long)src->bytesperline * c.height);
+				   });
+}
+
+// Função que altera a imagem: trabalha sobre uma cópia
+static void bench_inplace(const char *name, VCBenchSource source, const std::function<void(IVC *)> &fn)
+{
+	bench_register(name, NULL, NULL, 0, [=](const VCBenchCase &c)
+				   {
+					   std::shared_ptr<IVC> img(bench_copy(source(c.width, c.height)), vc_image_free);
+					   return std::make_pair(std::function<void()>([=]()
+																   { fn(img.get()); }),
+											 (long long)img->bytesperline * c.height);
+				   });
+}
+
+// Função sobre máscaras binárias, com várias densidades
+static void bench_mask_density(const char *name, const std::function<std::function<void()>(IVC *)> &prepare)
+{
+	bench_register(name, "density", densities, sizeof(densities) / sizeof(densities[0]), [=](const VCBenchCase &c)
+				   {
+					   IVC *mask = bench_mask(c.width, c.height, c.arg);
+					   return std::make_pair(prepare(mask), (long long)mask->bytesperline * c.height);
+				   });
+}
+
+static void bench_register_all(void)
+{
+	// Espaços de cor
+	bench_filter("vc_bgr_to_rgb", bench_rgb, 3, [](IVC *s, IVC *d)
+				 { vc_bgr_to_rgb(s, d); });
+	bench_filter("vc_rgb_to_gray", bench_rgb, 1, [](IVC *s, IVC *d)
+				 { vc_rgb_to_gray(s, d); });
+	bench_filter("vc_rgb_to_hsv", bench_rgb, 3, [](IVC *s, IVC *d)
+				 { vc_rgb_to_hsv(s, d); });
+	bench_filter("vc_hsv_to_rgb", bench_hsv, 3, [](IVC *s, IVC *d)
+				 { vc_hsv_to_rgb(s, d); });
+	bench_filter("vc_hsv_segmentation", bench_hsv, 1, [](IVC *s, IVC *d)
+				 { vc_hsv_segmentation(s, d, 20, 50, 37, 100, 10, 100); });
+	bench_filter("vc_gray_to_rgb", bench_gray, 3, [](IVC *s, IVC *d)
+				 { vc_gray_to_rgb(s, d); });
+	bench_filter("vc_binary_to_3_channels", bench_mask25, 3, [](IVC *s, IVC *d)
+				 { vc_binary_to_3_channels(s, d); });
+	bench_register("hsv_to_rgb", NULL, NULL, 0, [](const VCBenchCase &c)
+				   {
+					   IVC *src = bench_hsv(c.width, c.height);
+					   return std::make_pair(std::function<void()>([=]()
+																   {
+																	   unsigned char r, g, b;
+																	   for (long int i = 0, n = (long int)c.width * c.height * 3; i < n; i += 3)
+																	   {
+																		   hsv_to_rgb(src->data[i] * 360 / 255, src->data[i + 1] * 100 / 255, src->data[i + 2] * 100 / 255, &r, &g, &b);
+																		   benchmark::DoNotOptimize(r + g + b);
+																	   } }),
+											 (long long)src->bytesperline * c.height);
+				   });
+
+	// Canais e negativos
+	bench_inplace("vc_rgb_get_red_gray", bench_rgb, [](IVC *i)
+				  { vc_rgb_get_red_gray(i); });
+	bench_inplace("vc_rgb_get_green_gray", bench_rgb, [](IVC *i)
+				  { vc_rgb_get_green_gray(i); });
+	bench_inplace("vc_rgb_get_blue_gray", bench_rgb, [](IVC *i)
+				  { vc_rgb_get_blue_gray(i); });
+	bench_inplace("vc_rgb_negative", bench_rgb, [](IVC *i)
+				  { vc_rgb_negative(i); });
+	bench_inplace("vc_gray_negative", bench_gray, [](IVC *i)
+				  { vc_gray_negative(i); });
+
+	// Filtros
+	bench_filter_kernel("vc_gray_lowpass_min_filter", bench_gray, [](IVC *s, IVC *d, int k)
+						{ vc_gray_lowpass_min_filter(s, d, k); });
+	bench_filter_kernel("vc_gray_lowpass_median_filter", bench_gray, [](IVC *s, IVC *d, int k)
+						{ vc_gray_lowpass_median_filter(s, d, k); });
+	bench_filter("vc_gray_gaussian_filter", bench_gray, 1, [](IVC *s, IVC *d)
+				 { vc_gray_gaussian_filter(s, d); });
+	bench_filter("vc_gray_highpass_laplacian_filter", bench_gray, 1, [](IVC *s, IVC *d)
+				 { vc_gray_highpass_laplacian_filter(s, d); });
+	bench_filter("vc_gray_laplacian_filter_8", bench_gray, 1, [](IVC *s, IVC *d)
+				 { vc_gray_laplacian_filter(s, d, VC_LAPLACIAN_8); });
+	bench_filter("vc_gray_laplacian_filter_diagonal", bench_gray, 1, [](IVC *s, IVC *d)
+				 { vc_gray_laplacian_filter(s, d, VC_LAPLACIAN_DIAGONAL); });
+	bench_filter("vc_gray_edge_prewitt", bench_gray, 1, [](IVC *s, IVC *d)
+				 { vc_gray_edge_prewitt(s, d, 0.8f); });
+	bench_filter("vc_gray_edge_sobel", bench_gray, 1, [](IVC *s, IVC *d)
+				 { vc_gray_edge_sobel(s, d, 0.8f); });
+	bench_filter("vc_gray_edge_scharr", bench_gray, 1, [](IVC *s, IVC *d)
+				 { vc_gray_edge_scharr(s, d, 0.8f); });
+	bench_filter("vc_gray_edge_canny", bench_gray, 1, [](IVC *s, IVC *d)
+				 { vc_gray_edge_canny(s, d, 40, 100); });
+
+	// Histogramas (vc_gray_histogram_show não é medida: escreve o histograma inteiro na consola)
+	bench_filter("vc_gray_equalize_image", bench_gray, 1, [](IVC *s, IVC *d)
+				 { vc_gray_equalize_image(s, d); });
+	bench_filter("vc_color_equalize_image", bench_hsv, 3, [](IVC *s, IVC *d)
+				 { vc_color_equalize_image(s, d); });
+
+	// Segmentação
+	bench_filter("vc_gray_to_binary", bench_gray, 1, [](IVC *s, IVC *d)
+				 { vc_gray_to_binary(s, d, 128); });
+	bench_filter("vc_gray_to_binary_global_mean", bench_gray, 1, [](IVC *s, IVC *d)
+				 { vc_gray_to_binary_global_mean(s, d); });
+	bench_filter_kernel("vc_gray_to_binary_niblack", bench_gray, [](IVC *s, IVC *d, int k)
+						{ vc_gray_to_binary_niblack(s, d, k, -0.2f); });
+	bench_filter_kernel("vc_gray_to_binary_bernsen", bench_gray, [](IVC *s, IVC *d, int k)
+						{ vc_gray_to_binary_bernsen(s, d, k, 15); });
+	bench_filter_kernel("vc_gray_to_binary_midpoint", bench_gray, [](IVC *s, IVC *d, int k)
+						{ vc_gray_to_binary_midpoint(s, d, k); });
+	bench_register("vc_subtract", NULL, NULL, 0, [](const VCBenchCase &c)
+				   {
+					   IVC *src = bench_gray(c.width, c.height);
+					   IVC *src2 = bench_mask(c.width, c.height, 25);
+					   std::shared_ptr<IVC> dst(vc_image_new(c.width, c.height, 1, 255), vc_image_free);
+					   return std::make_pair(std::function<void()>([=]()
+																   { vc_subtract(src, src2, dst.get()); }),
+											 2LL * src->bytesperline * c.height);
+				   });
+
+	// Morfologia
+	bench_filter_kernel("vc_grayscale_erode", bench_gray, [](IVC *s, IVC *d, int k)
+						{ vc_grayscale_erode(s, d, k); });
+	bench_filter_kernel("vc_grayscale_dilate", bench_gray, [](IVC *s, IVC *d, int k)
+						{ vc_grayscale_dilate(s, d, k); });
+	bench_filter_kernel("vc_grayscale_open", bench_gray, [](IVC *s, IVC *d, int k)
+						{ vc_grayscale_open(s, d, k); });
+	bench_filter_kernel("vc_grayscale_close", bench_gray, [](IVC *s, IVC *d, int k)
+						{ vc_grayscale_close(s, d, k); });
+	bench_filter_kernel("vc_binary_erode", bench_mask25, [](IVC *s, IVC *d, int k)
+						{ vc_binary_erode(s, d, k); });
+	bench_filter_kernel("vc_binary_dilate", bench_mask25, [](IVC *s, IVC *d, int k)
+						{ vc_binary_dilate(s, d, k); });
+	bench_filter_kernel("vc_binary_open", bench_mask25, [](IVC *s, IVC *d, int k)
+						{ vc_binary_open(s, d, k, k); });
+	bench_filter_kernel("vc_binary_close", bench_mask25, [](IVC *s, IVC *d, int k)
+						{ vc_binary_close(s, d, k, k); });
+
+	// Blobs
+	bench_mask_density("vc_binary_area", [](IVC *mask)
+					   { return std::function<void()>([=]()
+													  { benchmark::DoNotOptimize(vc_binary_area(mask)); }); });
+	bench_mask_density("vc_segmentation_area", [](IVC *mask)
+					   { return std::function<void()>([=]()
+													  { benchmark::DoNotOptimize(vc_segmentation_area(mask)); }); });
+	bench_mask_density("vc_binary_blob_labelling", [](IVC *mask)
+					   {
+						   std::shared_ptr<IVC> labels(vc_image_new(mask->width, mask->height, 1, 255), vc_image_free);
+						   return std::function<void()>([=]()
+														{
+															int nblobs;
+															free(vc_binary_blob_labelling(mask, labels.get(), &nblobs)); }); });
+	bench_mask_density("vc_binary_blob_info", [](IVC *mask)
+					   {
+						   std::shared_ptr<IVC> labels(vc_image_new(mask->width, mask->height, 1, 255), vc_image_free);
+						   int nblobs = 0;
+						   std::shared_ptr<OVC> blobs(vc_binary_blob_labelling(mask, labels.get(), &nblobs), free);
+						   return std::function<void()>([=]()
+														{ vc_binary_blob_info(labels.get(), blobs.get(), nblobs); }); });
+	bench_mask_density("vc_blob_gray_coloring", [](IVC *mask)
+					   {
+						   std::shared_ptr<IVC> labels(vc_image_new(mask->width, mask->height, 1, 255), vc_image_free);
+						   std::shared_ptr<IVC> dst(vc_image_new(mask->width, mask->height, 1, 255), vc_image_free);
+						   int nblobs = 0;
+						   std::shared_ptr<OVC> blobs(vc_binary_blob_labelling(mask, labels.get(), &nblobs), free);
+						   if (blobs)
+							   vc_binary_blob_info(labels.get(), blobs.get(), nblobs);
+						   return std::function<void()>([=]()
+														{ vc_blob_gray_coloring(labels.get(), dst.get(), blobs.get(), nblobs); }); });
+
+	// Desenho e classificação de um blob (retângulo no centro da imagem)
+	bench_register("vc_draw_border_box", NULL, NULL, 0, [](const VCBenchCase &c)
+				   {
+					   std::shared_ptr<IVC> img(bench_copy(bench_rgb(c.width, c.height)), vc_image_free);
+					   OVC blob = {};
+					   blob.x = c.width / 4, blob.y = c.height / 4, blob.width = c.width / 2, blob.height = c.height / 2;
+					   return std::make_pair(std::function<void()>([=]() mutable
+																   { vc_draw_border_box(img.get(), &blob); }),
+											 0LL);
+				   });
+	bench_register("vc_draw_of_gravity", NULL, NULL, 0, [](const VCBenchCase &c)
+				   {
+					   std::shared_ptr<IVC> img(bench_copy(bench_rgb(c.width, c.height)), vc_image_free);
+					   OVC blob = {};
+					   blob.xc = c.width / 2, blob.yc = c.height / 2, blob.area = 1000;
+					   return std::make_pair(std::function<void()>([=]() mutable
+																   { vc_draw_of_gravity(img.get(), &blob); }),
+											 0LL);
+				   });
+	bench_register("vc_filtro_resistencias", NULL, NULL, 0, [](const VCBenchCase &c)
+				   {
+					   vc_color_table_init();
+					   IVC *hsv = bench_hsv(c.width, c.height);
+					   OVC blob = {};
+					   blob.x = c.width / 4, blob.y = c.height / 2 - 30, blob.width = c.width / 2, blob.height = 60;
+					   return std::make_pair(std::function<void()>([=]()
+																   {
+																	   RVC res;
+																	   benchmark::DoNotOptimize(vc_filtro_resistencias(hsv, &blob, &res, NULL)); }),
+											 (long long)blob.width * blob.height * 3);
+				   });
+	bench_register("vc_color_classify", NULL, NULL, 0, [](const VCBenchCase &c)
+				   {
+					   vc_color_table_init();
+					   IVC *hsv = bench_hsv(c.width, c.height);
+					   return std::make_pair(std::function<void()>([=]()
+																   {
+																	   int sum = 0;
+																	   for (long int i = 0, n = (long int)c.width * c.height * 3; i < n; i += 3)
+																		   sum += vc_color_classify(hsv->data[i], hsv->data[i + 1], hsv->data[i + 2]);
+																	   benchmark::DoNotOptimize(sum); }),
+											 (long long)hsv->bytesperline * c.height);
+				   });
+
+	// Funções que não dependem da resolução
+	benchmark::RegisterBenchmark("vc_resistor_decode", [](benchmark::State &state)
+								 {
+									 static const int bands[][5] = {{VC_COLOR_BROWN, VC_COLOR_BLACK, VC_COLOR_RED, VC_COLOR_GOLD, -1},
+																	{VC_COLOR_GOLD, VC_COLOR_ORANGE, VC_COLOR_VIOLET, VC_COLOR_YELLOW, -1},
+																	{VC_COLOR_BROWN, VC_COLOR_BLACK, VC_COLOR_BLACK, VC_COLOR_RED, VC_COLOR_BROWN}};
+									 static const int nbands[] = {4, 4, 5};
+									 RVC res;
+									 int i = 0;
+									 for (auto _ : state)
+									 {
+										 benchmark::DoNotOptimize(vc_resistor_decode(bands[i], nbands[i], &res));
+										 i = (i + 1) % 3;
+									 }
+									 state.SetItemsProcessed(state.iterations()); });
+
+	// Filtro dos blobs candidatos (largura > 100, altura < 100, proporção >= 1.5): ciclo sobre
+	// OVC[] contra a tabela em colunas, com blobs aleatórios (cerca de 1/4 passam)
+	static const int nblobs[] = {64, 1024, 16384};
+	for (int n : nblobs)
+	{
+		std::shared_ptr<std::vector<OVC>> blobs(new std::vector<OVC>(n));
+		srand(n);
+		for (OVC &b : *blobs)
+		{
+			b = {};
+			b.width = 20 + rand() % 200;
+			b.height = 10 + rand() % 120;
+			b.area = b.width * b.height / 2;
+		}
+		VCBlobFilter filter;
+		filter.set(VC_BLOB_WIDTH, 101.0f, std::numeric_limits<float>::infinity());
+		filter.set(VC_BLOB_HEIGHT, -std::numeric_limits<float>::infinity(), 99.0f);
+		filter.set(VC_BLOB_ASPECT, 1.5f, std::numeric_limits<float>::infinity());
+
+		benchmark::RegisterBenchmark(("blob_filter_ovc/" + std::to_string(n)).c_str(), [=](benchmark::State &state)
+									 {
+										 std::vector<int> indices;
+										 for (auto _ : state)
+										 {
+											 indices.clear();
+											 for (int i = 0; i < n; i++)
+											 {
+												 const OVC &b = (*blobs)[i];
+												 if ((b.width > 100) && (b.height < 100) && ((float)b.width >= 1.5f * (float)b.height))
+													 indices.push_back(i);
+											 }
+											 benchmark::DoNotOptimize(indices.data());
+										 }
+										 state.SetItemsProcessed(state.iterations() * n); });
+		benchmark::RegisterBenchmark(("blob_filter_table/" + std::to_string(n)).c_str(), [=](benchmark::State &state)
+									 {
+										 VCBlobTable table;
+										 table.assign(blobs->data(), n);
+										 VCBlobPlan plan(filter);
+										 std::vector<int> indices;
+										 for (auto _ : state)
+										 {
+											 table.select(plan, 0, VC_BLOB_NSTAGES - 1, indices);
+											 benchmark::DoNotOptimize(indices.data());
+										 }
+										 state.SetItemsProcessed(state.iterations() * n); });
+	}
+
+	// Resultados por frame (formatação e entrega à thread de escrita), 8 blobs por frame
+	static const char *resultformats[] = {"jsonl", "csv", "binary"};
+	for (int f = VC_RESULTS_JSONL; f <= VC_RESULTS_BINARY; f++)
+		benchmark::RegisterBenchmark((std::string("VCResultsSink/") + resultformats[f]).c_str(), [f](benchmark::State &state)
+									 {
+										 std::vector<VCDetection> detections(8);
+										 for (int i = 0; i < (int)detections.size(); i++)
+										 {
+											 VCDetection &d = detections[i];
+											 d.blob.x = 40 + 80 * i;
+											 d.blob.y = 300 + 7 * i;
+											 d.blob.width = 150;
+											 d.blob.height = 55;
+											 d.blob.area = 3800 + i;
+											 d.blob.xc = 115 + 80 * i;
+											 d.blob.yc = 327 + 7 * i;
+											 d.track = 100 + i;
+											 d.decoded = i % 4 != 3;
+											 d.resistor.value = 5600.0 * (i + 1);
+											 d.resistor.tolerance = 5.0f;
+										 }
+										 // Na pasta temporária, não na pasta de trabalho
+										 std::string filename = (std::filesystem::temp_directory_path() / "vc_bench_results").string();
+										 VCResultsSink sink;
+										 sink.open(filename.c_str(), f);
+										 int nframe = 0;
+										 for (auto _ : state)
+											 sink.write(nframe++, detections);
+										 sink.close();
+										 remove(filename.c_str());
+										 state.SetItemsProcessed(state.iterations() * (long long)detections.size()); });
+
+	// Alocação e leitura/escrita de ficheiros
+	bench_register("vc_image_new_free", NULL, NULL, 0, [](const VCBenchCase &c)
+				   { return std::make_pair(std::function<void()>([=]()
+																 { vc_image_free(vc_image_new(c.width, c.height, 3, 255)); }),
+										   (long long)c.width * c.height * 3); });
+	bench_register("vc_write_image", NULL, NULL, 0, [](const VCBenchCase &c)
+				   {
+					   IVC *src = bench_rgb(c.width, c.height);
+					   return std::make_pair(std::function<void()>([=]()
+																   { vc_write_image((char *)"vc_bench.ppm", src); }),
+											 (long long)src->bytesperline * c.height);
+				   });
+	bench_register("vc_read_image", NULL, NULL, 0, [](const VCBenchCase &c)
+				   {
+					   IVC *src = bench_rgb(c.width, c.height);
+					   std::string filename = "vc_bench_" + std::to_string(c.width) + ".ppm";
+					   vc_write_image((char *)filename.c_str(), src);
+					   return std::make_pair(std::function<void()>([=]()
+																   { vc_image_free(vc_read_image((char *)filename.c_str())); }),
+											 (long long)src->bytesperline * c.height);
+				   });
+	bench_register("vc_image_map", NULL, NULL, 0, [](const VCBenchCase &c)
+				   {
+					   IVC *src = bench_rgb(c.width, c.height);
+					   std::string filename = "vc_bench_" + std::to_string(c.width) + ".ppm";
+					   vc_write_image((char *)filename.c_str(), src);
+					   // Mapear e percorrer os pixeis (uma leitura por página), como quem usa a imagem
+					   return std::make_pair(std::function<void()>([=]()
+																   {
+																	   IVC *image = vc_image_map(filename.c_str());
+																	   unsigned int sum = 0;
+																	   for (long int i = 0; i < (long int)image->bytesperline * image->height; i += 4096)
+																		   sum += image->data[i];
+																	   benchmark::DoNotOptimize(sum);
+																	   vc_image_unmap(image); }),
+											 (long long)src->bytesperline * c.height);
+				   });
+
+	// Imagens binárias com 1 bit por pixel (P4)
+	bench_mask_density("vc_binary_pack", [](IVC *mask)
+					   {
+						   std::shared_ptr<BVC> bits(vc_bitimage_new(mask->width, mask->height), vc_bitimage_free);
+						   return std::function<void()>([=]()
+														{ vc_binary_pack(mask, bits.get()); }); });
+	bench_mask_density("vc_binary_unpack", [](IVC *mask)
+					   {
+						   std::shared_ptr<BVC> bits(vc_bitimage_new(mask->width, mask->height), vc_bitimage_free);
+						   std::shared_ptr<IVC> dst(vc_image_new(mask->width, mask->height, 1, 255), vc_image_free);
+						   vc_binary_pack(mask, bits.get());
+						   return std::function<void()>([=]()
+														{ vc_binary_unpack(bits.get(), dst.get(), 255); }); });
+	bench_register("vc_write_image_pbm", NULL, NULL, 0, [](const VCBenchCase &c)
+				   {
+					   IVC *mask = bench_mask25(c.width, c.height);
+					   std::shared_ptr<IVC> src(vc_image_new(c.width, c.height, 1, 1), vc_image_free);
+					   memcpy(src->data, mask->data, (size_t)mask->bytesperline * c.height);
+					   return std::make_pair(std::function<void()>([=]()
+																   { vc_write_image((char *)"vc_bench.pbm", src.get()); }),
+											 (long long)src->bytesperline * c.height);
+				   });
+	bench_register("vc_read_image_pbm", NULL, NULL, 0, [](const VCBenchCase &c)
+				   {
+					   IVC *mask = bench_mask25(c.width, c.height);
+					   std::shared_ptr<IVC> src(vc_image_new(c.width, c.height, 1, 1), vc_image_free);
+					   memcpy(src->data, mask->data, (size_t)mask->bytesperline * c.height);
+					   std::string filename = "vc_bench_" + std::to_string(c.width) + ".pbm";
+					   vc_write_image((char *)filename.c_str(), src.get());
+					   return std::make_pair(std::function<void()>([=]()
+																   { vc_image_free(vc_read_image((char *)filename.c_str())); }),
+											 (long long)src->bytesperline * c.height);
+				   });
+	bench_register("vc_read_pbm", NULL, NULL, 0, [](const VCBenchCase &c)
+				   {
+					   std::string filename = "vc_bench_" + std::to_string(c.width) + ".pbm";
+					   std::shared_ptr<IVC> src(vc_image_new(c.width, c.height, 1, 1), vc_image_free);
+					   memcpy(src->data, bench_mask25(c.width, c.height)->data, (size_t)src->bytesperline * c.height);
+					   vc_write_image((char *)filename.c_str(), src.get());
+					   return std::make_pair(std::function<void()>([=]()
+																   { vc_bitimage_free(vc_read_pbm((char *)filename.c_str())); }),
+											 (long long)src->bytesperline * c.height);
+				   });
+}
+
+int main(int argc, char **argv)
+{
+	bench_register_all();
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	// Ficheiros temporários de vc_write_image/vc_read_image
+	remove("vc_bench.ppm");
+	remove("vc_bench.pbm");
+	for (const VCBenchResolution &r : resolutions)
+	{
+		remove(("vc_bench_" + std::to_string(r.width) + ".ppm").c_str());
+		remove(("vc_bench_" + std::to_string(r.width) + ".pbm").c_str());
+	}
+
+	return 0;
+}
@@ -0,0 +1,362 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//             TABELA DE BLOBS EM COLUNAS (SoA)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "vc_blobs.hpp"
+
+static const char *vc_blob_names[VC_BLOB_NMEASURES] = {"width", "height", "area", "aspect", "fill", "compactness", "orientation"};
+static const int vc_blob_stages[VC_BLOB_NMEASURES] = {VC_BLOB_STAGE_LABELLING, VC_BLOB_STAGE_LABELLING, VC_BLOB_STAGE_LABELLING,
+													   VC_BLOB_STAGE_LABELLING, VC_BLOB_STAGE_LABELLING, VC_BLOB_STAGE_INFO,
+													   VC_BLOB_STAGE_MOMENTS};
+
+VCBlobFilter::VCBlobFilter()
+{
+	for (int m = 0; m < VC_BLOB_NMEASURES; m++)
+	{
+		min[m] = -std::numeric_limits<float>::infinity();
+		max[m] = std::numeric_limits<float>::infinity();
+	}
+}
+
+void VCBlobFilter::set(int measure, float lo, float hi)
+{
+	min[measure] = lo;
+	max[measure] = hi;
+}
+
+bool VCBlobFilter::active(int measure) const
+{
+	return !std::isinf(min[measure]) || !std::isinf(max[measure]);
+}
+
+VCBlobFilter VCBlobFilter::scaled(int scale) const
+{
+	VCBlobFilter f = *this;
+
+	// As proporções, o preenchimento, a compacidade e a orientação não mudam com a escala
+	for (int m : {VC_BLOB_WIDTH, VC_BLOB_HEIGHT})
+	{
+		f.min[m] /= scale;
+		f.max[m] /= scale;
+	}
+	f.min[VC_BLOB_AREA] /= scale * scale;
+	f.max[VC_BLOB_AREA] /= scale * scale;
+	return f;
+}
+
+const char *VCBlobFilter::name(int measure)
+{
+	return vc_blob_names[measure];
+}
+
+int VCBlobFilter::stage(int measure)
+{
+	return vc_blob_stages[measure];
+}
+
+// Um limite de uma regra: número ou "-" (sem limite)
+static bool vc_blob_parse_limit(const char *text, float unlimited, float *value)
+{
+	char *end;
+
+	if (strcmp(text, "-") == 0)
+	{
+		*value = unlimited;
+		return true;
+	}
+	*value = strtof(text, &end);
+	return (end != text) && (*end == '\0');
+}
+
+bool VCBlobFilter::load(const char *filename)
+{
+	FILE *file = fopen(filename, "r");
+	if (file == NULL)
+	{
+		printf("VCBlobFilter::load() - Erro ao abrir %s\n", filename);
+		return false;
+	}
+
+	VCBlobFilter f;
+	char line[256];
+	int nline = 0;
+	bool ok = true;
+	while (ok && (fgets(line, sizeof(line), file) != NULL))
+	{
+		nline++;
+		char *comment = strchr(line, '#');
+		if (comment != NULL)
+			*comment = '\0';
+
+		char name[64], lo[64], hi[64], extra[2];
+		int n = sscanf(line, "%63s %63s %63s %1s", name, lo, hi, extra);
+		if (n <= 0)
+			continue;
+
+		int m = 0;
+		while ((m < VC_BLOB_NMEASURES) && (strcmp(name, vc_blob_names[m]) != 0))
+			m++;
+		if ((n != 3) || (m == VC_BLOB_NMEASURES) || !vc_blob_parse_limit(lo, -std::numeric_limits<float>::infinity(), &f.min[m]) ||
+			!vc_blob_parse_limit(hi, std::numeric_limits<float>::infinity(), &f.max[m]))
+		{
+			printf("VCBlobFilter::load() - Erro na linha %d de %s: esperado \"<medida> <minimo|-> <maximo|->\"\n", nline, filename);
+			ok = false;
+		}
+	}
+	fclose(file);
+
+	if (ok)
+		*this = f;
+	return ok;
+}
+
+VCBlobPlan::VCBlobPlan(const VCBlobFilter &filter)
+{
+	// Dentro de cada etapa, pela ordem das medidas: as simples antes das razões
+	for (int m = 0; m < VC_BLOB_NMEASURES; m++)
+		if (filter.active(m))
+			steps[VCBlobFilter::stage(m)].push_back({m, filter.min[m], filter.max[m]});
+}
+
+void VCBlobTable::clear()
+{
+	for (std::vector<int> *column : {&x, &y, &width, &height, &area, &xc, &yc, &perimeter, &label})
+		column->clear();
+	orientation.clear();
+}
+
+void VCBlobTable::reserve(int n)
+{
+	for (std::vector<int> *column : {&x, &y, &width, &height, &area, &xc, &yc, &perimeter, &label})
+		column->reserve(n);
+	orientation.reserve(n);
+}
+
+void VCBlobTable::assign(const OVC *blobs, int n)
+{
+	clear();
+	reserve(n);
+	for (int i = 0; i < n; i++)
+		push_back(blobs[i]);
+}
+
+void VCBlobTable::push_back(const OVC &blob)
+{
+	x.push_back(blob.x);
+	y.push_back(blob.y);
+	width.push_back(blob.width);
+	height.push_back(blob.height);
+	area.push_back(blob.area);
+	xc.push_back(blob.xc);
+	yc.push_back(blob.yc);
+	perimeter.push_back(blob.perimeter);
+	label.push_back(blob.label);
+	orientation.push_back(0.0f);
+}
+
+OVC VCBlobTable::blob(int i) const
+{
+	OVC b = {};
+
+	b.x = x[i];
+	b.y = y[i];
+	b.width = width[i];
+	b.height = height[i];
+	b.area = area[i];
+	b.xc = xc[i];
+	b.yc = yc[i];
+	b.perimeter = perimeter[i];
+	b.label = label[i];
+	return b;
+}
+
+void VCBlobTable::moments(const IVC *labels)
+{
+	const double pi = 3.14159265358979323846;
+
+	for (int i = 0; i < size(); i++)
+	{
+		// Momentos centrais pela média dos pixeis (o centro de gravidade de OVC é inteiro)
+		double n = 0.0, sx = 0.0, sy = 0.0, sxx = 0.0, syy = 0.0, sxy = 0.0;
+		for (int yy = y[i]; yy < y[i] + height[i]; yy++)
+		{
+			const unsigned char *row = labels->data + (size_t)yy * labels->bytesperline;
+			for (int xx = x[i]; xx < x[i] + width[i]; xx++)
+			{
+				if (row[xx] != label[i])
+					continue;
+				n += 1.0;
+				sx += xx;
+				sy += yy;
+				sxx += (double)xx * xx;
+				syy += (double)yy * yy;
+				sxy += (double)xx * yy;
+			}
+		}
+		if (n == 0.0)
+		{
+			orientation[i] = 0.0f;
+			continue;
+		}
+
+		double mx = sx / n, my = sy / n;
+		double mu20 = sxx / n - mx * mx;
+		double mu02 = syy / n - my * my;
+		double mu11 = sxy / n - mx * my;
+		// y cresce para baixo: o ângulo positivo é no sentido dos ponteiros do relógio
+		double angle = 0.5 * atan2(2.0 * mu11, mu20 - mu02) * 180.0 / pi;
+		orientation[i] = (angle <= -90.0) ? (float)(angle + 180.0) : (float)angle;
+	}
+}
+
+// Uma regra sobre todos os blobs: num >= min * den e num <= max * den, com num e den da medida
+// (den = 1 nas medidas simples). Sem divisões, para a mesma decisão com ou sem SIMD.
+template <int M>
+static void vc_blob_rule(const VCBlobTable &t, float lo, float hi, int *pass)
+{
+	const int n = t.size();
+	const int *w = t.width.data();
+	const int *h = t.height.data();
+	const int *a = t.area.data();
+	const int *p = t.perimeter.data();
+	const float *o = t.orientation.data();
+	int i = 0;
+
+#ifdef __SSE2__
+	const __m128 vlo = _mm_set1_ps(lo), vhi = _mm_set1_ps(hi);
+
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128 num, den = _mm_set1_ps(1.0f);
+		__m128 fw = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(w + i)));
+		__m128 fh = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(h + i)));
+		__m128 fa = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(a + i)));
+
+		if (M == VC_BLOB_WIDTH)
+			num = fw;
+		else if (M == VC_BLOB_HEIGHT)
+			num = fh;
+		else if (M == VC_BLOB_AREA)
+			num = fa;
+		else if (M == VC_BLOB_ASPECT)
+			num = fw, den = fh;
+		else if (M == VC_BLOB_FILL)
+			num = fa, den = _mm_mul_ps(fw, fh);
+		else if (M == VC_BLOB_COMPACTNESS)
+		{
+			__m128 fp = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(p + i)));
+			num = _mm_mul_ps(fp, fp), den = fa;
+		}
+		else
+			num = _mm_loadu_ps(o + i);
+
+		// Um NaN (ex.: limite infinito x 0) não exclui
+		__m128 reject = _mm_or_ps(_mm_cmplt_ps(num, _mm_mul_ps(vlo, den)), _mm_cmpgt_ps(num, _mm_mul_ps(vhi, den)));
+		__m128i *dst = (__m128i *)(pass + i);
+		_mm_storeu_si128(dst, _mm_andnot_si128(_mm_castps_si128(reject), _mm_loadu_si128(dst)));
+	}
+#endif
+	// Resto (e sistemas sem SSE2), com as mesmas operações em float
+	for (; i < n; i++)
+	{
+		float num, den = 1.0f;
+		float fw = (float)w[i], fh = (float)h[i], fa = (float)a[i];
+
+		if (M == VC_BLOB_WIDTH)
+			num = fw;
+		else if (M == VC_BLOB_HEIGHT)
+			num = fh;
+		else if (M == VC_BLOB_AREA)
+			num = fa;
+		else if (M == VC_BLOB_ASPECT)
+			num = fw, den = fh;
+		else if (M == VC_BLOB_FILL)
+			num = fa, den = fw * fh;
+		else if (M == VC_BLOB_COMPACTNESS)
+			num = (float)p[i] * (float)p[i], den = fa;
+		else
+			num = o[i];
+
+		if ((num < lo * den) || (num > hi * den))
+			pass[i] = 0;
+	}
+}
+
+// Uma regra do plano (a medida passa a ser constante dentro do ciclo)
+static void vc_blob_apply(const VCBlobTable &t, const VCBlobPlan::Step &s, int *pass)
+{
+	switch (s.measure)
+	{
+	case VC_BLOB_WIDTH:
+		vc_blob_rule<VC_BLOB_WIDTH>(t, s.min, s.max, pass);
+		break;
+	case VC_BLOB_HEIGHT:
+		vc_blob_rule<VC_BLOB_HEIGHT>(t, s.min, s.max, pass);
+		break;
+	case VC_BLOB_AREA:
+		vc_blob_rule<VC_BLOB_AREA>(t, s.min, s.max, pass);
+		break;
+	case VC_BLOB_ASPECT:
+		vc_blob_rule<VC_BLOB_ASPECT>(t, s.min, s.max, pass);
+		break;
+	case VC_BLOB_FILL:
+		vc_blob_rule<VC_BLOB_FILL>(t, s.min, s.max, pass);
+		break;
+	case VC_BLOB_COMPACTNESS:
+		vc_blob_rule<VC_BLOB_COMPACTNESS>(t, s.min, s.max, pass);
+		break;
+	case VC_BLOB_ORIENTATION:
+		vc_blob_rule<VC_BLOB_ORIENTATION>(t, s.min, s.max, pass);
+		break;
+	}
+}
+
+int VCBlobTable::select(const VCBlobPlan &plan, int first, int last, std::vector<int> &indices)
+{
+	const int n = size();
+
+	pass.assign(n, -1);
+	for (int stage = first; stage <= last; stage++)
+	{
+		for (const VCBlobPlan::Step &s : plan.steps[stage])
+			vc_blob_apply(*this, s, pass.data());
+	}
+
+	// Escrita sem saltos: cada índice é escrito e só avança se o blob passar
+	indices.resize(n);
+	int *out = indices.data();
+	int i = 0, m = 0;
+#ifdef __SSE2__
+	for (; i + 4 <= n; i += 4)
+	{
+		int keep = _mm_movemask_ps(_mm_castsi128_ps(_mm_loadu_si128((const __m128i *)(pass.data() + i))));
+		for (int k = 0; k < 4; k++)
+		{
+			out[m] = i + k;
+			m += (keep >> k) & 1;
+		}
+	}
+#endif
+	for (; i < n; i++)
+	{
+		out[m] = i;
+		m += pass[i] & 1;
+	}
+	indices.resize(m);
+	return m;
+}
+
+int VCBlobTable::select(const VCBlobFilter &filter, std::vector<int> &indices)
+{
+	return select(VCBlobPlan(filter), 0, VC_BLOB_NSTAGES - 1, indices);
+}
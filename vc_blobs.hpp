@@ -0,0 +1,100 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//             TABELA DE BLOBS EM COLUNAS (SoA)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <vector>
+
+extern "C"
+{
+#include "vc.h"
+}
+
+// Medidas dos blobs usadas pelos filtros
+#define VC_BLOB_WIDTH 0
+#define VC_BLOB_HEIGHT 1
+#define VC_BLOB_AREA 2
+#define VC_BLOB_ASPECT 3	  // Largura / altura
+#define VC_BLOB_FILL 4		  // Área / (largura x altura)
+#define VC_BLOB_COMPACTNESS 5 // Perímetro^2 / área (mínimo num disco; maior nas formas alongadas ou irregulares)
+#define VC_BLOB_ORIENTATION 6 // Ângulo do eixo maior com a horizontal, em graus ]-90, 90]
+#define VC_BLOB_NMEASURES 7
+
+// Etapas da deteção em que as medidas ficam disponíveis
+#define VC_BLOB_STAGE_LABELLING 0 // Caixa e área (vc_binary_blob_labelling)
+#define VC_BLOB_STAGE_INFO 1	  // Perímetro e centro de gravidade (vc_binary_blob_info)
+#define VC_BLOB_STAGE_MOMENTS 2	  // Momentos de 2.ª ordem (VCBlobTable::moments)
+#define VC_BLOB_NSTAGES 3
+
+// Limites (inclusivos) de cada medida; por omissão, nenhuma medida tem limites
+struct VCBlobFilter
+{
+	float min[VC_BLOB_NMEASURES];
+	float max[VC_BLOB_NMEASURES];
+
+	VCBlobFilter();
+
+	void set(int measure, float min, float max);
+	bool active(int measure) const;
+	// O mesmo filtro para blobs de uma imagem reduzida scale vezes (nível da pirâmide)
+	VCBlobFilter scaled(int scale) const;
+
+	// Ler as regras de um ficheiro de texto, uma por linha: "<medida> <mínimo> <máximo>", com
+	// "-" para um lado sem limite e comentários começados por #. As medidas que não aparecem
+	// ficam sem limites. Medidas: width height area aspect fill compactness orientation.
+	bool load(const char *filename);
+
+	static const char *name(int measure);
+	static int stage(int measure);
+};
+
+// Plano de avaliação de um filtro: as medidas com limites agrupadas pela etapa em que ficam
+// disponíveis, das mais baratas para as mais caras. A etapa da etiquetagem exclui blobs antes de
+// vc_binary_blob_info e da classificação.
+struct VCBlobPlan
+{
+	struct Step
+	{
+		int measure;
+		float min, max;
+	};
+
+	std::vector<Step> steps[VC_BLOB_NSTAGES];
+
+	VCBlobPlan() = default;
+	explicit VCBlobPlan(const VCBlobFilter &filter);
+	bool empty(int stage) const { return steps[stage].empty(); }
+};
+
+// Blobs em colunas, uma por campo de OVC (sem os ponteiros mask/data, que a deteção não usa).
+// Um OVC ocupa 72 bytes dos quais um filtro de tamanho só lê 12; aqui cada regra lê só as
+// colunas de que precisa, 4 blobs de cada vez (SSE2).
+class VCBlobTable
+{
+public:
+	int size() const { return (int)x.size(); }
+	void clear();
+	void reserve(int n);
+
+	// Conversão de/para a representação de vc.h
+	void assign(const OVC *blobs, int n);
+	void push_back(const OVC &blob);
+	OVC blob(int i) const; // mask e data a NULL
+
+	// Orientação de cada blob pelos momentos de 2.ª ordem das suas etiquetas (só a caixa do
+	// blob é percorrida)
+	void moments(const IVC *labels);
+
+	// Índices (por ordem) dos blobs que cumprem as regras das etapas first a last do plano
+	int select(const VCBlobPlan &plan, int first, int last, std::vector<int> &indices);
+	// Todas as regras de filter (as medidas têm de estar todas preenchidas)
+	int select(const VCBlobFilter &filter, std::vector<int> &indices);
+
+	std::vector<int> x, y, width, height;
+	std::vector<int> area, xc, yc, perimeter, label;
+	std::vector<float> orientation;
+
+private:
+	std::vector<int> pass; // Resultado de cada blob nas regras já avaliadas (-1 = passa)
+};
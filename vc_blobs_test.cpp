@@ -0,0 +1,513 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//          TESTE DOS FILTROS DA TABELA DE BLOBS
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   vc_blobs_test    teste automático (ctest): VCBlobTable::select (regras em SSE2 nos grupos de 4
+//                    blobs, em escalar no resto, e escrita dos índices sem saltos) é comparado
+//                    com a regra escrita de forma direta, blob a blob, em tabelas aleatórias;
+//                    também as regras lidas de ficheiro, cada medida, os filtros dos níveis da
+//                    pirâmide e a caixa e a área que vc_binary_blob_labelling já preenche
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "vc_blobs.hpp"
+#include "vc_test.h"
+
+static const float inf = std::numeric_limits<float>::infinity();
+
+// Blob aleatório. Com lados < 256, área < 2^14 e perímetro < 512, os produtos de select()
+// (ex.: mínimo x largura x altura) são exatos em float e a regra direta, com divisões em
+// double, tem de dar a mesma decisão.
+static OVC random_blob(void)
+{
+	OVC b = {};
+
+	b.x = rand() % 640;
+	b.y = rand() % 480;
+	b.width = 1 + rand() % 255;
+	b.height = 1 + rand() % 255;
+	b.area = 1 + rand() % std::min(b.width * b.height, 16383);
+	b.perimeter = rand() % 512;
+	b.xc = b.x + b.width / 2;
+	b.yc = b.y + b.height / 2;
+	b.label = 1 + rand() % 255;
+	return b;
+}
+
+// Limite aleatório da medida m, em quartos (ou 1/64 no preenchimento), às vezes sem limite
+static float random_limit(int m, float unlimited)
+{
+	if (rand() % 4 == 0)
+		return unlimited;
+	switch (m)
+	{
+	case VC_BLOB_WIDTH:
+	case VC_BLOB_HEIGHT:
+		return (float)(rand() % 256);
+	case VC_BLOB_AREA:
+		return (float)(rand() % 16384);
+	case VC_BLOB_ASPECT:
+		return (rand() % 64) / 4.0f;
+	case VC_BLOB_FILL:
+		return (rand() % 65) / 64.0f;
+	case VC_BLOB_COMPACTNESS:
+		return (rand() % 1024) / 4.0f;
+	default:
+		return (rand() % 721 - 360) / 4.0f;
+	}
+}
+
+// Filtro aleatório: cada medida tem limites com probabilidade 1/3
+static VCBlobFilter random_filter(void)
+{
+	VCBlobFilter f;
+
+	for (int m = 0; m < VC_BLOB_NMEASURES; m++)
+	{
+		if (rand() % 3)
+			continue;
+		float lo = random_limit(m, -inf), hi = random_limit(m, inf);
+		f.set(m, std::min(lo, hi), std::max(lo, hi));
+	}
+	return f;
+}
+
+// Medida m do blob i, como razão
+static double measure(const VCBlobTable &t, int i, int m)
+{
+	switch (m)
+	{
+	case VC_BLOB_WIDTH:
+		return t.width[i];
+	case VC_BLOB_HEIGHT:
+		return t.height[i];
+	case VC_BLOB_AREA:
+		return t.area[i];
+	case VC_BLOB_ASPECT:
+		return (double)t.width[i] / t.height[i];
+	case VC_BLOB_FILL:
+		return (double)t.area[i] / ((double)t.width[i] * t.height[i]);
+	case VC_BLOB_COMPACTNESS:
+		return (double)t.perimeter[i] * t.perimeter[i] / t.area[i];
+	default:
+		return t.orientation[i];
+	}
+}
+
+// A regra direta: o blob i cumpre os limites das medidas ativas das etapas first a last
+static bool naive(const VCBlobTable &t, int i, const VCBlobFilter &f, int first, int last)
+{
+	for (int m = 0; m < VC_BLOB_NMEASURES; m++)
+	{
+		if (!f.active(m) || (VCBlobFilter::stage(m) < first) || (VCBlobFilter::stage(m) > last))
+			continue;
+		double v = measure(t, i, m);
+		if ((v < f.min[m]) || (v > f.max[m]))
+			return false;
+	}
+	return true;
+}
+
+static std::vector<int> naive_select(const VCBlobTable &t, const VCBlobFilter &f, int first, int last)
+{
+	std::vector<int> indices;
+	for (int i = 0; i < t.size(); i++)
+		if (naive(t, i, f, first, last))
+			indices.push_back(i);
+	return indices;
+}
+
+static VCBlobTable random_table(int n)
+{
+	VCBlobTable t;
+
+	for (int i = 0; i < n; i++)
+		t.push_back(random_blob());
+	for (int i = 0; i < n; i++)
+		t.orientation[i] = (rand() % 720 - 359) / 4.0f;
+	return t;
+}
+
+// Tabelas de 0 a 67 blobs (todos os restos de 4) com filtros aleatórios, por todas as etapas e
+// só pela etiquetagem (a pré-seleção do pipeline)
+static bool test_select_random(void)
+{
+	int ntables = 0, nselected = 0, nblobs = 0;
+
+	srand(49);
+	for (int n = 0; n < 68; n++)
+	{
+		for (int k = 0; k < 40; k++)
+		{
+			VCBlobTable table = random_table(n);
+			VCBlobFilter filter = random_filter();
+			VCBlobPlan plan(filter);
+			std::vector<int> indices;
+
+			for (int last = VC_BLOB_STAGE_LABELLING; last < VC_BLOB_NSTAGES; last++)
+			{
+				std::vector<int> expected = naive_select(table, filter, 0, last);
+				int m = table.select(plan, 0, last, indices);
+				CHECK((m == (int)indices.size()) && (indices == expected),
+					  "n = " << n << ", filtro " << k << ", etapas 0.." << last << ": " << m << " blobs, esperados " << expected.size());
+			}
+			nselected += (int)indices.size();
+			nblobs += n;
+
+			std::vector<int> all;
+			table.select(filter, all);
+			CHECK(all == indices, "n = " << n << ", filtro " << k << ": select(filter) difere de select(plan)");
+			ntables++;
+		}
+	}
+
+	printf("select: %d tabelas, %d de %d blobs selecionados\n", ntables, nselected, nblobs);
+	return true;
+}
+
+// Cada blob numa tabela só dele (só o caminho escalar) tem de dar a mesma decisão que nos grupos
+// de 4 de uma tabela grande (caminho SSE2)
+static bool test_select_scalar(void)
+{
+	srand(4949);
+	VCBlobTable table = random_table(256);
+
+	for (int k = 0; k < 200; k++)
+	{
+		VCBlobFilter filter = random_filter();
+		std::vector<int> indices, single;
+		table.select(filter, indices);
+
+		std::vector<char> simd(table.size(), 0);
+		for (int i : indices)
+			simd[i] = 1;
+		for (int i = 0; i < table.size(); i++)
+		{
+			VCBlobTable one;
+			one.push_back(table.blob(i));
+			one.orientation[0] = table.orientation[i];
+			int m = one.select(filter, single);
+			CHECK(m == simd[i], "filtro " << k << ", blob " << i << ": " << m << " sozinho, " << (int)simd[i] << " na tabela");
+			CHECK(m == (int)naive(table, i, filter, 0, VC_BLOB_NSTAGES - 1), "filtro " << k << ", blob " << i << ": difere da regra direta");
+		}
+	}
+
+	printf("scalar: 200 filtros x 256 blobs, mesma decisão sozinhos e em grupos de 4\n");
+	return true;
+}
+
+// Escrita dos índices com todos os padrões de 4 blobs: blob i passa se o bit i % 4 de pattern
+// (ou de pattern + 1 nos 4 seguintes) estiver a 1, e a tabela acaba com um resto de 3
+static bool test_select_compaction(void)
+{
+	for (int pattern = 0; pattern < 16; pattern++)
+	{
+		VCBlobTable table;
+		std::vector<int> expected;
+		for (int i = 0; i < 11; i++)
+		{
+			bool keep = (((pattern + i / 4) & 15) >> (i % 4)) & 1;
+			OVC b = {};
+			b.width = keep ? 10 : 1;
+			b.height = b.area = 1;
+			b.perimeter = 4;
+			table.push_back(b);
+			if (keep)
+				expected.push_back(i);
+		}
+
+		VCBlobFilter filter;
+		filter.set(VC_BLOB_WIDTH, 5.0f, inf);
+		std::vector<int> indices;
+		table.select(filter, indices);
+		CHECK(indices == expected, "padrão " << pattern << ": " << indices.size() << " índices, esperados " << expected.size());
+
+		// Sem regras passam todos; com limites impossíveis, nenhum
+		CHECK((table.select(VCBlobFilter(), indices) == 11) && (indices.back() == 10), "padrão " << pattern << ": filtro vazio");
+		filter.set(VC_BLOB_AREA, 2.0f, 1.0f);
+		CHECK(table.select(filter, indices) == 0, "padrão " << pattern << ": limites impossíveis");
+	}
+
+	printf("compaction: 16 padrões de 4 blobs\n");
+	return true;
+}
+
+// Filtro lido de um ficheiro temporário com o texto dado
+static bool load_text(VCBlobFilter &filter, const char *text)
+{
+	std::string path = (std::filesystem::temp_directory_path() / "vc_blobs_test.txt").string();
+	FILE *file = fopen(path.c_str(), "w");
+	if (file == NULL)
+		return false;
+	fputs(text, file);
+	fclose(file);
+
+	bool ok = filter.load(path.c_str());
+	std::remove(path.c_str());
+	return ok;
+}
+
+// Regras com comentários, linhas vazias e "-", e os erros de sintaxe (o filtro fica como estava)
+static bool test_load(void)
+{
+	VCBlobFilter f;
+	CHECK(load_text(f, "# regras\n"
+					   "\n"
+					   "width 10 200   # largura\n"
+					   "  height - 80\n"
+					   "area 500 -\n"
+					   "aspect 1.5 6\n"
+					   "fill - -\n"
+					   "orientation -30 30\n"),
+		  "regras válidas recusadas");
+	CHECK((f.min[VC_BLOB_WIDTH] == 10.0f) && (f.max[VC_BLOB_WIDTH] == 200.0f), "width");
+	CHECK((f.min[VC_BLOB_HEIGHT] == -inf) && (f.max[VC_BLOB_HEIGHT] == 80.0f), "height com mínimo \"-\"");
+	CHECK((f.min[VC_BLOB_AREA] == 500.0f) && (f.max[VC_BLOB_AREA] == inf), "area com máximo \"-\"");
+	CHECK((f.min[VC_BLOB_ASPECT] == 1.5f) && (f.max[VC_BLOB_ASPECT] == 6.0f), "aspect");
+	CHECK((f.min[VC_BLOB_ORIENTATION] == -30.0f) && (f.max[VC_BLOB_ORIENTATION] == 30.0f), "orientation negativa");
+	CHECK(!f.active(VC_BLOB_FILL) && !f.active(VC_BLOB_COMPACTNESS), "\"- -\" e uma medida em falta têm de ficar sem limites");
+
+	// Os erros não alteram as regras lidas antes
+	VCBlobFilter before = f;
+	static const char *errors[] = {
+		"perimeter 1 2\n",				// Medida desconhecida
+		"width 10\n",					// Falta o máximo
+		"width\n",						// Faltam os dois limites
+		"width 1 2 3\n",				// Campo a mais
+		"width abc 20\n",				// Não é um número
+		"width 10 20x\n",				// Lixo depois do número
+		"Width 10 20\n",				// Os nomes distinguem maiúsculas
+		"height 1 2\narea 5 -- \n",	// Erro só na segunda linha
+	};
+	for (const char *text : errors)
+	{
+		CHECK(!load_text(f, text), "aceite: \"" << text << "\"");
+		CHECK(memcmp(&f, &before, sizeof(f)) == 0, "o erro alterou o filtro: \"" << text << "\"");
+	}
+	CHECK(!f.load("/nao/existe/vc_blobs_test.txt"), "ficheiro inexistente aceite");
+
+	// Um ficheiro só com comentários tira os limites todos
+	CHECK(load_text(f, "# sem regras\n"), "ficheiro só com comentários recusado");
+	for (int m = 0; m < VC_BLOB_NMEASURES; m++)
+		CHECK(!f.active(m), VCBlobFilter::name(m) << " com limites depois de um ficheiro sem regras");
+
+	printf("load: regras válidas, %d erros recusados\n", (int)(sizeof(errors) / sizeof(errors[0])) + 1);
+	return true;
+}
+
+// Cada medida, pelo nome no ficheiro, num blob com valores conhecidos: 16x8, área 96, perímetro
+// 48 e orientação 30 dão aspect 2, fill 0.75 e compactness 24
+static bool test_measures(void)
+{
+	static const float value[VC_BLOB_NMEASURES] = {16.0f, 8.0f, 96.0f, 2.0f, 0.75f, 24.0f, 30.0f};
+	OVC b = {};
+	b.width = 16;
+	b.height = 8;
+	b.area = 96;
+	b.perimeter = 48;
+	VCBlobTable table;
+	table.push_back(b);
+	table.orientation[0] = 30.0f;
+
+	for (int m = 0; m < VC_BLOB_NMEASURES; m++)
+	{
+		const char *name = VCBlobFilter::name(m);
+		float v = value[m], step = v / 64.0f;
+		struct
+		{
+			float lo, hi;
+			int expected;
+		} cases[] = {{v, v, 1}, {v - step, v + step, 1}, {v + step, v + 2 * step, 0}, {v - 2 * step, v - step, 0}};
+		std::vector<int> indices;
+
+		for (const auto &c : cases)
+		{
+			char text[128];
+			VCBlobFilter f;
+			snprintf(text, sizeof(text), "%s %.9g %.9g\n", name, c.lo, c.hi);
+			CHECK(load_text(f, text), "recusado: " << text);
+			CHECK(table.select(f, indices) == c.expected, name << " " << c.lo << ".." << c.hi << ": esperado " << c.expected);
+		}
+
+		// Só um dos lados, com "-" no outro
+		char text[128];
+		VCBlobFilter f;
+		snprintf(text, sizeof(text), "%s - %.9g\n", name, v - step);
+		CHECK(load_text(f, text) && (table.select(f, indices) == 0), name << ": máximo abaixo do valor");
+		snprintf(text, sizeof(text), "%s %.9g -\n", name, v - step);
+		CHECK(load_text(f, text) && (table.select(f, indices) == 1), name << ": mínimo abaixo do valor");
+	}
+
+	printf("measures: %d medidas\n", VC_BLOB_NMEASURES);
+	return true;
+}
+
+// Orientação pelos momentos: barras horizontal, vertical e diagonais (y cresce para baixo)
+static bool test_orientation(void)
+{
+	IVC *labels = vc_image_new(64, 64, 1, 255);
+	memset(labels->data, 0, (size_t)labels->bytesperline * labels->height);
+	for (int i = 0; i < 40; i++)
+	{
+		labels->data[4 * labels->bytesperline + 10 + i] = 1;			// Horizontal
+		labels->data[(10 + i) * labels->bytesperline + 4] = 2;			// Vertical
+		labels->data[(10 + i) * labels->bytesperline + 10 + i] = 3;		// Descer para a direita
+		labels->data[(49 - i) * labels->bytesperline + 12 + i] = 4;		// Subir para a direita
+	}
+
+	VCBlobTable table;
+	OVC boxes[4] = {};
+	const int box[4][4] = {{10, 4, 40, 1}, {4, 10, 1, 40}, {10, 10, 40, 40}, {12, 10, 40, 40}};
+	for (int i = 0; i < 4; i++)
+	{
+		boxes[i].x = box[i][0], boxes[i].y = box[i][1], boxes[i].width = box[i][2], boxes[i].height = box[i][3];
+		boxes[i].area = 40;
+		boxes[i].label = i + 1;
+		table.push_back(boxes[i]);
+	}
+	table.moments(labels);
+	vc_image_free(labels);
+
+	const float expected[4] = {0.0f, 90.0f, 45.0f, -45.0f};
+	for (int i = 0; i < 4; i++)
+		CHECK(std::fabs(table.orientation[i] - expected[i]) < 1e-3f, "barra " << i + 1 << ": " << table.orientation[i] << " graus, esperados " << expected[i]);
+
+	VCBlobFilter f;
+	std::vector<int> indices;
+	f.set(VC_BLOB_ORIENTATION, 30.0f, 60.0f);
+	CHECK((table.select(f, indices) == 1) && (indices[0] == 2), "orientation 30..60");
+
+	printf("orientation: 0, 90, 45 e -45 graus\n");
+	return true;
+}
+
+// Um blob da imagem reduzida scale vezes (lados e perímetro / scale, área / scale^2) passa o filtro
+// scaled(scale) se e só se o blob original passar o filtro original
+static bool test_scaled(void)
+{
+	VCBlobFilter f;
+	f.set(VC_BLOB_WIDTH, 40.0f, 400.0f);
+	f.set(VC_BLOB_HEIGHT, -inf, 120.0f);
+	f.set(VC_BLOB_AREA, 1000.0f, inf);
+	f.set(VC_BLOB_ASPECT, 1.5f, 6.0f);
+	for (int scale : {2, 4})
+	{
+		VCBlobFilter s = f.scaled(scale);
+		CHECK((s.min[VC_BLOB_WIDTH] == 40.0f / scale) && (s.max[VC_BLOB_WIDTH] == 400.0f / scale), "scale " << scale << ": width");
+		CHECK((s.min[VC_BLOB_HEIGHT] == -inf) && (s.max[VC_BLOB_HEIGHT] == 120.0f / scale), "scale " << scale << ": height");
+		CHECK((s.min[VC_BLOB_AREA] == 1000.0f / (scale * scale)) && (s.max[VC_BLOB_AREA] == inf), "scale " << scale << ": area");
+		CHECK((s.min[VC_BLOB_ASPECT] == 1.5f) && (s.max[VC_BLOB_ASPECT] == 6.0f), "scale " << scale << ": aspect mudou");
+		CHECK(!s.active(VC_BLOB_FILL) && !s.active(VC_BLOB_ORIENTATION), "scale " << scale << ": medida sem limites ativa");
+	}
+
+	srand(50);
+	int ncases = 0;
+	for (int k = 0; k < 2000; k++)
+	{
+		VCBlobFilter filter = random_filter();
+		OVC b = random_blob();
+		// Lados, perímetro e área múltiplos de 4 e de 16, para as reduções serem exatas
+		b.width = 4 * (1 + rand() % 63);
+		b.height = 4 * (1 + rand() % 63);
+		b.area = 16 * (1 + rand() % std::min(b.width * b.height / 16, 1023));
+		b.perimeter = 4 * (rand() % 127);
+		float orientation = (rand() % 720 - 359) / 4.0f;
+
+		VCBlobTable full;
+		full.push_back(b);
+		full.orientation[0] = orientation;
+		std::vector<int> indices;
+		int expected = full.select(filter, indices);
+
+		for (int scale : {1, 2, 4})
+		{
+			OVC r = b;
+			r.width /= scale;
+			r.height /= scale;
+			r.perimeter /= scale;
+			r.area /= scale * scale;
+			VCBlobTable reduced;
+			reduced.push_back(r);
+			reduced.orientation[0] = orientation;
+			CHECK(reduced.select(filter.scaled(scale), indices) == expected, "caso " << k << ", scale " << scale << ": esperado " << expected);
+			ncases++;
+		}
+	}
+
+	printf("scaled: %d blobs reduzidos com a mesma decisão\n", ncases);
+	return true;
+}
+
+static void fill_rect(IVC *mask, int x, int y, int width, int height)
+{
+	for (int yy = y; yy < y + height; yy++)
+		memset(mask->data + (size_t)yy * mask->bytesperline + x, 255, width);
+}
+
+// A caixa e a área de vc_binary_blob_labelling (usadas pelas regras da etiquetagem, antes de
+// vc_binary_blob_info) têm de ser as que vc_binary_blob_info mede na imagem toda; e a informação
+// medida só dentro dessa caixa tem de ser a mesma
+static bool test_labelling(void)
+{
+	IVC *mask = vc_image_new(200, 140, 1, 255);
+	IVC *labels = vc_image_new(200, 140, 1, 255);
+	memset(mask->data, 0, (size_t)mask->bytesperline * mask->height);
+
+	fill_rect(mask, 5, 5, 20, 10); // Retângulo: caixa (5, 5) 20x10, área 200
+	fill_rect(mask, 80, 5, 6, 30); // L
+	fill_rect(mask, 80, 29, 24, 6);
+	for (int y = -12; y <= 12; y++) // Disco
+		for (int x = -12; x <= 12; x++)
+			if (x * x + y * y <= 144)
+				mask->data[(size_t)(40 + y) * mask->bytesperline + 160 + x] = 255;
+	fill_rect(mask, 10, 70, 10, 10); // Dois retângulos próximos (juntos pela etiquetagem)
+	fill_rect(mask, 26, 74, 8, 12);
+	fill_rect(mask, 0, 110, 30, 20);   // Encostado à margem (a coluna 0 é limpa)
+	fill_rect(mask, 120, 100, 60, 3);  // Barra fina
+	fill_rect(mask, 150, 90, 3, 40);   // que cruza uma barra vertical
+
+	int nblobs;
+	OVC *blobs = vc_binary_blob_labelling(mask, labels, &nblobs);
+	CHECK((blobs != NULL) && (nblobs == 6), nblobs << " blobs, esperados 6");
+
+	bool rect = false;
+	for (int i = 0; i < nblobs; i++)
+	{
+		OVC full = blobs[i], boxed = blobs[i];
+		full.width = full.height = 0;
+		vc_binary_blob_info(labels, &full, 1);
+		vc_binary_blob_info(labels, &boxed, 1);
+
+		CHECK((blobs[i].x == full.x) && (blobs[i].y == full.y) && (blobs[i].width == full.width) && (blobs[i].height == full.height),
+			  "blob " << i << ": caixa da etiquetagem (" << blobs[i].x << ", " << blobs[i].y << ") " << blobs[i].width << "x" << blobs[i].height
+					  << ", medida (" << full.x << ", " << full.y << ") " << full.width << "x" << full.height);
+		CHECK(blobs[i].area == full.area, "blob " << i << ": área " << blobs[i].area << ", medida " << full.area);
+		CHECK((boxed.x == full.x) && (boxed.y == full.y) && (boxed.width == full.width) && (boxed.height == full.height) && (boxed.area == full.area) &&
+				  (boxed.perimeter == full.perimeter) && (boxed.xc == full.xc) && (boxed.yc == full.yc),
+			  "blob " << i << ": vc_binary_blob_info dentro da caixa difere da imagem toda");
+		if ((blobs[i].x == 5) && (blobs[i].y == 5))
+			rect = (blobs[i].width == 20) && (blobs[i].height == 10) && (blobs[i].area == 200);
+	}
+	CHECK(rect, "retângulo (5, 5) 20x10 com área 200 não encontrado");
+
+	free(blobs);
+	vc_image_free(labels);
+	vc_image_free(mask);
+	printf("labelling: caixa e área de %d blobs iguais às de vc_binary_blob_info\n", nblobs);
+	return true;
+}
+
+int main(void)
+{
+	return vc_test_run({test_select_random, test_select_scalar, test_select_compaction, test_load, test_measures,
+						test_orientation, test_scaled, test_labelling});
+}
@@ -0,0 +1,207 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//                 DETETOR DE CONTORNOS DE CANNY
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "vc_canny.hpp"
+#include "vc_convolve.hpp"
+
+// Linhas por tarefa (faixa)
+#define VC_CANNY_TILE 32
+
+// Setores da direção do gradiente (o contorno é perpendicular)
+#define VC_CANNY_DIR_X 0	// Gradiente horizontal: comparar com os vizinhos à esquerda e à direita
+#define VC_CANNY_DIR_XY 1	// Diagonal principal (gx e gy com o mesmo sinal)
+#define VC_CANNY_DIR_Y 2	// Gradiente vertical: comparar com os vizinhos de cima e de baixo
+#define VC_CANNY_DIR_YX 3	// Diagonal secundária
+
+// Marca provisória dos pixeis fracos (entre low e high) antes da histerese
+#define VC_CANNY_WEAK 128
+
+// Executa fn(y0, y1) para faixas de VC_CANNY_TILE linhas de [0, height)
+template <typename Fn>
+static void for_tiles(VCThreadPool *pool, int height, const Fn &fn)
+{
+	int ntiles = (height + VC_CANNY_TILE - 1) / VC_CANNY_TILE;
+	auto tile = [&](int i)
+	{ fn(i * VC_CANNY_TILE, MIN_VC((i + 1) * VC_CANNY_TILE, height)); };
+
+	if (pool != nullptr)
+		pool->parallel_for(ntiles, tile);
+	else
+		for (int i = 0; i < ntiles; i++)
+			tile(i);
+}
+
+// As etapas por faixa recebem as dimensões por valor: se fossem lidas de uma referência, as
+// escritas em unsigned char (que podem apontar para qualquer objeto) obrigavam a relê-las e
+// os ciclos não vetorizavam
+
+// Sobel (|gx| + |gy|) e direção quantizada das linhas [y0, y1); tan(22.5) ~ 53/128, tan(67.5) ~ 309/128
+// (os três buffers são distintos: __restrict evita os testes de sobreposição que impediam a vetorização)
+static void canny_gradient(const unsigned char *__restrict smooth, short *__restrict magnitude, unsigned char *__restrict direction,
+						   int width, int y0, int y1)
+{
+	for (int y = y0; y < y1; y++)
+	{
+		const unsigned char *__restrict s = smooth + (size_t)y * width;
+		short *__restrict m = magnitude + (size_t)y * width;
+		unsigned char *__restrict d = direction + (size_t)y * width;
+
+		for (int x = 3; x < width - 3; x++)
+		{
+			int gx = vc_convolve_at<VCMaskSobelX>(s + x, width);
+			int gy = vc_convolve_at<VCMaskSobelY>(s + x, width);
+			int ax = abs(gx), ay = abs(gy);
+			int diagonal = ((gx ^ gy) >= 0) ? VC_CANNY_DIR_XY : VC_CANNY_DIR_YX;
+
+			m[x] = (short)(ax + ay);
+			d[x] = (unsigned char)((ay * 128 <= ax * 53) ? VC_CANNY_DIR_X : (ay * 128 >= ax * 309) ? VC_CANNY_DIR_Y : diagonal);
+		}
+	}
+}
+
+// Supressão de não-máximos e classificação das linhas [y0, y1) de dst: 255 forte, VC_CANNY_WEAK
+// fraco, 0 nada. Em empate só o primeiro vizinho tem de ser ultrapassado (contornos com 1 pixel).
+static void canny_suppress(const short *__restrict magnitude, const unsigned char *__restrict direction, unsigned char *__restrict dst, ptrdiff_t stride,
+						   int width, int height, int low, int high, int y0, int y1)
+{
+	const int margin = VCCanny::margin;
+
+	for (int y = y0; y < y1; y++)
+	{
+		unsigned char *o = dst + y * stride;
+
+		if ((y < margin) || (y >= height - margin))
+		{
+			for (int x = 0; x < width; x++)
+				o[x] = 0;
+			continue;
+		}
+
+		const short *m = magnitude + (size_t)y * width;
+		const short *up = m - width;
+		const short *down = m + width;
+		const unsigned char *d = direction + (size_t)y * width;
+
+		for (int x = 0; x < margin; x++)
+			o[x] = o[width - 1 - x] = 0;
+		for (int x = margin; x < width - margin; x++)
+		{
+			// Vizinhos na direção do gradiente: os 8 são lidos e escolhidos sem saltos (o ciclo vetoriza)
+			int left = m[x - 1], right = m[x + 1];
+			int top = up[x], bottom = down[x];
+			int topleft = up[x - 1], topright = up[x + 1];
+			int bottomleft = down[x - 1], bottomright = down[x + 1];
+			int dir = d[x];
+			int n1 = (dir == VC_CANNY_DIR_X) ? left : (dir == VC_CANNY_DIR_Y) ? top : (dir == VC_CANNY_DIR_XY) ? topleft : topright;
+			int n2 = (dir == VC_CANNY_DIR_X) ? right : (dir == VC_CANNY_DIR_Y) ? bottom : (dir == VC_CANNY_DIR_XY) ? bottomright : bottomleft;
+			int v = m[x];
+			int edge = (v >= low) & (v > n1) & (v >= n2);
+
+			o[x] = (unsigned char)(edge ? ((v >= high) ? 255 : VC_CANNY_WEAK) : 0);
+		}
+	}
+}
+
+void VCCanny::detect(const VCGray8 &src, const VCGray8 &dst, int low, int high, VCThreadPool *pool)
+{
+	const int width = src.width();
+	const int height = src.height();
+
+	if ((width <= 2 * margin) || (height <= 2 * margin))
+	{
+		for (int y = 0; y < height; y++)
+			for (int x = 0; x < width; x++)
+				dst.row(y)[x] = 0;
+		return;
+	}
+
+	smooth.resize((size_t)width * height);
+	magnitude.assign((size_t)width * height, 0);
+	direction.resize((size_t)width * height);
+	const VCGray8 smoothed(smooth.data(), width, height);
+
+	// 1. Suavização: cada faixa filtra as suas linhas a partir de src com 2 linhas de margem
+	for_tiles(pool, height, [&](int y0, int y1)
+			  {
+				  y0 = MAX_VC(y0, 2) - 2;
+				  y1 = MIN_VC(y1, height - 2) + 2;
+				  if (y1 - y0 > 4)
+					  vc_convolve<VCMaskBinomial5>(src.sub(0, y0, width, y1 - y0), smoothed.sub(0, y0, width, y1 - y0), [](int sum)
+												   { return (unsigned char)((sum + 128) >> 8); }); });
+
+	// 2. Gradiente
+	for_tiles(pool, height, [&](int y0, int y1)
+			  { canny_gradient(smooth.data(), magnitude.data(), direction.data(), width, MAX_VC(y0, 3), MIN_VC(y1, height - 3)); });
+
+	// 3. Supressão de não-máximos
+	for_tiles(pool, height, [&](int y0, int y1)
+			  { canny_suppress(magnitude.data(), direction.data(), dst.data(), dst.stride(), width, height, low, high, y0, y1); });
+
+	// 4. Histerese: os pixeis fracos ligados (vizinhança 8) a um forte passam a fortes.
+	// Os candidatos estão todos a pelo menos margin pixeis dos limites: os vizinhos existem sempre.
+	stack.clear();
+	for (int y = margin; y < height - margin; y++)
+	{
+		const unsigned char *o = dst.row(y);
+		for (int x = margin; x < width - margin; x++)
+			if (o[x] == 255)
+				stack.push_back(y * width + x);
+	}
+	while (!stack.empty())
+	{
+		int p = stack.back();
+		stack.pop_back();
+		int y = p / width, x = p % width;
+
+		for (int j = -1; j <= 1; j++)
+		{
+			unsigned char *o = dst.row(y + j);
+			for (int i = -1; i <= 1; i++)
+			{
+				if (o[x + i] == VC_CANNY_WEAK)
+				{
+					o[x + i] = 255;
+					stack.push_back((y + j) * width + x + i);
+				}
+			}
+		}
+	}
+
+	// 5. Os fracos que sobraram não estão ligados a nenhum contorno
+	for_tiles(pool, height, [&](int y0, int y1)
+			  {
+				  for (int y = y0; y < y1; y++)
+				  {
+					  unsigned char *o = dst.row(y);
+					  for (int x = 0; x < width; x++)
+						  o[x] = (o[x] == 255) ? 255 : 0;
+				  } });
+}
+
+extern "C" int vc_gray_edge_canny(IVC *src, IVC *dst, int low, int high)
+{
+	if ((src->width <= 0) || (src->height <= 0) || (src->data == NULL) || (dst->data == NULL))
+	{
+		printf("vc_gray_edge_canny() - Erro nos parametros de entrada.\n");
+		return 0;
+	}
+	if ((src->channels != 1) || (dst->channels != 1) || (src->width != dst->width) || (src->height != dst->height))
+	{
+		printf("vc_gray_edge_canny() - As imagens têm de ser de cinzentos e ter a mesma resolução.\n");
+		return 0;
+	}
+	if ((low < 0) || (low > high))
+	{
+		printf("vc_gray_edge_canny() - Os limiares têm de verificar 0 <= low <= high.\n");
+		return 0;
+	}
+
+	VCCanny canny;
+	canny.detect(VCGray8(src->data, src->width, src->height), VCGray8(dst->data, dst->width, dst->height), low, high);
+
+	return 1;
+}
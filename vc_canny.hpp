@@ -0,0 +1,33 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//                 DETETOR DE CONTORNOS DE CANNY
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <vector>
+
+#include "vc_image.hpp"
+#include "vc_pool.hpp"
+
+// Canny em inteiros: suavização binomial 5x5 (separável), gradiente de Sobel com a direção
+// quantizada em 4 setores, supressão de não-máximos e histerese (flood com pilha a partir dos
+// pixeis fortes). As etapas por pixel correm por faixas de linhas no pool; a histerese só
+// percorre os candidatos. Os buffers ficam no objeto e são reaproveitados entre chamadas,
+// por isso cada thread deve usar o seu VCCanny.
+class VCCanny
+{
+public:
+	// Pixeis junto aos limites de src (ou da ROI) sem resultado: dst fica a 0
+	static const int margin = 4;
+
+	// dst = 255 nos contornos, 0 no resto. src e dst podem ser ROIs (VCImageView::sub) com a
+	// mesma resolução. low, high: limiares de |gx| + |gy| (Sobel da imagem suavizada, 0..2040).
+	// pool == nullptr processa as faixas na thread atual (ex.: dentro de uma tarefa do pool).
+	void detect(const VCGray8 &src, const VCGray8 &dst, int low, int high, VCThreadPool *pool = nullptr);
+
+private:
+	std::vector<unsigned char> smooth;
+	std::vector<short> magnitude;
+	std::vector<unsigned char> direction;
+	std::vector<int> stack;
+};
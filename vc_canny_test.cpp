@@ -0,0 +1,97 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//           TESTE DO CANNY POR FAIXAS NO POOL
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   vc_canny_test    teste automático (ctest): VCCanny::detect com as faixas no pool tem de dar
+//                    exatamente o mesmo resultado que na thread atual, em imagens e ROIs com
+//                    alturas que não são múltiplas da faixa e com vários limiares
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "vc_canny.hpp"
+#include "vc_test.h"
+
+// Imagem com formas (retângulos e discos com vários contrastes) e ruído
+static std::vector<unsigned char> make_image(int width, int height)
+{
+	std::vector<unsigned char> image((size_t)width * height);
+
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			int v = 60 + rand() % 24;
+			if (((x / 23) % 2) && ((y / 17) % 3 == 1))
+				v += 90;
+			int dx = x - width / 2, dy = y - height / 2;
+			if (dx * dx + dy * dy < (width * width + height * height) / 16)
+				v += 40 + (x + y) % 50;
+			image[(size_t)y * width + x] = (unsigned char)MIN_VC(v, 255);
+		}
+	}
+	return image;
+}
+
+static int count_edges(const std::vector<unsigned char> &image)
+{
+	int n = 0;
+	for (unsigned char v : image)
+		n += (v == 255);
+	return n;
+}
+
+// A imagem toda e uma ROI no meio dela (dst com o mesmo passo): com e sem pool, os dois
+// buffers de saída têm de ser iguais byte a byte (também fora da ROI, que não pode ser escrito)
+static bool test_pool(void)
+{
+	static const int sizes[][2] = {{9, 9}, {40, 31}, {64, 32}, {57, 33}, {120, 65}, {333, 97}, {640, 250}};
+	static const int thresholds[][2] = {{0, 0}, {20, 60}, {40, 100}, {120, 120}, {300, 900}};
+	VCThreadPool pool(4);
+	VCCanny serial, pooled;
+	int ncases = 0, nedges = 0;
+
+	srand(40);
+	for (const auto &size : sizes)
+	{
+		int width = size[0], height = size[1];
+		std::vector<unsigned char> image = make_image(width, height);
+		VCGray8 src(image.data(), width, height);
+
+		for (const auto &th : thresholds)
+		{
+			// Imagem toda e ROI com 3 pixeis de fora à esquerda e em cima e 2 à direita e em baixo
+			for (int roi = 0; roi < 2; roi++)
+			{
+				int x0 = roi ? 3 : 0, y0 = roi ? 3 : 0;
+				int w = roi ? width - 5 : width, h = roi ? height - 5 : height;
+				std::vector<unsigned char> a(image.size(), 77), b(image.size(), 77);
+				VCGray8 da(a.data(), width, height), db(b.data(), width, height);
+
+				serial.detect(src.sub(x0, y0, w, h), da.sub(x0, y0, w, h), th[0], th[1]);
+				pooled.detect(src.sub(x0, y0, w, h), db.sub(x0, y0, w, h), th[0], th[1], &pool);
+				CHECK(a == b, width << "x" << height << (roi ? " (ROI)" : "") << ", limiares " << th[0] << "/" << th[1]
+									 << ": com pool difere da thread atual");
+				nedges += count_edges(a);
+				ncases++;
+			}
+		}
+	}
+	CHECK(nedges > 0, "nenhum contorno em nenhum caso");
+
+	// A função de vc.h (sem pool) dá o mesmo que as faixas no pool
+	std::vector<unsigned char> image = make_image(333, 97), a(image.size()), b(image.size());
+	IVC src = {image.data(), 333, 97, 1, 255, 333}, dst = {a.data(), 333, 97, 1, 255, 333};
+	CHECK(vc_gray_edge_canny(&src, &dst, 40, 100) == 1, "vc_gray_edge_canny falhou");
+	pooled.detect(VCGray8(image.data(), 333, 97), VCGray8(b.data(), 333, 97), 40, 100, &pool);
+	CHECK(a == b, "vc_gray_edge_canny difere das faixas no pool");
+
+	printf("pool: %d casos iguais com e sem pool, %d pixeis de contorno\n", ncases, nedges);
+	return true;
+}
+
+int main(void)
+{
+	return vc_test_run({test_pool});
+}
@@ -0,0 +1,145 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//      CONTROLO DA LATÊNCIA EM TEMPO REAL (DEGRADAÇÃO)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <algorithm>
+
+#include "vc_control.hpp"
+#include "vc_trace.h"
+
+// Frações do limite (ou do período) para descer e para subir de nível; o intervalo entre as
+// duas evita oscilar entre dois níveis
+#define VC_CONTROL_DEGRADE 0.9
+#define VC_CONTROL_RESTORE 0.75
+// Peso de cada frame nas médias móveis
+#define VC_CONTROL_ALPHA 0.2
+// Frames num nível antes de uma nova decisão (para as médias refletirem o nível)
+#define VC_CONTROL_SETTLE 5
+
+// Do melhor para o pior: sem anotações, deteção a meia resolução, deteção em frames alternadas
+static const VCQuality vc_quality_levels[VC_QUALITY_LEVELS] = {
+	{true, 0, 1},
+	{false, 0, 1},
+	{false, 1, 1},
+	{false, 1, 2},
+};
+
+// Nomes dos eventos das mudanças no registo de eventos (strings constantes)
+static const char *vc_quality_names[VC_QUALITY_LEVELS] = {"quality 0", "quality 1", "quality 2", "quality 3"};
+
+VCLatencyController::VCLatencyController(unsigned long long budget, unsigned long long period, int hold)
+	: budget(budget), period(period), hold(std::max(hold, VC_CONTROL_SETTLE))
+{
+}
+
+const VCQuality &VCLatencyController::quality(int level)
+{
+	return vc_quality_levels[std::min(std::max(level, 0), VC_QUALITY_LEVELS - 1)];
+}
+
+void VCLatencyController::start(unsigned long long now)
+{
+	t0 = now;
+}
+
+unsigned long long VCLatencyController::wait(int frame, unsigned long long now) const
+{
+	unsigned long long t = arrival(frame);
+	return (t > now) ? t - now : 0;
+}
+
+bool VCLatencyController::admit(int frame, unsigned long long now)
+{
+	// Previsão do fim com o tempo de processamento atual
+	bool late = now + (unsigned long long)cost > arrival(frame) + budget;
+	if (late && (now >= arrival(frame + 1)))
+	{
+		counters.skipped++;
+		return false;
+	}
+	return true;
+}
+
+void VCLatencyController::change(int frame, int to, unsigned long long now)
+{
+	log.push_back({frame, current, to});
+	if (vc_trace_active.load(std::memory_order_relaxed))
+		vc_trace_complete(vc_quality_names[to], now, 0);
+
+	if (to > current)
+	{
+		counters.degrades++;
+		leaving = cost;
+	}
+	else
+		counters.restores++;
+
+	degraded = (to > current);
+	current = to;
+	sincechange = 0;
+	cost = 0.0;
+}
+
+void VCLatencyController::done(int frame, unsigned long long begin, unsigned long long end)
+{
+	double c = (double)(end - begin);
+	double l = (double)(end - arrival(frame));
+
+	counters.processed++;
+	counters.levelframes[current]++;
+	if (l > (double)budget)
+		counters.misses++;
+	counters.maxlatency = std::max(counters.maxlatency, l);
+
+	cost = (cost == 0.0) ? c : cost + VC_CONTROL_ALPHA * (c - cost);
+	latency = (counters.processed == 1) ? l : latency + VC_CONTROL_ALPHA * (l - latency);
+	sincechange++;
+
+	// Razão entre o nível anterior e este, medida depois de o nível estabilizar
+	if (degraded && (sincechange == VC_CONTROL_SETTLE) && (leaving > 0.0))
+		ratio[current] = leaving / cost;
+
+	if (sincechange < VC_CONTROL_SETTLE)
+		return;
+
+	// O processamento tem de caber no limite da latência e no período da origem
+	double limit = (double)std::min(budget, period);
+	if ((current < VC_QUALITY_LEVELS - 1) && ((latency > VC_CONTROL_DEGRADE * budget) || (cost > VC_CONTROL_DEGRADE * period)))
+	{
+		change(frame, current + 1, end);
+		return;
+	}
+
+	if ((current > 0) && (sincechange >= hold) && (ratio[current] > 0.0) &&
+		(cost * ratio[current] < VC_CONTROL_RESTORE * limit) && (latency < VC_CONTROL_RESTORE * budget))
+		change(frame, current - 1, end);
+}
+
+VCControlStats VCLatencyController::stats() const
+{
+	VCControlStats s = counters;
+
+	s.frames = counters.processed + counters.skipped;
+	s.level = current;
+	s.cost = cost / 1e6;
+	s.latency = latency / 1e6;
+	s.maxlatency = counters.maxlatency / 1e6;
+	return s;
+}
+
+void VCLatencyController::report(FILE *file) const
+{
+	VCControlStats s = stats();
+
+	fprintf(file, "realtime: budget %.1f ms, period %.1f ms, %d frames, %d processed, %d skipped, %d over budget\n",
+			budget / 1e6, period / 1e6, s.frames, s.processed, s.skipped, s.misses);
+	fprintf(file, "realtime: quality %d (%d degrades, %d restores), cost %.2f ms, latency %.2f ms (max %.2f ms)\n",
+			s.level, s.degrades, s.restores, s.cost, s.latency, s.maxlatency);
+	fprintf(file, "%-8s %8s %8s %8s %8s\n", "quality", "frames", "overlay", "pyramid", "interval");
+	for (int i = 0; i < VC_QUALITY_LEVELS; i++)
+	{
+		const VCQuality &q = quality(i);
+		fprintf(file, "%-8d %8d %8s %8d %8d\n", i, s.levelframes[i], q.overlay ? "yes" : "no", q.level, q.interval);
+	}
+	fflush(file);
+}
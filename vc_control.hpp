@@ -0,0 +1,93 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//      CONTROLO DA LATÊNCIA EM TEMPO REAL (DEGRADAÇÃO)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+// Qualidade do processamento de uma frame. Os níveis vão do melhor (0) para o pior e cada um
+// acrescenta uma degradação às do nível anterior.
+struct VCQuality
+{
+	bool overlay; // Anotações e HUD desenhados na frame
+	int level;	  // Nível da pirâmide da deteção (VCPipeline::set_level)
+	int interval; // Deteção em 1 de cada interval frames (VCPipeline::set_detection_interval)
+};
+
+#define VC_QUALITY_LEVELS 4
+
+// Mudança do nível de qualidade
+struct VCControlDecision
+{
+	int frame;	  // Frame (índice na origem) cujo fim de processamento levou à decisão
+	int from, to; // Níveis de qualidade
+};
+
+struct VCControlStats
+{
+	int frames;	   // Frames processadas ou descartadas
+	int processed; // Frames processadas
+	int skipped;   // Frames descartadas por já não cumprirem o limite
+	int misses;	   // Frames processadas que acabaram depois do limite
+	int degrades, restores;
+	int level;							// Nível de qualidade atual
+	int levelframes[VC_QUALITY_LEVELS]; // Frames processadas em cada nível
+	double cost;						// Média móvel do tempo de processamento no nível atual (ms)
+	double latency;						// Média móvel da latência (ms)
+	double maxlatency;					// (ms)
+};
+
+// Controlador do modo de tempo real: a frame i da origem chega em start + i * period e deve
+// estar processada até budget depois da chegada.
+// - Frames que já não cumprem o limite são descartadas quando já chegou uma mais recente.
+// - Quando a média móvel da latência (ou do tempo de processamento, face ao período) se aproxima
+//   do limite, a qualidade desce um nível; sobe um nível quando a previsão do tempo no nível
+//   acima (tempo atual x razão medida entre os dois níveis) deixa folga suficiente, depois de
+//   hold frames no nível atual. Cada descida volta a medir a razão, por isso uma subida
+//   desfeita não se repete enquanto a carga não mudar.
+// O controlador não lê o relógio: todos os instantes (ns) são argumentos, por isso pode ser
+// testado com um relógio simulado (vc_control_test.cpp).
+class VCLatencyController
+{
+public:
+	VCLatencyController(unsigned long long budget, unsigned long long period, int hold = 30);
+
+	// Chegada da frame 0
+	void start(unsigned long long now);
+	unsigned long long arrival(int frame) const { return t0 + (unsigned long long)frame * period; }
+	// Tempo até à chegada da frame (0 se já chegou)
+	unsigned long long wait(int frame, unsigned long long now) const;
+	// Processar a frame? Falso (frame descartada) se já não cumpre o limite e a seguinte já
+	// chegou. Uma chamada por frame, pela ordem da origem.
+	bool admit(int frame, unsigned long long now);
+	// Fim do processamento de uma frame admitida (begin: início do processamento)
+	void done(int frame, unsigned long long begin, unsigned long long end);
+
+	int level() const { return current; }
+	const VCQuality &quality() const { return quality(current); }
+	static const VCQuality &quality(int level);
+
+	VCControlStats stats() const;
+	const std::vector<VCControlDecision> &decisions() const { return log; }
+	void report(FILE *file) const;
+
+private:
+	void change(int frame, int to, unsigned long long now);
+
+	unsigned long long budget, period;
+	int hold;
+	unsigned long long t0 = 0;
+
+	int current = 0;
+	int sincechange = 0;   // Frames processadas desde a última mudança
+	bool degraded = false; // A última mudança foi uma descida
+	double cost = 0.0;	   // Média móvel do tempo de processamento no nível atual (ns; 0 = sem medidas)
+	double latency = 0.0;  // Média móvel da latência (ns)
+	double leaving = 0.0;  // Tempo de processamento no nível anterior, ao descer
+	double ratio[VC_QUALITY_LEVELS] = {}; // Tempo no nível i - 1 / tempo no nível i (0 = desconhecida)
+
+	VCControlStats counters = {};
+	std::vector<VCControlDecision> log;
+};
@@ -0,0 +1,164 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//     TESTE DO CONTROLO DA LATÊNCIA (RELÓGIO SIMULADO)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   vc_control_test    teste automático (ctest): a origem e o processamento são simulados, com o
+//                      tempo de cada frame dado por um modelo por nível de qualidade, e as
+//                      decisões do controlador são comparadas com o comportamento esperado
+
+#include <functional>
+#include <iostream>
+#include <stdio.h>
+#include <vector>
+
+#include "vc_control.hpp"
+#include "vc_test.h"
+
+#define MS 1000000ULL
+// Origem a 30 fps; a frame é lida (descodificada) antes de ser admitida ou descartada
+#define PERIOD (33 * MS + MS / 3)
+#define DECODE (2 * MS)
+
+// Tempo de processamento (ns) da frame i num nível de qualidade
+typedef std::function<unsigned long long(int frame, int level)> VCCostModel;
+
+// Processar nframes frames da origem simulada
+static void simulate(VCLatencyController &control, int nframes, const VCCostModel &cost)
+{
+	unsigned long long now = 1000 * MS;
+
+	control.start(now);
+	for (int i = 0; i < nframes; i++)
+	{
+		now += control.wait(i, now);
+		now += DECODE;
+		if (!control.admit(i, now))
+			continue;
+
+		unsigned long long begin = now;
+		now += cost(i, control.level());
+		control.done(i, begin, now);
+	}
+}
+
+// Decisões entre as frames first e last
+static int count_decisions(const VCLatencyController &control, int first, int last, int *restores = NULL)
+{
+	int n = 0;
+	for (const VCControlDecision &d : control.decisions())
+	{
+		if ((d.frame >= first) && (d.frame < last))
+		{
+			n++;
+			if ((restores != NULL) && (d.to < d.from))
+				(*restores)++;
+		}
+	}
+	return n;
+}
+
+// Processamento com folga: nenhuma frame descartada e qualidade máxima
+static bool test_headroom(void)
+{
+	VCLatencyController control(PERIOD, PERIOD);
+	simulate(control, 600, [](int, int)
+			 { return 12 * MS; });
+
+	VCControlStats s = control.stats();
+	CHECK(s.processed == 600, "processadas " << s.processed << " de 600");
+	CHECK((s.skipped == 0) && (s.misses == 0), s.skipped << " descartadas, " << s.misses << " fora do limite");
+	CHECK(control.decisions().empty(), control.decisions().size() << " mudanças de nível");
+
+	printf("headroom: %d frames, latencia %.1f ms\n", s.processed, s.latency);
+	return true;
+}
+
+// Sobrecarga (frames 0-599) e depois alívio: desce até um nível que cabe no período, fica
+// estável, e volta à qualidade máxima quando a carga baixa
+static bool test_overload(void)
+{
+	// Tempos por nível na sobrecarga e a metade no alívio
+	static const double costs[VC_QUALITY_LEVELS] = {48.0, 42.0, 24.0, 14.0};
+	VCCostModel cost = [](int frame, int level)
+	{
+		double ms = costs[level] * ((frame < 600) ? 1.0 : 0.5);
+		return (unsigned long long)(ms * MS);
+	};
+
+	VCLatencyController control(50 * MS, PERIOD);
+	simulate(control, 1200, cost);
+	VCControlStats s = control.stats();
+
+	// Desce até ao nível 2 (24 ms < 0.9 x 33.3 ms) nas primeiras frames e não oscila
+	int degraded = -1;
+	for (const VCControlDecision &d : control.decisions())
+		if ((d.to == 2) && (d.frame < 600))
+			degraded = d.frame;
+	CHECK((degraded >= 0) && (degraded < 60), "nível 2 na frame " << degraded);
+	CHECK(count_decisions(control, degraded + 1, 600) == 0, "mudanças durante a sobrecarga estável");
+	CHECK(s.skipped > 0, "nenhuma frame descartada no início da sobrecarga");
+
+	// No alívio volta ao nível 0 (24 ms < 0.75 x 33.3 ms), sem voltar a descer
+	CHECK(s.level == 0, "nível " << s.level << " no fim");
+	int restores = 0;
+	int n = count_decisions(control, 600, 1200, &restores);
+	CHECK((n == 2) && (restores == 2), n << " mudanças no alívio, " << restores << " subidas");
+	CHECK(control.decisions().back().frame < 800, "nível 0 só na frame " << control.decisions().back().frame);
+
+	printf("overload: nivel 2 na frame %d, %d descartadas, nivel 0 na frame %d\n", degraded, s.skipped, control.decisions().back().frame);
+	return true;
+}
+
+// A razão medida entre níveis deixa de valer (o nível 0 ficou mais caro e o 1 mais barato):
+// a subida falha uma vez e a razão medida na descida seguinte impede novas tentativas
+static bool test_failed_restore(void)
+{
+	VCCostModel cost = [](int frame, int level)
+	{
+		if (frame < 200)
+			return (level == 0) ? 36 * MS : 20 * MS;
+		return (level == 0) ? 40 * MS : 12 * MS;
+	};
+
+	VCLatencyController control(50 * MS, PERIOD, 30);
+	simulate(control, 1200, cost);
+
+	int restores = 0;
+	int n = count_decisions(control, 200, 1200, &restores);
+	CHECK((n == 2) && (restores == 1), n << " mudanças, " << restores << " subidas");
+	CHECK(control.level() == 1, "nível " << control.level() << " no fim");
+
+	printf("failed restore: %d subida desfeita em 1000 frames\n", restores);
+	return true;
+}
+
+// O mesmo modelo dá sempre as mesmas decisões
+static bool test_deterministic(void)
+{
+	VCCostModel cost = [](int frame, int level)
+	{
+		// Tempo variável, mas função só da frame e do nível
+		unsigned long long jitter = (unsigned long long)((frame * 7919) % 23) * MS;
+		return (unsigned long long)(30 - 6 * level) * MS + jitter;
+	};
+
+	VCLatencyController a(40 * MS, PERIOD), b(40 * MS, PERIOD);
+	simulate(a, 2000, cost);
+	simulate(b, 2000, cost);
+
+	CHECK(a.decisions().size() == b.decisions().size(), "número de decisões diferente");
+	for (size_t i = 0; i < a.decisions().size(); i++)
+	{
+		const VCControlDecision &da = a.decisions()[i], &db = b.decisions()[i];
+		CHECK((da.frame == db.frame) && (da.from == db.from) && (da.to == db.to), "decisão " << i << " diferente");
+	}
+	CHECK(a.stats().skipped == b.stats().skipped, "frames descartadas diferentes");
+
+	printf("deterministic: %zu decisoes, %d descartadas\n", a.decisions().size(), a.stats().skipped);
+	return true;
+}
+
+int main(void)
+{
+	return vc_test_run({test_headroom, test_overload, test_failed_restore, test_deterministic});
+}
@@ -0,0 +1,300 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//        CONVOLUÇÃO COM MÁSCARAS FIXAS EM COMPILAÇÃO
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <utility>
+#include <vector>
+
+#include "vc_image.hpp"
+
+// Máscara K x K (K ímpar) com os coeficientes inteiros como parâmetros do template, por linhas.
+// Como os coeficientes são constantes, cada tap é gerado à parte: os zeros desaparecem (nem o
+// pixel é lido), os ±1 ficam somas/subtrações e só os restantes têm multiplicação.
+template <int K, int... M>
+struct VCMask
+{
+	static_assert((K % 2 == 1) && (sizeof...(M) == (size_t)K * K), "VCMask: K tem de ser ímpar e ter K*K coeficientes");
+
+	static constexpr int size = K;
+	static constexpr int radius = K / 2;
+	static constexpr int taps[K * K] = {M...};
+
+	static constexpr int at(int y, int x) { return taps[y * K + x]; }
+
+	// Primeiro coeficiente não nulo (pivô da decomposição)
+	static constexpr int pivot_index()
+	{
+		for (int i = 0; i < K * K; i++)
+			if (taps[i] != 0)
+				return i;
+		return 0;
+	}
+	static constexpr int pivot_y = pivot_index() / K;
+	static constexpr int pivot_x = pivot_index() % K;
+	static constexpr int pivot = taps[pivot_index()];
+
+	// Separável (característica 1): M[y][x] * pivô == M[y][px] * M[py][x] para todos os y, x.
+	// Então M = coluna (M[y][px]) x linha (M[py][x]) / pivô, com divisão exata no fim.
+	static constexpr bool rank1()
+	{
+		for (int y = 0; y < K; y++)
+			for (int x = 0; x < K; x++)
+				if (at(y, x) * pivot != at(y, pivot_x) * at(pivot_y, x))
+					return false;
+		return pivot != 0;
+	}
+	static constexpr int column(int y) { return at(y, pivot_x); }
+	static constexpr int row(int x) { return at(pivot_y, x); }
+
+	// Ganho de uma máscara de gradiente: soma dos coeficientes positivos, a resposta a um degrau
+	// de 1 nível perpendicular à máscara
+	static constexpr int positive_sum()
+	{
+		int n = 0;
+		for (int i = 0; i < K * K; i++)
+			n += (taps[i] > 0) ? taps[i] : 0;
+		return n;
+	}
+	static constexpr int gain = positive_sum();
+
+	static constexpr int nonzero()
+	{
+		int n = 0;
+		for (int i = 0; i < K * K; i++)
+			n += (taps[i] != 0);
+		return n;
+	}
+	static constexpr int nonzero_separable()
+	{
+		int n = 0;
+		for (int i = 0; i < K; i++)
+			n += (column(i) != 0) + (row(i) != 0);
+		return n;
+	}
+
+	// A versão separável guarda as somas horizontais de K linhas; só é usada quando poupa taps
+	// (mais um pelo acesso ao buffer)
+	static constexpr bool separable = rank1() && (nonzero_separable() + 1 < nonzero());
+};
+
+// Um tap: W * p[offset], com W conhecido em compilação
+template <int W, typename T>
+inline int vc_tap(const T *p, ptrdiff_t offset)
+{
+	if constexpr (W == 0)
+		return 0;
+	else if constexpr (W == 1)
+		return (int)p[offset];
+	else if constexpr (W == -1)
+		return -(int)p[offset];
+	else
+		return W * (int)p[offset];
+}
+
+template <typename Mask, typename T, size_t... I>
+inline int vc_convolve_taps(const T *p, ptrdiff_t stride, std::index_sequence<I...>)
+{
+	return (0 + ... + vc_tap<Mask::taps[I]>(p, ((int)I / Mask::size - Mask::radius) * stride + ((int)I % Mask::size - Mask::radius)));
+}
+
+// Resposta da máscara centrada em p (stride em elementos)
+template <typename Mask, typename T>
+inline int vc_convolve_at(const T *p, ptrdiff_t stride)
+{
+	return vc_convolve_taps<Mask>(p, stride, std::make_index_sequence<Mask::size * Mask::size>());
+}
+
+template <typename Mask, typename T, size_t... I>
+inline int vc_convolve_row_taps(const T *p, std::index_sequence<I...>)
+{
+	return (0 + ... + vc_tap<Mask::row(I)>(p, (int)I - Mask::radius));
+}
+
+template <typename Mask, size_t... I>
+inline int vc_convolve_column_taps(int *const *rows, int x, std::index_sequence<I...>)
+{
+	return (0 + ... + vc_tap<Mask::column(I)>(rows[I], x));
+}
+
+// Convolução no interior da imagem (as margens de raio Mask::radius não são escritas).
+// out(sum) converte a resposta inteira no valor do pixel de dst.
+template <typename Mask, typename Out>
+void vc_convolve(const VCGray8 &src, const VCGray8 &dst, Out out)
+{
+	constexpr int r = Mask::radius;
+	const int width = src.width();
+	const int height = src.height();
+
+	if ((width <= 2 * r) || (height <= 2 * r))
+		return;
+
+	if constexpr (!Mask::separable)
+	{
+		for (int y = r; y < height - r; y++)
+		{
+			const unsigned char *s = src.row(y);
+			unsigned char *d = dst.row(y);
+
+			for (int x = r; x < width - r; x++)
+				d[x] = out(vc_convolve_at<Mask>(s + x, src.stride()));
+		}
+	}
+	else
+	{
+		// Somas horizontais das últimas K linhas (buffer circular); cada linha de src é
+		// filtrada horizontalmente uma só vez
+		constexpr int K = Mask::size;
+		std::vector<int> buffer((size_t)K * width);
+		int *rows[K];
+
+		auto horizontal = [&](int y, int *h)
+		{
+			const unsigned char *s = src.row(y);
+			for (int x = r; x < width - r; x++)
+				h[x] = vc_convolve_row_taps<Mask>(s + x, std::make_index_sequence<K>());
+		};
+
+		for (int i = 0; i < K - 1; i++)
+			horizontal(i, &buffer[(size_t)i * width]);
+
+		for (int y = r; y < height - r; y++)
+		{
+			horizontal(y + r, &buffer[(size_t)((y + r) % K) * width]);
+			for (int i = 0; i < K; i++)
+				rows[i] = &buffer[(size_t)((y - r + i) % K) * width];
+
+			unsigned char *d = dst.row(y);
+			for (int x = r; x < width - r; x++)
+				d[x] = out(vc_convolve_column_taps<Mask>(rows, x, std::make_index_sequence<K>()) / Mask::pivot);
+		}
+	}
+}
+
+// Normas do gradiente em inteiros, divididas pelo ganho G da máscara e saturadas a 255: a
+// magnitude fica em níveis de cinzento por pixel (um degrau de 100 níveis dá 100 com qualquer
+// máscara), em vez de 3x (Prewitt), 4x (Sobel) ou 16x (Scharr) o degrau
+template <int G>
+struct VCNormL1
+{
+	int operator()(int gx, int gy) const
+	{
+		int m = (abs(gx) + abs(gy)) / G;
+		return (m > 255) ? 255 : m;
+	}
+};
+
+template <int G>
+struct VCNormLInf
+{
+	int operator()(int gx, int gy) const
+	{
+		int m = MAX_VC(abs(gx), abs(gy)) / G;
+		return (m > 255) ? 255 : m;
+	}
+};
+
+// L2: parte inteira de sqrt(gx^2 + gy^2) / G. Com as magnitudes do Scharr (até 255 x 16) a raiz
+// em float de um inteiro pode arredondar para o inteiro seguinte, por isso é corrigida em
+// inteiros antes da divisão; ao contrário de uma tabela, vetoriza (sqrtps)
+template <int G>
+struct VCNormL2
+{
+	int operator()(int gx, int gy) const
+	{
+		const int limit = 255 * G;
+		int m = gx * gx + gy * gy;
+		m = (m > limit * limit) ? limit * limit : m;
+		int r = (int)sqrtf((float)m);
+		r -= (r * r > m);
+		return r / G;
+	}
+};
+
+// Magnitude do gradiente em dst e o seu histograma, numa só passagem sobre src (o histograma de
+// cada linha é feito logo a seguir à linha).
+// As margens (raio da máscara) ficam a 0 e também são contadas no histograma.
+template <typename MaskX, typename MaskY, template <int> class NormG>
+void vc_edge_magnitude(const VCGray8 &src, const VCGray8 &dst, int histogram[256])
+{
+	static_assert(MaskX::gain == MaskY::gain, "vc_edge_magnitude: as duas máscaras têm de ter o mesmo ganho");
+	typedef NormG<MaskX::gain> Norm;
+	constexpr int r = MaskX::radius;
+	const int width = src.width();
+	const int height = src.height();
+	const ptrdiff_t stride = src.stride(); // Lido uma vez: com as escritas em dst o compilador teria de o reler e não vetorizava
+	const Norm norm;
+	long int interior = 0;
+
+	// Quatro histogramas parciais: pixeis seguidos com o mesmo nível (quase todos 0) não ficam
+	// à espera do incremento anterior do mesmo contador
+	int partial[4][256] = {{0}};
+
+	for (int y = 0; y < height; y++)
+	{
+		unsigned char *d = dst.row(y);
+
+		if ((y < r) || (y >= height - r) || (width <= 2 * r))
+		{
+			for (int x = 0; x < width; x++)
+				d[x] = 0;
+			continue;
+		}
+
+		const unsigned char *s = src.row(y);
+		for (int x = 0; x < r; x++)
+			d[x] = d[width - 1 - x] = 0;
+		for (int x = r; x < width - r; x++)
+			d[x] = (unsigned char)norm(vc_convolve_at<MaskX>(s + x, stride), vc_convolve_at<MaskY>(s + x, stride));
+
+		// A linha acabou de ser escrita e ainda está na cache
+		int x = r;
+		for (; x + 3 < width - r; x += 4)
+		{
+			partial[0][d[x]]++;
+			partial[1][d[x + 1]]++;
+			partial[2][d[x + 2]]++;
+			partial[3][d[x + 3]]++;
+		}
+		for (; x < width - r; x++)
+			partial[0][d[x]]++;
+		interior += width - 2 * r;
+	}
+
+	for (int i = 0; i < 256; i++)
+		histogram[i] = partial[0][i] + partial[1][i] + partial[2][i] + partial[3][i];
+	histogram[0] += (int)((long int)width * height - interior);
+}
+
+// Máscaras
+
+typedef VCMask<5,
+			   1, 4, 7, 4, 1,
+			   4, 16, 26, 16, 4,
+			   7, 26, 41, 26, 7,
+			   4, 16, 26, 16, 4,
+			   1, 4, 7, 4, 1>
+	VCMaskGaussian5; // Soma 273
+
+typedef VCMask<5,
+			   1, 4, 6, 4, 1,
+			   4, 16, 24, 16, 4,
+			   6, 24, 36, 24, 6,
+			   4, 16, 24, 16, 4,
+			   1, 4, 6, 4, 1>
+	VCMaskBinomial5; // [1 4 6 4 1] x [1 4 6 4 1], soma 256 (separável)
+
+typedef VCMask<3, 0, -1, 0, -1, 4, -1, 0, -1, 0> VCMaskLaplacian4;
+typedef VCMask<3, -1, -1, -1, -1, 8, -1, -1, -1, -1> VCMaskLaplacian8;
+typedef VCMask<3, 1, -2, 1, -2, 4, -2, 1, -2, 1> VCMaskLaplacianDiagonal; // [1 -2 1] x [1 -2 1]
+
+typedef VCMask<3, -1, 0, 1, -1, 0, 1, -1, 0, 1> VCMaskPrewittX;
+typedef VCMask<3, -1, -1, -1, 0, 0, 0, 1, 1, 1> VCMaskPrewittY;
+typedef VCMask<3, -1, 0, 1, -2, 0, 2, -1, 0, 1> VCMaskSobelX;
+typedef VCMask<3, -1, -2, -1, 0, 0, 0, 1, 2, 1> VCMaskSobelY;
+typedef VCMask<3, -3, 0, 3, -10, 0, 10, -3, 0, 3> VCMaskScharrX;
+typedef VCMask<3, -3, -10, -3, 0, 0, 0, 3, 10, 3> VCMaskScharrY;
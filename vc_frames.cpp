@@ -0,0 +1,299 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//          SEQUÊNCIAS DE FRAMES EM BRUTO (REPETIÇÃO)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include "vc_frames.hpp"
+
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef VC_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+static const char vc_frames_magic[8] = {'V', 'C', 'F', 'R', 'A', 'M', 'E', 'S'};
+static const uint32_t vc_frames_version = 1;
+static const uint64_t vc_frames_align = 64;
+
+static_assert(sizeof(VCFramesHeader) == 64, "VCFramesHeader tem de ter 64 bytes");
+static_assert(sizeof(VCFramesEntry) == 16, "VCFramesEntry tem de ter 16 bytes");
+
+// Zeros até à próxima posição múltipla de 64 bytes (início de uma frame ou do índice)
+static bool vc_frames_pad(FILE *file, uint64_t *position)
+{
+	static const unsigned char zeros[vc_frames_align] = {0};
+	size_t padding = (size_t)((vc_frames_align - *position % vc_frames_align) % vc_frames_align);
+
+	*position += padding;
+	return (padding == 0) || (fwrite(zeros, 1, padding, file) == padding);
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//                          ESCRITA
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+bool VCFrameWriter::open(const char *filename, int width, int height, int channels, double fps, int compression)
+{
+	close();
+
+	if ((filename == NULL) || (width <= 0) || (height <= 0) || (channels <= 0) ||
+		((compression != VC_FRAMES_RAW) && (compression != VC_FRAMES_LZ4)))
+	{
+		printf("VCFrameWriter::open() - Erro nos parametros de entrada.\n");
+		return false;
+	}
+#ifndef VC_HAVE_LZ4
+	if (compression == VC_FRAMES_LZ4)
+	{
+		printf("VCFrameWriter::open() - Compilado sem LZ4: as frames ficam sem compressão.\n");
+		compression = VC_FRAMES_RAW;
+	}
+#endif
+
+	file = fopen(filename, "wb");
+	if (file == NULL)
+	{
+		printf("VCFrameWriter::open() - Erro ao abrir o ficheiro %s\n", filename);
+		return false;
+	}
+
+	header = {};
+	memcpy(header.magic, vc_frames_magic, sizeof(header.magic));
+	header.version = vc_frames_version;
+	header.width = (uint32_t)width;
+	header.height = (uint32_t)height;
+	header.channels = (uint32_t)channels;
+	header.compression = (uint32_t)compression;
+	header.fps1000 = (fps > 0.0) ? (uint32_t)(fps * 1000.0 + 0.5) : 0;
+
+	// Cabeçalho provisório (count = 0): um ficheiro interrompido não é lido como válido
+	index.clear();
+	failed = fwrite(&header, sizeof(header), 1, file) != 1;
+	position = sizeof(header);
+
+	return !failed;
+}
+
+bool VCFrameWriter::write(const IVC *frame)
+{
+	if ((file == NULL) || failed)
+		return false;
+	if ((frame == NULL) || (frame->data == NULL) || (frame->width != (int)header.width) ||
+		(frame->height != (int)header.height) || (frame->channels != (int)header.channels))
+	{
+		printf("VCFrameWriter::write() - A frame não tem a resolução ou os canais da sequência.\n");
+		return false;
+	}
+
+	size_t rowsize = (size_t)frame->width * frame->channels;
+	size_t framesize = rowsize * frame->height;
+	const unsigned char *pixels = frame->data;
+
+	// Linhas com espaço entre elas: juntar primeiro
+	if ((size_t)frame->bytesperline != rowsize)
+	{
+		packed.resize(framesize);
+		for (int y = 0; y < frame->height; y++)
+			memcpy(&packed[rowsize * y], frame->data + (size_t)frame->bytesperline * y, rowsize);
+		pixels = packed.data();
+	}
+
+	size_t stored = framesize;
+#ifdef VC_HAVE_LZ4
+	if (header.compression == VC_FRAMES_LZ4)
+	{
+		compressed.resize(LZ4_compressBound((int)framesize));
+		int n = LZ4_compress_default((const char *)pixels, (char *)compressed.data(), (int)framesize, (int)compressed.size());
+		// Frames que não diminuem ficam sem compressão (e são lidas sem cópia)
+		if ((n > 0) && ((size_t)n < framesize))
+		{
+			pixels = compressed.data();
+			stored = (size_t)n;
+		}
+	}
+#endif
+
+	if (!vc_frames_pad(file, &position) || (fwrite(pixels, 1, stored, file) != stored))
+		failed = true;
+	if (failed)
+	{
+		printf("VCFrameWriter::write() - Erro ao escrever a frame %d.\n", (int)index.size());
+		return false;
+	}
+
+	index.push_back({position, stored});
+	position += stored;
+
+	return true;
+}
+
+bool VCFrameWriter::close()
+{
+	if (file == NULL)
+		return false;
+
+	// Índice no fim e cabeçalho final no início
+	bool ok = !failed && vc_frames_pad(file, &position);
+	header.count = (uint32_t)index.size();
+	header.index = position;
+	if (ok && !index.empty())
+		ok = fwrite(index.data(), sizeof(VCFramesEntry), index.size(), file) == index.size();
+	if (ok)
+		ok = (fseek(file, 0, SEEK_SET) == 0) && (fwrite(&header, sizeof(header), 1, file) == 1);
+	if (fclose(file) != 0)
+		ok = false;
+	file = NULL;
+
+	if (!ok)
+		printf("VCFrameWriter::close() - Erro ao escrever o índice da sequência.\n");
+
+	index.clear();
+	failed = false;
+
+	return ok;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//                          LEITURA
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+bool VCFrameReader::open(const char *filename)
+{
+	close();
+
+	if (filename == NULL)
+		return false;
+
+#ifdef _WIN32
+	// Sem mmap: o ficheiro é lido para memória de uma só vez
+	FILE *file = fopen(filename, "rb");
+	if (file == NULL)
+		return false;
+	fseek(file, 0, SEEK_END);
+	long int filesize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (filesize < (long int)sizeof(VCFramesHeader))
+	{
+		fclose(file);
+		return false;
+	}
+	data = (unsigned char *)malloc((size_t)filesize);
+	size = (size_t)filesize;
+	if ((data == NULL) || (fread(data, 1, size, file) != size))
+	{
+		fclose(file);
+		close();
+		return false;
+	}
+	fclose(file);
+#else
+	int fd = ::open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof(VCFramesHeader)))
+	{
+		::close(fd);
+		return false;
+	}
+	void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (map == MAP_FAILED)
+		return false;
+	data = (unsigned char *)map;
+	size = (size_t)st.st_size;
+#endif
+
+	// Validar o cabeçalho e o índice antes de aceitar qualquer frame
+	memcpy(&header, data, sizeof(header));
+	uint64_t framesize = (uint64_t)header.width * header.height * header.channels;
+	if ((memcmp(header.magic, vc_frames_magic, sizeof(header.magic)) != 0) || (header.version != vc_frames_version) ||
+		(framesize == 0) || (header.count == 0) || (header.index % alignof(VCFramesEntry) != 0) ||
+		(header.index > size) || ((size - header.index) / sizeof(VCFramesEntry) < header.count))
+	{
+		close();
+		return false;
+	}
+	index = (const VCFramesEntry *)(data + header.index);
+	for (uint32_t i = 0; i < header.count; i++)
+	{
+		if ((index[i].offset > header.index) || (index[i].size > header.index - index[i].offset) ||
+			(index[i].size > framesize) || ((index[i].size < framesize) && (header.compression != VC_FRAMES_LZ4)))
+		{
+			printf("VCFrameReader::open() - Índice inválido na frame %u de %s\n", i, filename);
+			close();
+			return false;
+		}
+	}
+#ifndef VC_HAVE_LZ4
+	if (header.compression == VC_FRAMES_LZ4)
+	{
+		printf("VCFrameReader::open() - %s tem frames LZ4, mas o programa foi compilado sem LZ4.\n", filename);
+		close();
+		return false;
+	}
+#endif
+
+#ifndef _WIN32
+	// Repetição normal: do início para o fim
+	madvise(data, size, MADV_SEQUENTIAL);
+#endif
+
+	return true;
+}
+
+void VCFrameReader::close()
+{
+	if (data != nullptr)
+	{
+#ifdef _WIN32
+		free(data);
+#else
+		munmap(data, size);
+#endif
+	}
+	data = nullptr;
+	size = 0;
+	header = {};
+	index = nullptr;
+	unpacked.clear();
+	unpacked.shrink_to_fit();
+}
+
+bool VCFrameReader::frame(int i, IVC *image)
+{
+	if ((data == nullptr) || (image == NULL) || (i < 0) || (i >= (int)header.count))
+		return false;
+
+	unsigned char *pixels = data + index[i].offset;
+
+#ifdef VC_HAVE_LZ4
+	size_t framesize = (size_t)header.width * header.height * header.channels;
+	if (index[i].size < framesize)
+	{
+		unpacked.resize(framesize);
+		int n = LZ4_decompress_safe((const char *)pixels, (char *)unpacked.data(), (int)index[i].size, (int)framesize);
+		if (n != (int)framesize)
+		{
+			printf("VCFrameReader::frame() - Erro ao descomprimir a frame %d.\n", i);
+			return false;
+		}
+		pixels = unpacked.data();
+	}
+#endif
+
+	image->data = pixels;
+	image->width = (int)header.width;
+	image->height = (int)header.height;
+	image->channels = (int)header.channels;
+	image->levels = 255;
+	image->bytesperline = (int)(header.width * header.channels);
+
+	return true;
+}
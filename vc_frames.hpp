@@ -0,0 +1,110 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//          SEQUÊNCIAS DE FRAMES EM BRUTO (REPETIÇÃO)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+extern "C"
+{
+#include "vc.h"
+}
+
+// Frames já descodificadas num ficheiro, para repetir o processamento sem voltar a descodificar
+// o vídeo (ex.: afinar os limiares da segmentação). Disposição (little-endian):
+//   cabeçalho  64 bytes: "VCFRAMES", versão, largura, altura, canais, n. de frames, compressão,
+//              fps * 1000, posição do índice
+//   frames     os pixeis de cada frame (linhas contíguas, sem espaço entre linhas), a começar em
+//              múltiplos de 64 bytes; comprimidas com LZ4 se a compressão o pedir e reduzir a frame
+//   índice     por frame, posição e tamanho no ficheiro (tamanho == largura * altura * canais
+//              significa frame sem compressão)
+// O índice fica no fim para o ficheiro poder ser escrito à medida que as frames chegam.
+#define VC_FRAMES_RAW 0
+#define VC_FRAMES_LZ4 1
+
+struct VCFramesHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t width, height, channels;
+	uint32_t count;
+	uint32_t compression;
+	uint32_t fps1000;
+	uint64_t index;
+	uint8_t reserved[16];
+};
+
+struct VCFramesEntry
+{
+	uint64_t offset;
+	uint64_t size;
+};
+
+// Escrita de uma sequência, frame a frame (ex.: em paralelo com a leitura de um cv::VideoCapture)
+class VCFrameWriter
+{
+public:
+	VCFrameWriter() = default;
+	~VCFrameWriter() { close(); }
+
+	VCFrameWriter(const VCFrameWriter &) = delete;
+	VCFrameWriter &operator=(const VCFrameWriter &) = delete;
+
+	// Sem LZ4 na compilação (VC_HAVE_LZ4), VC_FRAMES_LZ4 escreve as frames sem compressão
+	bool open(const char *filename, int width, int height, int channels, double fps, int compression = VC_FRAMES_RAW);
+	// Acrescentar uma frame com a resolução e os canais da sequência
+	bool write(const IVC *frame);
+	// Escrever o índice e o cabeçalho final. Sem close() o ficheiro fica sem frames.
+	bool close();
+
+	bool is_open() const { return file != nullptr; }
+	int count() const { return (int)index.size(); }
+
+private:
+	FILE *file = nullptr;
+	VCFramesHeader header = {};
+	std::vector<VCFramesEntry> index;
+	std::vector<unsigned char> packed;
+	std::vector<unsigned char> compressed;
+	uint64_t position = 0;
+	bool failed = false;
+};
+
+// Leitura com acesso aleatório sobre o ficheiro mapeado em memória
+class VCFrameReader
+{
+public:
+	VCFrameReader() = default;
+	~VCFrameReader() { close(); }
+
+	VCFrameReader(const VCFrameReader &) = delete;
+	VCFrameReader &operator=(const VCFrameReader &) = delete;
+
+	// Falha (sem mensagem) se o ficheiro não for uma sequência de frames
+	bool open(const char *filename);
+	void close();
+
+	// Frame i (0 <= i < count()) numa IVC. Frames sem compressão apontam para o ficheiro mapeado
+	// (sem cópia, só de leitura, válidas até close()); as comprimidas são descomprimidas para um
+	// buffer do leitor, válido até à próxima chamada.
+	bool frame(int i, IVC *image);
+
+	bool is_open() const { return data != nullptr; }
+	int width() const { return (int)header.width; }
+	int height() const { return (int)header.height; }
+	int channels() const { return (int)header.channels; }
+	int count() const { return (int)header.count; }
+	double fps() const { return header.fps1000 / 1000.0; }
+	// Alguma frame está comprimida (frame() copia)
+	bool compressed() const { return header.compression != VC_FRAMES_RAW; }
+
+private:
+	unsigned char *data = nullptr;
+	size_t size = 0;
+	VCFramesHeader header = {};
+	const VCFramesEntry *index = nullptr;
+	std::vector<unsigned char> unpacked;
+};
@@ -0,0 +1,203 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//        TESTE DAS SEQUÊNCIAS DE FRAMES EM BRUTO
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   vc_frames_test    teste automático (ctest): escreve sequências num ficheiro temporário, lê-as
+//                     de volta e verifica que os ficheiros truncados, com o índice corrompido ou
+//                     sem frames são recusados por VCFrameReader::open()
+
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "vc_frames.hpp"
+#include "vc_test.h"
+
+#define WIDTH 37
+#define HEIGHT 11
+#define CHANNELS 3
+#define NFRAMES 4
+
+static std::string temp_path(const char *name)
+{
+	return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// Pixel (x, y, c) da frame n: diferente em cada frame, canal e posição
+static unsigned char pixel(int n, int x, int y, int c)
+{
+	return (unsigned char)(n * 31 + x * 7 + y * 13 + c * 101);
+}
+
+// Frame n com 5 bytes de espaço no fim de cada linha (só width * channels são pixeis)
+static void fill(int n, std::vector<unsigned char> &buffer, IVC *image)
+{
+	const int stride = WIDTH * CHANNELS + 5;
+
+	buffer.assign((size_t)stride * HEIGHT, 0xEE);
+	for (int y = 0; y < HEIGHT; y++)
+		for (int x = 0; x < WIDTH; x++)
+			for (int c = 0; c < CHANNELS; c++)
+				buffer[(size_t)y * stride + x * CHANNELS + c] = pixel(n, x, y, c);
+	*image = {buffer.data(), WIDTH, HEIGHT, CHANNELS, 255, stride};
+}
+
+static bool write_sequence(const std::string &path, int compression, int nframes)
+{
+	VCFrameWriter writer;
+	std::vector<unsigned char> buffer;
+	IVC image;
+
+	CHECK(writer.open(path.c_str(), WIDTH, HEIGHT, CHANNELS, 29.97, compression), "open de " << path);
+	for (int n = 0; n < nframes; n++)
+	{
+		fill(n, buffer, &image);
+		CHECK(writer.write(&image), "escrita da frame " << n);
+	}
+	CHECK(writer.count() == nframes, "count() = " << writer.count());
+	CHECK(writer.close(), "close de " << path);
+	return true;
+}
+
+// As linhas com espaço entre elas ficam juntas no ficheiro e voltam iguais
+static bool test_roundtrip(int compression, const char *name)
+{
+	std::string path = temp_path("vc_frames_test.vcf");
+	if (!write_sequence(path, compression, NFRAMES))
+		return false;
+
+	VCFrameReader reader;
+	CHECK(reader.open(path.c_str()), name << ": a sequência escrita não abre");
+	CHECK((reader.width() == WIDTH) && (reader.height() == HEIGHT) && (reader.channels() == CHANNELS) && (reader.count() == NFRAMES),
+		  name << ": cabeçalho " << reader.width() << "x" << reader.height() << "x" << reader.channels() << ", " << reader.count() << " frames");
+	CHECK((reader.fps() > 29.96) && (reader.fps() < 29.98), name << ": fps " << reader.fps());
+
+	// Por ordem inversa: o acesso é aleatório
+	for (int n = NFRAMES - 1; n >= 0; n--)
+	{
+		IVC image;
+		CHECK(reader.frame(n, &image), name << ": frame " << n);
+		CHECK(image.bytesperline == WIDTH * CHANNELS, name << ": bytesperline " << image.bytesperline);
+		for (int y = 0; y < HEIGHT; y++)
+			for (int x = 0; x < WIDTH; x++)
+				for (int c = 0; c < CHANNELS; c++)
+					CHECK(image.data[y * image.bytesperline + x * CHANNELS + c] == pixel(n, x, y, c),
+						  name << ": frame " << n << " pixel (" << x << ", " << y << ", " << c << ")");
+	}
+
+	IVC image;
+	CHECK(!reader.frame(-1, &image) && !reader.frame(NFRAMES, &image), name << ": frame fora da sequência aceite");
+
+	reader.close();
+	std::remove(path.c_str());
+	printf("roundtrip %s: %d frames iguais\n", name, NFRAMES);
+	return true;
+}
+
+// Uma sequência sem frames, ou um ficheiro em que close() nunca foi chamado, não abre
+static bool test_empty(void)
+{
+	std::string path = temp_path("vc_frames_test_empty.vcf");
+	VCFrameReader reader;
+
+	if (!write_sequence(path, VC_FRAMES_RAW, 0))
+		return false;
+	CHECK(!reader.open(path.c_str()), "sequência com 0 frames aceite");
+
+	// Interrompida: o cabeçalho provisório tem count = 0
+	{
+		VCFrameWriter writer;
+		std::vector<unsigned char> buffer;
+		IVC image;
+		CHECK(writer.open(path.c_str(), WIDTH, HEIGHT, CHANNELS, 30.0), "open de " << path);
+		fill(0, buffer, &image);
+		CHECK(writer.write(&image), "escrita da frame 0");
+		fflush(NULL);
+		CHECK(!reader.open(path.c_str()), "sequência sem close() aceite");
+	}
+
+	std::remove(path.c_str());
+	printf("empty: recusadas\n");
+	return true;
+}
+
+// Uma cópia do ficheiro válido alterada por change não pode abrir
+static bool rejected(const std::string &valid, const char *what, void (*change)(const std::string &path, const VCFramesHeader &header))
+{
+	std::string path = temp_path("vc_frames_test_bad.vcf");
+	std::filesystem::copy_file(valid, path, std::filesystem::copy_options::overwrite_existing);
+
+	VCFramesHeader header;
+	FILE *file = fopen(path.c_str(), "rb");
+	CHECK((file != NULL) && (fread(&header, sizeof(header), 1, file) == 1), "leitura do cabeçalho");
+	fclose(file);
+
+	change(path, header);
+	VCFrameReader reader;
+	bool opened = reader.open(path.c_str());
+	reader.close();
+	std::remove(path.c_str());
+	CHECK(!opened, what << ": aceite");
+	return true;
+}
+
+static void patch(const std::string &path, uint64_t position, const void *data, size_t size)
+{
+	FILE *file = fopen(path.c_str(), "r+b");
+	fseek(file, (long int)position, SEEK_SET);
+	fwrite(data, 1, size, file);
+	fclose(file);
+}
+
+static bool test_corrupt(void)
+{
+	std::string valid = temp_path("vc_frames_test_valid.vcf");
+	if (!write_sequence(valid, VC_FRAMES_RAW, NFRAMES))
+		return false;
+
+	bool ok = true;
+	// Truncado: sem o fim do índice, sem o índice, a meio das frames e só com parte do cabeçalho
+	ok = rejected(valid, "índice truncado", [](const std::string &path, const VCFramesHeader &)
+				  { std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1); }) && ok;
+	ok = rejected(valid, "sem índice", [](const std::string &path, const VCFramesHeader &h)
+				  { std::filesystem::resize_file(path, h.index); }) && ok;
+	ok = rejected(valid, "frames truncadas", [](const std::string &path, const VCFramesHeader &h)
+				  { std::filesystem::resize_file(path, h.index / 2); }) && ok;
+	ok = rejected(valid, "cabeçalho truncado", [](const std::string &path, const VCFramesHeader &)
+				  { std::filesystem::resize_file(path, sizeof(VCFramesHeader) - 1); }) && ok;
+	// Cabeçalho inválido
+	ok = rejected(valid, "assinatura errada", [](const std::string &path, const VCFramesHeader &)
+				  { patch(path, 0, "VCFRAMEZ", 8); }) && ok;
+	ok = rejected(valid, "versão desconhecida", [](const std::string &path, const VCFramesHeader &)
+				  { uint32_t v = 99; patch(path, offsetof(VCFramesHeader, version), &v, sizeof(v)); }) && ok;
+	ok = rejected(valid, "índice desalinhado", [](const std::string &path, const VCFramesHeader &h)
+				  { uint64_t i = h.index + 1; patch(path, offsetof(VCFramesHeader, index), &i, sizeof(i)); }) && ok;
+	ok = rejected(valid, "mais frames que o índice", [](const std::string &path, const VCFramesHeader &h)
+				  { uint32_t n = h.count + 1; patch(path, offsetof(VCFramesHeader, count), &n, sizeof(n)); }) && ok;
+	// Entradas do índice fora das frames ou menores que uma frame sem compressão
+	ok = rejected(valid, "frame depois do índice", [](const std::string &path, const VCFramesHeader &h)
+				  { VCFramesEntry e = {h.index + 64, WIDTH * HEIGHT * CHANNELS}; patch(path, h.index + sizeof(e), &e, sizeof(e)); }) && ok;
+	ok = rejected(valid, "frame a passar o índice", [](const std::string &path, const VCFramesHeader &h)
+				  { VCFramesEntry e = {h.index - 16, WIDTH * HEIGHT * CHANNELS}; patch(path, h.index + 2 * sizeof(e), &e, sizeof(e)); }) && ok;
+	ok = rejected(valid, "frame maior que a resolução", [](const std::string &path, const VCFramesHeader &h)
+				  { VCFramesEntry e = {64, WIDTH * HEIGHT * CHANNELS + 1}; patch(path, h.index, &e, sizeof(e)); }) && ok;
+	ok = rejected(valid, "frame curta sem compressão", [](const std::string &path, const VCFramesHeader &h)
+				  { VCFramesEntry e = {64, 10}; patch(path, h.index, &e, sizeof(e)); }) && ok;
+
+	std::remove(valid.c_str());
+	if (ok)
+		printf("corrupt: 12 ficheiros inválidos recusados\n");
+	return ok;
+}
+
+int main(void)
+{
+	return vc_test_run({[]()
+						{ return test_roundtrip(VC_FRAMES_RAW, "raw"); },
+						[]()
+						{ return test_roundtrip(VC_FRAMES_LZ4, "lz4"); },
+						test_empty, test_corrupt});
+}
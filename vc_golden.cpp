@@ -0,0 +1,540 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//          RESULTADOS DE REFERÊNCIA (GOLDEN) E REGRESSÃO
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+// Guarda num ficheiro de texto:
+//  - o hash (FNV-1a de 64 bits) da saída de cada função de vc.h sobre imagens sintéticas;
+//  - os blobs (caixa, centro de gravidade, área) e as resistências descodificadas em cada frame do vídeo.
+// Qualquer otimização tem de reproduzir este ficheiro exatamente.
+//
+//   vc_golden record golden.txt video_resistors.mp4   (com a implementação de referência)
+//   vc_golden check  golden.txt video_resistors.mp4   (termina com 1 se algo mudar)
+//
+// Os hashes das funções não dependem de nada externo; os blobs dependem do descodificador de vídeo
+// do OpenCV, por isso o ficheiro deve ser gravado na mesma plataforma onde é verificado.
+
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <opencv2/videoio.hpp>
+
+extern "C"
+{
+#include "vc.h"
+}
+
+#include "vc_pipeline.hpp"
+#include "vc_pool.hpp"
+
+// Resoluções das imagens sintéticas (uma par e uma ímpar, para apanhar os limites dos kernels)
+static const int sizes[][2] = {{320, 240}, {333, 197}};
+static const int kernels[] = {3, 5, 7};
+
+static unsigned long long fnv1a(const unsigned char *data, size_t n, unsigned long long hash = 14695981039346656037ULL)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		hash ^= data[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static unsigned long long hash_image(const IVC *image, unsigned long long hash = 14695981039346656037ULL)
+{
+	return fnv1a(image->data, (size_t)image->bytesperline * image->height, hash);
+}
+
+// Imagem RGB sintética: gradiente com ruído (sempre a mesma semente)
+static IVC *golden_rgb(int width, int height)
+{
+	IVC *image = vc_image_new(width, height, 3, 255);
+	unsigned int seed = 12345;
+
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			long int pos = (long int)y * image->bytesperline + x * 3;
+			seed = seed * 1103515245 + 12345;
+			int noise = (int)((seed >> 16) & 63) - 32;
+			image->data[pos] = (unsigned char)MIN_VC(MAX_VC(x * 255 / width + noise, 0), 255);
+			image->data[pos + 1] = (unsigned char)MIN_VC(MAX_VC(y * 255 / height + noise, 0), 255);
+			image->data[pos + 2] = (unsigned char)MIN_VC(MAX_VC((x + y) * 255 / (width + height) - noise, 0), 255);
+		}
+	}
+
+	return image;
+}
+
+// Resultado de um detetor de arestas: o número de pixeis marcados (ou 0 se falhou), para que uma
+// saída vazia fique à vista no ficheiro em vez de ter só o hash de uma imagem a zeros
+static int golden_edges(int ret, const IVC *image)
+{
+	int n = 0;
+	for (int y = 0; ret && (y < image->height); y++)
+		for (int x = 0; x < image->width; x++)
+			n += (image->data[(long int)y * image->bytesperline + x] != 0);
+	return n;
+}
+
+// Máscara binária com vários objetos (discos e retângulos), separados e a tocar-se
+static IVC *golden_mask(int width, int height)
+{
+	IVC *image = vc_image_new(width, height, 1, 255);
+	memset(image->data, 0, (size_t)image->bytesperline * height);
+
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			int dx1 = x - width / 4, dy1 = y - height / 3;
+			int dx2 = x - width / 2, dy2 = y - height / 3;
+			bool inside = (dx1 * dx1 + dy1 * dy1 < 900) || (dx2 * dx2 + dy2 * dy2 < 400) ||
+						  ((x > width / 8) && (x < width * 7 / 8) && (y > height * 2 / 3) && (y < height * 2 / 3 + 25)) ||
+						  ((x % 50 < 6) && (y % 40 < 4));
+			if (inside)
+				image->data[(long int)y * image->bytesperline + x] = 255;
+		}
+	}
+
+	return image;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//                   HASHES DAS FUNÇÕES DE vc.h
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// Imagens de entrada de uma resolução
+struct VCGoldenInputs
+{
+	IVC *rgb, *gray, *hsv, *mask;
+	IVC *objects; // Cinzentos com os objetos da máscara 60 níveis mais claros: arestas acima do ruído
+};
+
+// Função a verificar: lê uma das entradas e escreve em dst (dst é limpo antes de cada chamada,
+// para que os pixeis que a função não escreve tenham sempre o mesmo valor)
+struct VCGoldenKernel
+{
+	const char *name;
+	char input; // 'c' RGB, 'g' cinzentos, 'h' HSV, 'm' máscara binária, 'e' cinzentos com objetos
+	int dstchannels;
+	bool kernel; // Repetir para cada tamanho de kernel
+	std::function<int(IVC *, IVC *, int)> fn;
+};
+
+static std::vector<VCGoldenKernel> golden_kernels(void)
+{
+	return {
+		{"vc_bgr_to_rgb", 'c', 3, false, [](IVC *s, IVC *d, int)
+		 { return vc_bgr_to_rgb(s, d); }},
+		{"vc_rgb_to_gray", 'c', 1, false, [](IVC *s, IVC *d, int)
+		 { return vc_rgb_to_gray(s, d); }},
+		{"vc_rgb_to_hsv", 'c', 3, false, [](IVC *s, IVC *d, int)
+		 { return vc_rgb_to_hsv(s, d); }},
+		{"vc_hsv_to_rgb", 'h', 3, false, [](IVC *s, IVC *d, int)
+		 { return vc_hsv_to_rgb(s, d); }},
+		{"vc_hsv_segmentation", 'h', 1, false, [](IVC *s, IVC *d, int)
+		 { return vc_hsv_segmentation(s, d, 20, 50, 37, 100, 10, 100); }},
+		{"vc_gray_to_rgb", 'g', 3, false, [](IVC *s, IVC *d, int)
+		 { return vc_gray_to_rgb(s, d); }},
+		{"vc_binary_to_3_channels", 'm', 3, false, [](IVC *s, IVC *d, int)
+		 { return vc_binary_to_3_channels(s, d); }},
+		{"vc_rgb_get_red_gray", 'c', 3, false, [](IVC *s, IVC *d, int)
+		 { memcpy(d->data, s->data, (size_t)s->bytesperline * s->height); return vc_rgb_get_red_gray(d); }},
+		{"vc_rgb_get_green_gray", 'c', 3, false, [](IVC *s, IVC *d, int)
+		 { memcpy(d->data, s->data, (size_t)s->bytesperline * s->height); return vc_rgb_get_green_gray(d); }},
+		{"vc_rgb_get_blue_gray", 'c', 3, false, [](IVC *s, IVC *d, int)
+		 { memcpy(d->data, s->data, (size_t)s->bytesperline * s->height); return vc_rgb_get_blue_gray(d); }},
+		{"vc_rgb_negative", 'c', 3, false, [](IVC *s, IVC *d, int)
+		 { memcpy(d->data, s->data, (size_t)s->bytesperline * s->height); return vc_rgb_negative(d); }},
+		{"vc_gray_negative", 'g', 1, false, [](IVC *s, IVC *d, int)
+		 { memcpy(d->data, s->data, (size_t)s->bytesperline * s->height); return vc_gray_negative(d); }},
+		{"vc_gray_lowpass_min_filter", 'g', 1, true, [](IVC *s, IVC *d, int k)
+		 { return vc_gray_lowpass_min_filter(s, d, k); }},
+		{"vc_gray_lowpass_median_filter", 'g', 1, true, [](IVC *s, IVC *d, int k)
+		 { return vc_gray_lowpass_median_filter(s, d, k); }},
+		{"vc_gray_gaussian_filter", 'g', 1, false, [](IVC *s, IVC *d, int)
+		 { return vc_gray_gaussian_filter(s, d); }},
+		{"vc_gray_edge_prewitt", 'g', 1, false, [](IVC *s, IVC *d, int)
+		 { return golden_edges(vc_gray_edge_prewitt(s, d, 0.8f), d); }},
+		{"vc_gray_edge_sobel", 'g', 1, false, [](IVC *s, IVC *d, int)
+		 { return golden_edges(vc_gray_edge_sobel(s, d, 0.8f), d); }},
+		{"vc_gray_edge_scharr", 'g', 1, false, [](IVC *s, IVC *d, int)
+		 { return golden_edges(vc_gray_edge_scharr(s, d, 0.8f), d); }},
+		{"vc_gray_edge_prewitt_objects", 'e', 1, false, [](IVC *s, IVC *d, int)
+		 { return golden_edges(vc_gray_edge_prewitt(s, d, 0.95f), d); }},
+		{"vc_gray_edge_sobel_objects", 'e', 1, false, [](IVC *s, IVC *d, int)
+		 { return golden_edges(vc_gray_edge_sobel(s, d, 0.95f), d); }},
+		{"vc_gray_edge_scharr_objects", 'e', 1, false, [](IVC *s, IVC *d, int)
+		 { return golden_edges(vc_gray_edge_scharr(s, d, 0.95f), d); }},
+		{"vc_gray_edge_sobel_l1", 'g', 1, false, [](IVC *s, IVC *d, int)
+		 { return golden_edges(vc_gray_edge(s, d, VC_EDGE_SOBEL, VC_EDGE_L1, 0.8f), d); }},
+		{"vc_gray_edge_prewitt_linf", 'g', 1, false, [](IVC *s, IVC *d, int)
+		 { return golden_edges(vc_gray_edge(s, d, VC_EDGE_PREWITT, VC_EDGE_LINF, 0.8f), d); }},
+		{"vc_gray_edge_canny", 'g', 1, false, [](IVC *s, IVC *d, int)
+		 { return golden_edges(vc_gray_edge_canny(s, d, 40, 100), d); }},
+		{"vc_gray_edge_canny_objects", 'e', 1, false, [](IVC *s, IVC *d, int)
+		 { return golden_edges(vc_gray_edge_canny(s, d, 40, 100), d); }},
+		{"vc_gray_edge_canny_mask", 'm', 1, false, [](IVC *s, IVC *d, int)
+		 { return golden_edges(vc_gray_edge_canny(s, d, 40, 100), d); }},
+		{"vc_gray_laplacian_filter_4", 'g', 1, false, [](IVC *s, IVC *d, int)
+		 { return vc_gray_laplacian_filter(s, d, VC_LAPLACIAN_4); }},
+		{"vc_gray_laplacian_filter_8", 'g', 1, false, [](IVC *s, IVC *d, int)
+		 { return vc_gray_laplacian_filter(s, d, VC_LAPLACIAN_8); }},
+		{"vc_gray_laplacian_filter_diagonal", 'g', 1, false, [](IVC *s, IVC *d, int)
+		 { return vc_gray_laplacian_filter(s, d, VC_LAPLACIAN_DIAGONAL); }},
+		{"vc_gray_equalize_image", 'g', 1, false, [](IVC *s, IVC *d, int)
+		 { return vc_gray_equalize_image(s, d); }},
+		{"vc_color_equalize_image", 'h', 3, false, [](IVC *s, IVC *d, int)
+		 { return vc_color_equalize_image(s, d); }},
+		{"vc_gray_to_binary", 'g', 1, false, [](IVC *s, IVC *d, int)
+		 { return vc_gray_to_binary(s, d, 128); }},
+		{"vc_gray_to_binary_global_mean", 'g', 1, false, [](IVC *s, IVC *d, int)
+		 { return vc_gray_to_binary_global_mean(s, d); }},
+		{"vc_gray_to_binary_niblack", 'g', 1, true, [](IVC *s, IVC *d, int k)
+		 { return vc_gray_to_binary_niblack(s, d, k, -0.2f); }},
+		{"vc_gray_to_binary_bernsen", 'g', 1, true, [](IVC *s, IVC *d, int k)
+		 { return vc_gray_to_binary_bernsen(s, d, k, 15); }},
+		{"vc_gray_to_binary_midpoint", 'g', 1, true, [](IVC *s, IVC *d, int k)
+		 { return vc_gray_to_binary_midpoint(s, d, k); }},
+		{"vc_grayscale_erode", 'g', 1, true, [](IVC *s, IVC *d, int k)
+		 { return vc_grayscale_erode(s, d, k); }},
+		{"vc_grayscale_dilate", 'g', 1, true, [](IVC *s, IVC *d, int k)
+		 { return vc_grayscale_dilate(s, d, k); }},
+		{"vc_grayscale_open", 'g', 1, true, [](IVC *s, IVC *d, int k)
+		 { return vc_grayscale_open(s, d, k); }},
+		{"vc_grayscale_close", 'g', 1, true, [](IVC *s, IVC *d, int k)
+		 { return vc_grayscale_close(s, d, k); }},
+		{"vc_binary_erode", 'm', 1, true, [](IVC *s, IVC *d, int k)
+		 { return vc_binary_erode(s, d, k); }},
+		{"vc_binary_dilate", 'm', 1, true, [](IVC *s, IVC *d, int k)
+		 { return vc_binary_dilate(s, d, k); }},
+		{"vc_binary_open", 'm', 1, true, [](IVC *s, IVC *d, int k)
+		 { return vc_binary_open(s, d, k, k); }},
+		{"vc_binary_close", 'm', 1, true, [](IVC *s, IVC *d, int k)
+		 { return vc_binary_close(s, d, k, k); }},
+		{"vc_binary_area", 'm', 1, false, [](IVC *s, IVC *, int)
+		 { return vc_binary_area(s); }},
+		{"vc_segmentation_area", 'm', 1, false, [](IVC *s, IVC *, int)
+		 { return vc_segmentation_area(s); }},
+	};
+}
+
+// Hash das etiquetas e de todos os campos dos blobs (etiquetagem, informação e coloração)
+static unsigned long long golden_blobs(IVC *mask, int *nblobs)
+{
+	IVC *labels = vc_image_new(mask->width, mask->height, 1, 255);
+	IVC *colored = vc_image_new(mask->width, mask->height, 1, 255);
+	memset(colored->data, 0, (size_t)colored->bytesperline * colored->height);
+
+	OVC *blobs = vc_binary_blob_labelling(mask, labels, nblobs);
+	unsigned long long hash = hash_image(labels);
+	if (blobs != NULL)
+	{
+		vc_binary_blob_info(labels, blobs, *nblobs);
+		vc_blob_gray_coloring(labels, colored, blobs, *nblobs);
+		for (int i = 0; i < *nblobs; i++)
+		{
+			int fields[] = {blobs[i].x, blobs[i].y, blobs[i].width, blobs[i].height, blobs[i].area, blobs[i].xc, blobs[i].yc, blobs[i].perimeter, blobs[i].label};
+			hash = fnv1a((const unsigned char *)fields, sizeof(fields), hash);
+		}
+		hash = hash_image(colored, hash);
+		free(blobs);
+	}
+
+	vc_image_free(labels);
+	vc_image_free(colored);
+	return hash;
+}
+
+// Empacotamento de uma imagem de 1 bit e volta, pelas funções de vc.h e por um ficheiro P4.
+// Compara com a definição bit a bit (primeiro pixel no bit mais significativo, pixel 0 = bit 1),
+// sem depender dos caminhos SSE2/palavras de 64 bits de vc.c. Devolve 1 se tudo coincidir.
+static int golden_p4_roundtrip(int width, int height, unsigned long long *hash)
+{
+	IVC *src = vc_image_new(width, height, 1, 255);
+	IVC *back = vc_image_new(width, height, 1, 255);
+	BVC *bits = vc_bitimage_new(width, height);
+	std::vector<unsigned char> expected((size_t)bits->bytesperline * height, 0);
+	unsigned int seed = 4321;
+	int ok = 1;
+
+	// Pixeis 0 e valores diferentes de 0 (não só 255), em linhas que começam em qualquer byte
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			seed = seed * 1103515245 + 12345;
+			unsigned char p = ((seed >> 16) & 1) ? 0 : (unsigned char)(1 + ((seed >> 17) % 255));
+			src->data[(long int)y * src->bytesperline + x] = p;
+			if (p == 0)
+				expected[(size_t)y * bits->bytesperline + x / 8] |= (unsigned char)(0x80 >> (x % 8));
+		}
+	}
+
+	ok &= vc_binary_pack(src, bits);
+	ok &= (memcmp(bits->data, expected.data(), expected.size()) == 0);
+	*hash = fnv1a(bits->data, expected.size());
+
+	// Ficheiro P4 (cópia direta dos bits) e a mesma imagem lida como IVC (pixeis 0/1)
+	std::string path = (std::filesystem::temp_directory_path() / "vc_golden_p4.pbm").string();
+	ok &= vc_write_pbm((char *)path.c_str(), bits);
+	BVC *read = vc_read_pbm((char *)path.c_str());
+	ok &= (read != NULL) && (read->width == width) && (read->height == height) && (memcmp(read->data, expected.data(), expected.size()) == 0);
+	IVC *image = vc_read_image((char *)path.c_str());
+	ok &= (image != NULL) && (image->levels == 1);
+	for (int y = 0; ok && (y < height); y++)
+		for (int x = 0; x < width; x++)
+			ok &= (image->data[(long int)y * image->bytesperline + x] == (src->data[(long int)y * src->bytesperline + x] ? 1 : 0));
+
+	// E de volta a 1 byte por pixel: 0 ou white
+	ok &= vc_binary_unpack(bits, back, 255);
+	for (int y = 0; ok && (y < height); y++)
+		for (int x = 0; x < width; x++)
+			ok &= (back->data[(long int)y * back->bytesperline + x] == (src->data[(long int)y * src->bytesperline + x] ? 255 : 0));
+
+	std::remove(path.c_str());
+	vc_image_free(image);
+	vc_bitimage_free(read);
+	vc_bitimage_free(bits);
+	vc_image_free(back);
+	vc_image_free(src);
+	return ok;
+}
+
+static void golden_record_kernels(std::vector<std::string> &lines)
+{
+	char line[256];
+	std::vector<VCGoldenKernel> list = golden_kernels();
+
+	for (const auto &size : sizes)
+	{
+		int width = size[0], height = size[1];
+		VCGoldenInputs in;
+		in.rgb = golden_rgb(width, height);
+		in.gray = vc_image_new(width, height, 1, 255);
+		vc_rgb_to_gray(in.rgb, in.gray);
+		in.hsv = vc_image_new(width, height, 3, 255);
+		vc_rgb_to_hsv(in.rgb, in.hsv);
+		in.mask = golden_mask(width, height);
+		in.objects = vc_image_new(width, height, 1, 255);
+		for (long int i = 0; i < (long int)in.gray->bytesperline * height; i++)
+			in.objects->data[i] = (unsigned char)MIN_VC(in.gray->data[i] + (in.mask->data[i] ? 60 : 0), 255);
+
+		for (const VCGoldenKernel &k : list)
+		{
+			IVC *src = (k.input == 'c') ? in.rgb : (k.input == 'g') ? in.gray
+											   : (k.input == 'h')	? in.hsv
+											   : (k.input == 'e')	? in.objects
+																	: in.mask;
+			int nkernels = k.kernel ? (int)(sizeof(kernels) / sizeof(kernels[0])) : 1;
+
+			for (int i = 0; i < nkernels; i++)
+			{
+				IVC *dst = vc_image_new(width, height, k.dstchannels, 255);
+				memset(dst->data, 0, (size_t)dst->bytesperline * height);
+
+				int ret = k.fn(src, dst, kernels[i]);
+				snprintf(line, sizeof(line), "kernel %s %dx%d k%d ret %d hash %016llx", k.name, width, height,
+						 k.kernel ? kernels[i] : 0, ret, hash_image(dst));
+				lines.push_back(line);
+
+				vc_image_free(dst);
+			}
+		}
+
+		// Blobs da máscara sintética
+		int nblobs = 0;
+		unsigned long long hash = golden_blobs(in.mask, &nblobs);
+		snprintf(line, sizeof(line), "kernel vc_binary_blob_labelling %dx%d k0 ret %d hash %016llx", width, height, nblobs, hash);
+		lines.push_back(line);
+
+		vc_image_free(in.rgb);
+		vc_image_free(in.gray);
+		vc_image_free(in.hsv);
+		vc_image_free(in.mask);
+		vc_image_free(in.objects);
+	}
+
+	// Descodificação das bandas: todas as combinações de 4 bandas
+	unsigned long long hash = 14695981039346656037ULL;
+	int ndecoded = 0;
+	for (int b = 0; b < VC_NCOLORS * VC_NCOLORS * VC_NCOLORS * VC_NCOLORS; b++)
+	{
+		int bands[4] = {b % VC_NCOLORS, (b / VC_NCOLORS) % VC_NCOLORS, (b / VC_NCOLORS / VC_NCOLORS) % VC_NCOLORS, b / VC_NCOLORS / VC_NCOLORS / VC_NCOLORS};
+		RVC res;
+		if (vc_resistor_decode(bands, 4, &res))
+		{
+			ndecoded++;
+			hash = fnv1a((const unsigned char *)&res.value, sizeof(res.value), hash);
+			hash = fnv1a((const unsigned char *)&res.tolerance, sizeof(res.tolerance), hash);
+			hash = fnv1a((const unsigned char *)&res.reversed, sizeof(res.reversed), hash);
+		}
+	}
+	snprintf(line, sizeof(line), "kernel vc_resistor_decode 4bands k0 ret %d hash %016llx", ndecoded, hash);
+	lines.push_back(line);
+
+	// Classificação de cores: todo o espaço HSV (em passos de 2)
+	vc_color_table_init();
+	hash = 14695981039346656037ULL;
+	for (int h = 0; h < 256; h += 2)
+	{
+		for (int s = 0; s < 256; s += 2)
+		{
+			for (int v = 0; v < 256; v += 2)
+			{
+				unsigned char c = (unsigned char)vc_color_classify((unsigned char)h, (unsigned char)s, (unsigned char)v);
+				hash = fnv1a(&c, 1, hash);
+			}
+		}
+	}
+	snprintf(line, sizeof(line), "kernel vc_color_classify hsv k0 ret 0 hash %016llx", hash);
+	lines.push_back(line);
+
+	// Imagens de 1 bit (P4): larguras à volta dos blocos de 8 e 16 pixeis do empacotamento
+	for (int width : {1, 7, 8, 15, 16, 17, 333})
+	{
+		int ok = golden_p4_roundtrip(width, 5, &hash);
+		snprintf(line, sizeof(line), "kernel vc_binary_pack %dx5 k0 ret %d hash %016llx", width, ok, hash);
+		lines.push_back(line);
+	}
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//                 DETEÇÕES EM CADA FRAME DO VÍDEO
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+static int golden_record_video(const char *filename, std::vector<std::string> &lines)
+{
+	cv::VideoCapture capture;
+	if (!capture.open(filename, cv::CAP_ANY))
+	{
+		std::cerr << "Erro ao abrir o ficheiro de vídeo " << filename << "!\n";
+		return 0;
+	}
+
+	int width = (int)capture.get(cv::CAP_PROP_FRAME_WIDTH);
+	int height = (int)capture.get(cv::CAP_PROP_FRAME_HEIGHT);
+	VCThreadPool pool;
+	VCPipeline pipeline(width, height, pool);
+
+	cv::Mat frame;
+	char line[256];
+	for (int nframe = 0; capture.read(frame) && !frame.empty(); nframe++)
+	{
+		IVC image = {frame.data, width, height, 3, 255, width * 3};
+		pipeline.process(&image);
+
+		for (const VCDetection &d : pipeline.detections())
+		{
+			const OVC &b = d.blob;
+			int n = snprintf(line, sizeof(line), "frame %d blob %d %d %d %d xc %d yc %d area %d", nframe, b.x, b.y, b.width, b.height, b.xc, b.yc, b.area);
+			if (d.decoded)
+			{
+				n += snprintf(line + n, sizeof(line) - n, " value %.10g tol %g bands", d.resistor.value, d.resistor.tolerance);
+				for (int i = 0; i < d.resistor.nbands; i++)
+					n += snprintf(line + n, sizeof(line) - n, " %d", d.resistor.bands[i]);
+			}
+			else
+			{
+				snprintf(line + n, sizeof(line) - n, " undecoded");
+			}
+			lines.push_back(line);
+		}
+	}
+
+	capture.release();
+	return 1;
+}
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//                    GRAVAÇÃO E VERIFICAÇÃO
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+static int golden_read(const char *filename, std::vector<std::string> &lines)
+{
+	FILE *file = fopen(filename, "r");
+	if (file == NULL)
+	{
+		std::cerr << "Erro ao abrir o ficheiro " << filename << "!\n";
+		return 0;
+	}
+
+	char line[512];
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		line[strcspn(line, "\r\n")] = '\0';
+		if ((line[0] != '\0') && (line[0] != '#'))
+			lines.push_back(line);
+	}
+
+	fclose(file);
+	return 1;
+}
+
+int main(int argc, char *argv[])
+{
+	if ((argc != 4) || ((strcmp(argv[1], "record") != 0) && (strcmp(argv[1], "check") != 0)))
+	{
+		std::cerr << "Uso: " << argv[0] << " record|check <golden.txt> <video>\n";
+		return 2;
+	}
+
+	std::vector<std::string> lines;
+	golden_record_kernels(lines);
+	if (!golden_record_video(argv[3], lines))
+		return 2;
+
+	if (strcmp(argv[1], "record") == 0)
+	{
+		FILE *file = fopen(argv[2], "w");
+		if (file == NULL)
+		{
+			std::cerr << "Erro ao criar o ficheiro " << argv[2] << "!\n";
+			return 2;
+		}
+		fprintf(file, "# Resultados de referência de vc.h e da deteção (gerado por vc_golden record)\n");
+		for (const std::string &l : lines)
+			fprintf(file, "%s\n", l.c_str());
+		fclose(file);
+
+		std::cout << lines.size() << " resultados gravados em " << argv[2] << "\n";
+		return 0;
+	}
+
+	std::vector<std::string> golden;
+	if (!golden_read(argv[2], golden))
+		return 2;
+
+	// Comparar linha a linha e mostrar as primeiras diferenças
+	int ndiff = 0;
+	size_t n = MAX_VC(lines.size(), golden.size());
+	for (size_t i = 0; i < n; i++)
+	{
+		const char *expected = (i < golden.size()) ? golden[i].c_str() : "(nada)";
+		const char *actual = (i < lines.size()) ? lines[i].c_str() : "(nada)";
+		if (strcmp(expected, actual) != 0)
+		{
+			if (ndiff < 20)
+				std::cout << "esperado: " << expected << "\n  obtido: " << actual << "\n";
+			ndiff++;
+		}
+	}
+
+	if (ndiff > 0)
+	{
+		std::cout << "FALHOU: " << ndiff << " de " << n << " resultados diferentes\n";
+		return 1;
+	}
+
+	std::cout << "OK: " << n << " resultados iguais\n";
+	return 0;
+}
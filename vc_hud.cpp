@@ -0,0 +1,104 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//              CAMADA DE INFORMAÇÃO NO ECRÃ (HUD)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+#include "vc_hud.hpp"
+
+// Tipo de letra do HUD e margem à volta do texto (o contorno tem espessura 2)
+#define VC_HUD_FONT cv::FONT_HERSHEY_SIMPLEX
+#define VC_HUD_SCALE 1.0
+#define VC_HUD_MARGIN 2
+
+VCHud::VCHud(int nlines, int x, int y, int spacing)
+	: x(x), y(y), spacing(spacing), lines(nlines)
+{
+}
+
+void VCHud::set_line(int line, const char *text)
+{
+	if ((line < 0) || (line >= (int)lines.size()) || (lines[line].text == text))
+		return;
+
+	lines[line].text = text;
+	lines[line].dirty = true;
+}
+
+void VCHud::draw_line(Line &line)
+{
+	int baseline = 0;
+	cv::Size size = cv::getTextSize(line.text, VC_HUD_FONT, VC_HUD_SCALE, 2, &baseline);
+
+	// Só se aloca uma imagem nova se o texto deixar de caber na anterior
+	int width = size.width + 2 * VC_HUD_MARGIN;
+	int height = size.height + baseline + 2 * VC_HUD_MARGIN;
+	if ((line.sprite.cols < width) || (line.sprite.rows < height))
+		line.sprite = cv::Mat(height, width, CV_8UC4);
+	line.sprite.setTo(cv::Scalar(0, 0, 0, 0));
+
+	line.ox = -VC_HUD_MARGIN;
+	line.oy = -(size.height + VC_HUD_MARGIN);
+
+	// Contorno preto e preenchimento branco, opacos
+	cv::Point origin(-line.ox, -line.oy);
+	cv::putText(line.sprite, line.text, origin, VC_HUD_FONT, VC_HUD_SCALE, cv::Scalar(0, 0, 0, 255), 2);
+	cv::putText(line.sprite, line.text, origin, VC_HUD_FONT, VC_HUD_SCALE, cv::Scalar(255, 255, 255, 255), 1);
+
+	line.dirty = false;
+}
+
+void VCHud::blend(const Line &line, int x, int y, IVC *dst)
+{
+	// Posição da imagem da linha na frame, recortada pelos limites da imagem
+	int left = x + line.ox;
+	int top = y + line.oy;
+	int x0 = std::max(left, 0);
+	int y0 = std::max(top, 0);
+	int x1 = std::min(left + line.sprite.cols, dst->width);
+	int y1 = std::min(top + line.sprite.rows, dst->height);
+
+	for (int yy = y0; yy < y1; yy++)
+	{
+		const unsigned char *s = line.sprite.ptr<unsigned char>(yy - top) + (x0 - left) * 4;
+		unsigned char *d = dst->data + yy * dst->bytesperline + x0 * 3;
+
+		for (int xx = x0; xx < x1; xx++, s += 4, d += 3)
+		{
+			int alpha = s[3];
+
+			if (alpha == 0)
+				continue;
+
+			if (alpha == 255)
+			{
+				d[0] = s[0];
+				d[1] = s[1];
+				d[2] = s[2];
+			}
+			else
+			{
+				d[0] = (unsigned char)((s[0] * alpha + d[0] * (255 - alpha)) / 255);
+				d[1] = (unsigned char)((s[1] * alpha + d[1] * (255 - alpha)) / 255);
+				d[2] = (unsigned char)((s[2] * alpha + d[2] * (255 - alpha)) / 255);
+			}
+		}
+	}
+}
+
+void VCHud::render(IVC *dst)
+{
+	if ((dst == NULL) || (dst->data == NULL) || (dst->channels != 3))
+		return;
+
+	for (int i = 0; i < (int)lines.size(); i++)
+	{
+		if (lines[i].text.empty())
+			continue;
+		if (lines[i].dirty)
+			draw_line(lines[i]);
+
+		blend(lines[i], x, y + i * spacing, dst);
+	}
+}
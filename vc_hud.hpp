@@ -0,0 +1,45 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//              CAMADA DE INFORMAÇÃO NO ECRÃ (HUD)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+extern "C"
+{
+#include "vc.h"
+}
+
+// Linhas de texto fixas no canto da imagem, pré-desenhadas em imagens BGRA (uma por linha).
+// Uma linha só é desenhada de novo quando o seu texto muda; em cada frame as imagens BGRA
+// são apenas misturadas (alpha blending) com a frame.
+class VCHud
+{
+public:
+	// (x, y) é a origem da primeira linha, como em cv::putText; as linhas seguintes ficam spacing pixeis abaixo
+	VCHud(int nlines, int x, int y, int spacing);
+
+	// Alterar o texto de uma linha (não faz nada se o texto for igual)
+	void set_line(int line, const char *text);
+
+	// Misturar o HUD com uma imagem BGR
+	void render(IVC *dst);
+
+private:
+	struct Line
+	{
+		std::string text;
+		cv::Mat sprite; // BGRA
+		int ox, oy;		// Deslocamento do canto superior esquerdo em relação à origem do texto
+		bool dirty = true;
+	};
+
+	void draw_line(Line &line);
+	void blend(const Line &line, int x, int y, IVC *dst);
+
+	int x, y, spacing;
+	std::vector<Line> lines;
+};
@@ -0,0 +1,63 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//            VISTA TIPADA SOBRE OS DADOS DE UMA IMAGEM
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <cstddef>
+
+extern "C"
+{
+#include "vc.h"
+}
+
+// Vista (sem cópia) sobre uma imagem com o tipo do pixel e o número de canais fixos em compilação.
+// Os kernels acedem às linhas por ponteiro (row(y)[x * Channels + c]), sem recalcular
+// y * bytesperline + x * channels em cada pixel, e o compilador conhece o número de canais.
+template <typename T, int Channels>
+class VCImageView
+{
+public:
+	typedef T value_type;
+	static const int channels = Channels;
+
+	VCImageView() : pixels(nullptr), w(0), h(0), s(0) {}
+	// stride: elementos (não bytes) entre o início de duas linhas
+	VCImageView(T *data, int width, int height, ptrdiff_t stride) : pixels(data), w(width), h(height), s(stride) {}
+	VCImageView(T *data, int width, int height) : VCImageView(data, width, height, (ptrdiff_t)width * Channels) {}
+
+	// Vista sobre uma IVC; fica inválida se a IVC não tiver Channels canais ou não tiver dados
+	static VCImageView from(const IVC *image)
+	{
+		if ((image == nullptr) || (image->data == nullptr) || (image->width <= 0) || (image->height <= 0) ||
+			(image->channels != Channels) || (image->bytesperline % (int)sizeof(T) != 0))
+			return VCImageView();
+		return VCImageView((T *)image->data, image->width, image->height, image->bytesperline / (ptrdiff_t)sizeof(T));
+	}
+
+	bool valid() const { return pixels != nullptr; }
+	int width() const { return w; }
+	int height() const { return h; }
+	ptrdiff_t stride() const { return s; }
+	T *data() const { return pixels; }
+
+	T *row(int y) const { return pixels + y * s; }
+	T *pixel(int x, int y) const { return pixels + y * s + (ptrdiff_t)x * Channels; }
+
+	// Região retangular (ROI) dentro da vista, sem cópia; a região tem de estar dentro da vista
+	VCImageView sub(int x, int y, int width, int height) const { return VCImageView(pixel(x, y), width, height, s); }
+
+	// Mesma resolução (para kernels com entrada e saída)
+	template <typename U, int C>
+	bool same_size(const VCImageView<U, C> &other) const { return (w == other.width()) && (h == other.height()); }
+
+private:
+	T *pixels;
+	int w, h;
+	ptrdiff_t s;
+};
+
+typedef VCImageView<unsigned char, 1> VCGray8;
+typedef VCImageView<unsigned char, 3> VCBGR8;
+typedef VCImageView<unsigned char, 3> VCRGB8;
+typedef VCImageView<unsigned char, 3> VCHSV8;
@@ -0,0 +1,338 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//        FUNÇÕES DE vc.h IMPLEMENTADAS COM vc_kernels.hpp
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "vc_convolve.hpp"
+#include "vc_kernels.hpp"
+
+// Invólucros com a interface C de vc.h: mantêm as verificações de erro e mensagens originais
+// e delegam nos kernels em template. As vistas usam width * channels como passo, como vc.c.
+
+static VCGray8 gray_view(const IVC *image)
+{
+	return VCGray8((unsigned char *)image->data, image->width, image->height);
+}
+
+static VCBGR8 color_view(const IVC *image)
+{
+	return VCBGR8((unsigned char *)image->data, image->width, image->height);
+}
+
+extern "C" int vc_bgr_to_rgb(IVC *src, IVC *dst)
+{
+	if (src == NULL || dst == NULL || src->data == NULL || dst->data == NULL)
+		return 0;
+	if (src->width != dst->width || src->height != dst->height || src->channels != 3 || dst->channels != 3)
+		return 0;
+
+	vc_kernel_swap_rb(color_view(src), color_view(dst));
+
+	return 1;
+}
+
+extern "C" int vc_bgr_to_rgb_half(IVC *src, IVC *dst)
+{
+	if (src == NULL || dst == NULL || src->data == NULL || dst->data == NULL)
+		return 0;
+	if (src->width / 2 != dst->width || src->height / 2 != dst->height || src->channels != 3 || dst->channels != 3)
+		return 0;
+
+	vc_kernel_half_swap_rb(color_view(src), color_view(dst));
+
+	return 1;
+}
+
+extern "C" int vc_rgb_to_gray(IVC *src, IVC *dst)
+{
+	if (src == NULL || dst == NULL || src->data == NULL || dst->data == NULL)
+		return 0;
+	if (src->width != dst->width || src->height != dst->height || src->channels != 3 || dst->channels != 1)
+		return 0;
+
+	vc_kernel_rgb_to_gray(color_view(src), gray_view(dst));
+
+	return 1;
+}
+
+extern "C" int vc_gray_to_binary(IVC *src, IVC *dst, int threshold)
+{
+	if (src == NULL || dst == NULL || src->data == NULL || dst->data == NULL)
+	{
+		printf("Error -> vc_gray_to_binary():\n\tImage is empty!\n");
+		return 0;
+	}
+	if (src->width != dst->width || src->height != dst->height || src->channels != 1 || dst->channels != 1)
+	{
+		printf("Error -> vc_gray_to_binary():\n\tImage is not grayscale!\n");
+		return 0;
+	}
+
+	vc_kernel_threshold(gray_view(src), gray_view(dst), threshold);
+
+	return 1;
+}
+
+extern "C" int vc_hsv_segmentation(IVC *src, IVC *dst, int hmin, int hmax, int smin, int smax, int vmin, int vmax)
+{
+	if (src == NULL || dst == NULL || src->data == NULL || dst->data == NULL)
+	{
+		printf("Error -> vc_hsv_segmentation():\n\tImage is empty!\n");
+		return 0;
+	}
+	if (src->width != dst->width || src->height != dst->height || src->channels != 3 || dst->channels != 1)
+	{
+		printf("Error -> vc_hsv_segmentation():\n\tImages dimensions or channels mismatch!\n");
+		return 0;
+	}
+
+	vc_kernel_hsv_segmentation(color_view(src), gray_view(dst), hmin, hmax, smin, smax, vmin, vmax);
+
+	return 1;
+}
+
+// Erosão/dilatação: dst tem de ter a resolução de src (não é verificado, como em vc.c)
+template <bool Erode>
+static int binary_morph(IVC *src, IVC *dst, int kernel)
+{
+	if ((src->width <= 0) || (src->height <= 0) || (src->data == NULL) || (dst->data == NULL))
+		return 0;
+	if (src->channels != 1)
+		return 0;
+	if (dst->channels != 1)
+		return 0;
+
+	VCGray8 out((unsigned char *)dst->data, src->width, src->height);
+	vc_kernel_binary_morph<Erode>(gray_view(src), out, kernel);
+
+	return 1;
+}
+
+extern "C" int vc_binary_erode(IVC *src, IVC *dst, int kernel)
+{
+	return binary_morph<true>(src, dst, kernel);
+}
+
+extern "C" int vc_binary_dilate(IVC *src, IVC *dst, int kernel)
+{
+	return binary_morph<false>(src, dst, kernel);
+}
+
+extern "C" int vc_gray_to_binary_niblack(IVC *src, IVC *dst, int kernel, float k)
+{
+	if ((src->width <= 0) || (src->height <= 0) || (src->channels <= 0) || (src->levels <= 0) || (src->data == NULL) || (dst->data == NULL))
+		return 0;
+	if ((src->channels != 1) || (dst->channels != 1))
+		return 0;
+
+	VCGray8 out((unsigned char *)dst->data, src->width, src->height);
+	vc_kernel_niblack(gray_view(src), out, kernel, k);
+
+	return 1;
+}
+
+extern "C" int vc_rgb_negative(IVC *srcdst)
+{
+	if ((srcdst->width <= 0) || (srcdst->height <= 0) || (srcdst->data == NULL))
+		return 0;
+	if (srcdst->channels != 3)
+		return 0;
+
+	vc_kernel_negative(color_view(srcdst));
+
+	return 1;
+}
+
+extern "C" int vc_gray_negative(IVC *srcdst)
+{
+	if ((srcdst->width <= 0) || (srcdst->height <= 0) || (srcdst->data == NULL))
+		return 0;
+	if (srcdst->channels != 1)
+		return 0;
+
+	vc_kernel_negative(gray_view(srcdst));
+
+	return 1;
+}
+
+// Filtros de convolução (máscaras em vc_convolve.hpp)
+
+static int gray_filter_check(const IVC *src, const char *name)
+{
+	if ((src->width <= 0) || (src->height <= 0) || (src->data == NULL))
+	{
+		printf("%s() - Erro nos parametros de entrada.\n", name);
+		return 0;
+	}
+	if (src->channels != 1)
+	{
+		printf("%s() - A imagem de entrada não é de cinzentos.\n", name);
+		return 0;
+	}
+	return 1;
+}
+
+extern "C" int vc_gray_gaussian_filter(IVC *src, IVC *dst)
+{
+	if (!gray_filter_check(src, "vc_gray_gaussian_filter"))
+		return 0;
+
+	// Só o interior é escrito; normalização em float, como a versão original
+	vc_convolve<VCMaskGaussian5>(gray_view(src), gray_view(dst), [](int sum)
+								 { return (unsigned char)((float)sum * (1.0f / 273.0f)); });
+
+	return 1;
+}
+
+// |L| * norm, saturado a 255; as margens ficam a 0
+template <typename Mask>
+static void laplacian(IVC *src, IVC *dst, float norm)
+{
+	memset(dst->data, 0, (size_t)src->width * src->height);
+	vc_convolve<Mask>(gray_view(src), gray_view(dst), [norm](int sum)
+					  {
+						  float value = (float)abs(sum) * norm;
+						  return (unsigned char)((value > 255.0f) ? 255.0f : value); });
+}
+
+extern "C" int vc_gray_laplacian_filter(IVC *src, IVC *dst, int variant)
+{
+	if (!gray_filter_check(src, "vc_gray_laplacian_filter"))
+		return 0;
+
+	switch (variant)
+	{
+	case VC_LAPLACIAN_4:
+		laplacian<VCMaskLaplacian4>(src, dst, 1.0f / 6.0f);
+		break;
+	case VC_LAPLACIAN_8:
+		laplacian<VCMaskLaplacian8>(src, dst, 1.0f / 9.0f);
+		break;
+	case VC_LAPLACIAN_DIAGONAL:
+		laplacian<VCMaskLaplacianDiagonal>(src, dst, 1.0f / 3.0f);
+		break;
+	default:
+		printf("vc_gray_laplacian_filter() - Variante %d desconhecida.\n", variant);
+		return 0;
+	}
+
+	return 1;
+}
+
+extern "C" int vc_gray_highpass_laplacian_filter(IVC *src, IVC *dst)
+{
+	if (!gray_filter_check(src, "vc_gray_highpass_laplacian_filter"))
+		return 0;
+
+	laplacian<VCMaskLaplacian4>(src, dst, 1.0f / 6.0f);
+
+	return 1;
+}
+
+// Contornos: magnitude do gradiente (inteira, em níveis de cinzento: dividida pelo ganho da
+// máscara) seguida de binarização pelo percentil th do histograma. O histograma é construído
+// durante o cálculo do gradiente, o limiar sai dele e a binarização é a única passagem adicional
+// (sobre dst, que acabou de ser escrita).
+
+static int edge_check(const IVC *src, float th, const char *name)
+{
+	if (!gray_filter_check(src, name))
+		return 0;
+	if ((th < 0) || (th > 1))
+	{
+		printf("%s() - O limiar de detecção de arestas tem que estar entre 0 e 1.\n", name);
+		return 0;
+	}
+	return 1;
+}
+
+// Menor nível cujo histograma acumulado atinge th * total
+static int edge_percentile(const int histogram[256], long int total, float th)
+{
+	float target_sum = total * th;
+	long int sum = 0;
+
+	for (int i = 0; i < 256; i++)
+	{
+		sum += histogram[i];
+		if (sum >= target_sum)
+			return i;
+	}
+	return 0;
+}
+
+template <typename MaskX, typename MaskY>
+static int edge_magnitude(IVC *src, IVC *dst, int norm, int histogram[256], const char *name)
+{
+	switch (norm)
+	{
+	case VC_EDGE_L1:
+		vc_edge_magnitude<MaskX, MaskY, VCNormL1>(gray_view(src), gray_view(dst), histogram);
+		return 1;
+	case VC_EDGE_LINF:
+		vc_edge_magnitude<MaskX, MaskY, VCNormLInf>(gray_view(src), gray_view(dst), histogram);
+		return 1;
+	case VC_EDGE_L2:
+		vc_edge_magnitude<MaskX, MaskY, VCNormL2>(gray_view(src), gray_view(dst), histogram);
+		return 1;
+	}
+	printf("%s() - Norma %d desconhecida.\n", name, norm);
+	return 0;
+}
+
+// vc_gray_edge com o nome da função chamada pelo utilizador nas mensagens de erro
+static int gray_edge(IVC *src, IVC *dst, int op, int norm, float th, const char *name)
+{
+	int histogram[256];
+	int ok;
+
+	if (!edge_check(src, th, name))
+		return 0;
+
+	switch (op)
+	{
+	case VC_EDGE_PREWITT:
+		ok = edge_magnitude<VCMaskPrewittX, VCMaskPrewittY>(src, dst, norm, histogram, name);
+		break;
+	case VC_EDGE_SOBEL:
+		ok = edge_magnitude<VCMaskSobelX, VCMaskSobelY>(src, dst, norm, histogram, name);
+		break;
+	case VC_EDGE_SCHARR:
+		ok = edge_magnitude<VCMaskScharrX, VCMaskScharrY>(src, dst, norm, histogram, name);
+		break;
+	default:
+		printf("%s() - Operador %d desconhecido.\n", name, op);
+		return 0;
+	}
+	if (!ok)
+		return 0;
+
+	int threshold = edge_percentile(histogram, (long int)src->width * src->height, th);
+	vc_kernel_threshold(gray_view(dst), gray_view(dst), threshold);
+
+	return 1;
+}
+
+extern "C" int vc_gray_edge(IVC *src, IVC *dst, int op, int norm, float th)
+{
+	return gray_edge(src, dst, op, norm, th, "vc_gray_edge");
+}
+
+extern "C" int vc_gray_edge_prewitt(IVC *src, IVC *dst, float th)
+{
+	return gray_edge(src, dst, VC_EDGE_PREWITT, VC_EDGE_L2, th, "vc_gray_edge_prewitt");
+}
+
+extern "C" int vc_gray_edge_sobel(IVC *src, IVC *dst, float th)
+{
+	return gray_edge(src, dst, VC_EDGE_SOBEL, VC_EDGE_L2, th, "vc_gray_edge_sobel");
+}
+
+extern "C" int vc_gray_edge_scharr(IVC *src, IVC *dst, float th)
+{
+	return gray_edge(src, dst, VC_EDGE_SCHARR, VC_EDGE_L2, th, "vc_gray_edge_scharr");
+}
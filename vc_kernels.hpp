@@ -0,0 +1,238 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//          KERNELS SOBRE VISTAS TIPADAS (VCImageView)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <math.h>
+
+#include <vector>
+
+#include "vc_image.hpp"
+
+// Versões em template dos kernels ponto-a-ponto e morfológicos de vc.c. O número de canais é
+// constante em compilação e o ciclo interior percorre uma linha contígua, o que permite ao
+// compilador vetorizar. Os resultados são idênticos bit a bit aos das versões em C originais
+// (verificado por vc_golden); as funções de vc.h passam a ser invólucros (vc_kernels.cpp).
+// Nenhum kernel aceita src e dst sobrepostos, exceto os que trabalham no próprio lugar.
+
+// dst = 255 - src, em todos os canais (no próprio lugar)
+template <typename T, int C>
+void vc_kernel_negative(const VCImageView<T, C> &srcdst)
+{
+	const int n = srcdst.width() * C;
+
+	for (int y = 0; y < srcdst.height(); y++)
+	{
+		T *row = srcdst.row(y);
+
+		for (int i = 0; i < n; i++)
+			row[i] = (T)(255 - row[i]);
+	}
+}
+
+// Troca o primeiro e o terceiro canal (BGR <-> RGB)
+inline void vc_kernel_swap_rb(const VCBGR8 &src, const VCRGB8 &dst)
+{
+	for (int y = 0; y < src.height(); y++)
+	{
+		const unsigned char *s = src.row(y);
+		unsigned char *d = dst.row(y);
+
+		for (int x = 0; x < src.width(); x++)
+		{
+			d[x * 3] = s[x * 3 + 2];
+			d[x * 3 + 1] = s[x * 3 + 1];
+			d[x * 3 + 2] = s[x * 3];
+		}
+	}
+}
+
+// BGR -> RGB com metade da resolução: cada pixel de dst é a média (arredondada) de um bloco 2x2
+// de src. Um nível acima na pirâmide, numa só passagem; a última coluna/linha ímpar é ignorada.
+inline void vc_kernel_half_swap_rb(const VCBGR8 &src, const VCRGB8 &dst)
+{
+	for (int y = 0; y < dst.height(); y++)
+	{
+		const unsigned char *s0 = src.row(2 * y);
+		const unsigned char *s1 = src.row(2 * y + 1);
+		unsigned char *d = dst.row(y);
+
+		for (int x = 0; x < dst.width(); x++)
+		{
+			const unsigned char *a = s0 + x * 6;
+			const unsigned char *b = s1 + x * 6;
+
+			for (int c = 0; c < 3; c++)
+				d[x * 3 + 2 - c] = (unsigned char)((a[c] + a[c + 3] + b[c] + b[c + 3] + 2) >> 2);
+		}
+	}
+}
+
+// Luminância (0.299 R + 0.587 G + 0.114 B), calculada em double e truncada como em vc.c
+inline void vc_kernel_rgb_to_gray(const VCRGB8 &src, const VCGray8 &dst)
+{
+	for (int y = 0; y < src.height(); y++)
+	{
+		const unsigned char *s = src.row(y);
+		unsigned char *d = dst.row(y);
+
+		for (int x = 0; x < src.width(); x++)
+		{
+			float rf = (float)s[x * 3];
+			float gf = (float)s[x * 3 + 1];
+			float bf = (float)s[x * 3 + 2];
+
+			d[x] = (unsigned char)((rf * 0.299) + (gf * 0.587) + (bf * 0.114));
+		}
+	}
+}
+
+// dst = 255 se src > threshold, 0 caso contrário
+inline void vc_kernel_threshold(const VCGray8 &src, const VCGray8 &dst, int threshold)
+{
+	for (int y = 0; y < src.height(); y++)
+	{
+		const unsigned char *s = src.row(y);
+		unsigned char *d = dst.row(y);
+
+		for (int x = 0; x < src.width(); x++)
+			d[x] = (s[x] > threshold) ? 255 : 0;
+	}
+}
+
+// Segmentação HSV com intervalos inclusivos em graus (H) e percentagem (S, V).
+// A conversão de cada canal só depende do seu valor: é feita uma vez por nível numa tabela
+// com a mesma expressão em float de vc.c, e o ciclo por pixel reduz-se a três consultas.
+inline void vc_kernel_hsv_segmentation(const VCHSV8 &src, const VCGray8 &dst, int hmin, int hmax, int smin, int smax, int vmin, int vmax)
+{
+	unsigned char inside[3][256];
+
+	for (int i = 0; i < 256; i++)
+	{
+		int h = (int)((float)i / 255.0f * 360.0f);
+		int p = (int)((float)i / 255.0f * 100.0f); // S e V usam a mesma escala
+
+		inside[0][i] = (h >= hmin && h <= hmax) ? 1 : 0;
+		inside[1][i] = (p >= smin && p <= smax) ? 1 : 0;
+		inside[2][i] = (p >= vmin && p <= vmax) ? 1 : 0;
+	}
+
+	for (int y = 0; y < src.height(); y++)
+	{
+		const unsigned char *s = src.row(y);
+		unsigned char *d = dst.row(y);
+
+		for (int x = 0; x < src.width(); x++)
+			d[x] = (inside[0][s[x * 3]] & inside[1][s[x * 3 + 1]] & inside[2][s[x * 3 + 2]]) ? 255 : 0;
+	}
+}
+
+// Morfologia binária com vizinhança quadrada kernel x kernel, limitada à imagem.
+// Erosão: 255 se o centro for 255 e nenhum vizinho for 0. Dilatação: OU dos vizinhos.
+// Ambas são separáveis: primeiro acumula-se a coluna (linhas y-offset..y+offset) e depois a
+// janela horizontal sobre a acumulação, em O(kernel) por pixel em vez de O(kernel^2).
+template <bool Erode>
+void vc_kernel_binary_morph(const VCGray8 &src, const VCGray8 &dst, int kernel)
+{
+	const int width = src.width();
+	const int height = src.height();
+	const int offset = (kernel - 1) / 2;
+	const int pad = (offset > 0) ? offset : 0;
+
+	// Colunas acumuladas com pad zeros de cada lado (neutro para o OU)
+	std::vector<unsigned char> column((size_t)width + 2 * pad, 0);
+	std::vector<unsigned char> window((size_t)width);
+	unsigned char *col = column.data() + pad;
+	unsigned char *acc = window.data();
+
+	for (int y = 0; y < height; y++)
+	{
+		int y0 = (y - offset < 0) ? 0 : y - offset;
+		int y1 = (y + offset >= height) ? height - 1 : y + offset;
+
+		for (int x = 0; x < width; x++)
+			col[x] = 0;
+		for (int yy = y0; yy <= y1; yy++)
+		{
+			const unsigned char *s = src.row(yy);
+
+			// Erosão: marca as colunas com algum 0; dilatação: OU dos valores
+			for (int x = 0; x < width; x++)
+				col[x] |= Erode ? (unsigned char)(s[x] == 0) : s[x];
+		}
+
+		for (int x = 0; x < width; x++)
+			acc[x] = 0;
+		for (int j = -offset; j <= offset; j++)
+			for (int x = 0; x < width; x++)
+				acc[x] |= col[x + j];
+
+		const unsigned char *s = src.row(y);
+		unsigned char *d = dst.row(y);
+
+		for (int x = 0; x < width; x++)
+		{
+			if (Erode)
+				d[x] = ((s[x] == 255) && (acc[x] == 0)) ? 255 : 0;
+			else
+				d[x] = acc[x];
+		}
+	}
+}
+
+// Binarização de Niblack: 255 se src > média + k * desvio padrão da vizinhança kernel x kernel
+// (limitada à imagem). Com a aritmética da versão em C: média truncada a unsigned char, soma dos
+// quadrados dos desvios acumulada em unsigned char (módulo 256) e dividida pelo número de
+// pixeis em inteiros. Como sum((p - m)^2) = sum(p^2) - 2 m sum(p) + n m^2, basta acumular p e p^2
+// por coluna (como na morfologia), em O(kernel) por pixel em vez de duas passagens O(kernel^2).
+inline void vc_kernel_niblack(const VCGray8 &src, const VCGray8 &dst, int kernel, float k)
+{
+	const int width = src.width();
+	const int height = src.height();
+	const int offset = ((kernel - 1) / 2 > 0) ? (kernel - 1) / 2 : 0;
+
+	std::vector<int> column((size_t)width), square((size_t)width);
+
+	for (int y = 0; y < height; y++)
+	{
+		int y0 = (y - offset < 0) ? 0 : y - offset;
+		int y1 = (y + offset >= height) ? height - 1 : y + offset;
+
+		for (int x = 0; x < width; x++)
+			column[x] = square[x] = 0;
+		for (int yy = y0; yy <= y1; yy++)
+		{
+			const unsigned char *s = src.row(yy);
+			for (int x = 0; x < width; x++)
+			{
+				column[x] += s[x];
+				square[x] += s[x] * s[x];
+			}
+		}
+
+		const unsigned char *s = src.row(y);
+		unsigned char *d = dst.row(y);
+
+		for (int x = 0; x < width; x++)
+		{
+			int x0 = (x - offset < 0) ? 0 : x - offset;
+			int x1 = (x + offset >= width) ? width - 1 : x + offset;
+			long int sum = 0, sumsq = 0;
+
+			for (int xx = x0; xx <= x1; xx++)
+			{
+				sum += column[xx];
+				sumsq += square[xx];
+			}
+
+			int count = (y1 - y0 + 1) * (x1 - x0 + 1);
+			unsigned char mean = (unsigned char)(sum / count);
+			unsigned char deviation = (unsigned char)((sumsq - 2 * mean * sum + (long int)count * mean * mean) & 255);
+			unsigned char sdeviation = (unsigned char)sqrtf((float)(deviation / count));
+			float threshold = mean + k * sdeviation;
+
+			d[x] = (s[x] > threshold) ? 255 : 0;
+		}
+	}
+}
@@ -0,0 +1,213 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//          GRAVAÇÃO ASSÍNCRONA DO VÍDEO ANOTADO
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <cstring>
+#include <string>
+#include <opencv2/opencv.hpp>
+
+#include "vc_frames.hpp"
+#include "vc_output.hpp"
+#include "vc_stage.h"
+
+struct VCOutputSink
+{
+	cv::VideoWriter video;
+	VCFrameWriter raw;
+};
+
+VCVideoOutput::VCVideoOutput(int capacity, bool drop)
+	: capacity(capacity > 0 ? capacity : 1), drop(drop)
+{
+}
+
+VCVideoOutput::~VCVideoOutput()
+{
+	close();
+}
+
+bool VCVideoOutput::open(const char *filename, int format, int width, int height, double fps)
+{
+	close();
+
+	if ((filename == NULL) || (width <= 0) || (height <= 0) || ((format != VC_OUTPUT_VIDEO) && (format != VC_OUTPUT_RAW)))
+	{
+		printf("VCVideoOutput::open() - Erro nos parametros de entrada.\n");
+		return false;
+	}
+
+	sink.reset(new VCOutputSink);
+	if (format == VC_OUTPUT_RAW)
+	{
+		if (!sink->raw.open(filename, width, height, 3, fps))
+		{
+			sink.reset();
+			return false;
+		}
+	}
+	else
+	{
+		std::string name(filename);
+		bool avi = (name.size() >= 4) && (name.compare(name.size() - 4, 4, ".avi") == 0);
+		int fourcc = avi ? cv::VideoWriter::fourcc('M', 'J', 'P', 'G') : cv::VideoWriter::fourcc('m', 'p', '4', 'v');
+		if (!sink->video.open(filename, fourcc, (fps > 0.0) ? fps : 30.0, cv::Size(width, height), true) || !sink->video.isOpened())
+		{
+			printf("VCVideoOutput::open() - Erro ao abrir o ficheiro %s\n", filename);
+			sink.reset();
+			return false;
+		}
+	}
+
+	this->format = format;
+	this->width = width;
+	this->height = height;
+
+	// Todos os buffers da fila são criados agora: submit() só copia
+	slots.assign(capacity, std::vector<unsigned char>((size_t)width * height * 3));
+	head = count = 0;
+	stopping = false;
+	submitted = written = dropped = depthsum = 0;
+	maxdepth = 0;
+
+	thread = std::thread(&VCVideoOutput::writer_loop, this);
+
+	return true;
+}
+
+bool VCVideoOutput::submit(const IVC *frame)
+{
+	if (!thread.joinable() || (frame == NULL) || (frame->data == NULL))
+		return false;
+	if ((frame->width != width) || (frame->height != height) || (frame->channels != 3))
+	{
+		printf("VCVideoOutput::submit() - A frame não tem a resolução da saída.\n");
+		return false;
+	}
+
+	int slot;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		submitted++;
+		depthsum += count;
+		if (count == capacity)
+		{
+			if (drop)
+			{
+				dropped++;
+				return false;
+			}
+			notfull.wait(lock, [this]
+						 { return count < capacity; });
+		}
+		// O slot seguinte à fila não é lido pela thread de gravação até count aumentar
+		slot = (head + count) % capacity;
+	}
+
+	// Cópia fora do lock (a thread de gravação continua a escrever a frame dela)
+	size_t rowsize = (size_t)width * 3;
+	unsigned char *dst = slots[slot].data();
+	if ((size_t)frame->bytesperline == rowsize)
+		memcpy(dst, frame->data, rowsize * height);
+	else
+		for (int y = 0; y < height; y++)
+			memcpy(dst + rowsize * y, frame->data + (size_t)frame->bytesperline * y, rowsize);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		count++;
+		if (count > maxdepth)
+			maxdepth = count;
+	}
+	notempty.notify_one();
+
+	return true;
+}
+
+void VCVideoOutput::writer_loop()
+{
+	for (;;)
+	{
+		int slot;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			notempty.wait(lock, [this]
+						  { return (count > 0) || stopping; });
+			// close() só termina depois de escritas todas as frames em fila
+			if (count == 0)
+				break;
+			slot = head;
+		}
+
+		{
+			VCStageTimer timer(VC_STAGE_ENCODE);
+
+			unsigned char *data = slots[slot].data();
+			if (format == VC_OUTPUT_RAW)
+			{
+				IVC image = {data, width, height, 3, 255, width * 3};
+				sink->raw.write(&image);
+			}
+			else
+			{
+				sink->video.write(cv::Mat(height, width, CV_8UC3, data));
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			head = (head + 1) % capacity;
+			count--;
+			written++;
+		}
+		notfull.notify_one();
+	}
+
+	if (format == VC_OUTPUT_RAW)
+		sink->raw.close();
+	else
+		sink->video.release();
+}
+
+void VCVideoOutput::close()
+{
+	if (!thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	notempty.notify_one();
+	thread.join();
+	sink.reset();
+
+	// Os contadores ficam para stats() e report()
+	slots.clear();
+	slots.shrink_to_fit();
+}
+
+VCOutputStats VCVideoOutput::stats() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	VCOutputStats s;
+
+	s.submitted = submitted;
+	s.written = written;
+	s.dropped = dropped;
+	s.capacity = capacity;
+	s.maxdepth = maxdepth;
+	s.meandepth = (submitted > 0) ? (double)depthsum / (double)submitted : 0.0;
+
+	return s;
+}
+
+void VCVideoOutput::report(FILE *file) const
+{
+	VCOutputStats s = stats();
+
+	fprintf(file, "output: %lld frames, %lld written, %lld dropped (%.1f%%), queue %d/%d max, %.2f mean\n",
+			s.submitted, s.written, s.dropped, (s.submitted > 0) ? 100.0 * s.dropped / s.submitted : 0.0,
+			s.maxdepth, s.capacity, s.meandepth);
+	fflush(file);
+}
@@ -0,0 +1,87 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//          GRAVAÇÃO ASSÍNCRONA DO VÍDEO ANOTADO
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+extern "C"
+{
+#include "vc.h"
+}
+
+// Formato da saída
+#define VC_OUTPUT_VIDEO 0 // cv::VideoWriter (MJPG em .avi, mp4v nas outras extensões)
+#define VC_OUTPUT_RAW 1	  // Sequência de frames em bruto (VCFrameWriter, vc_frames.hpp)
+
+// Destino das frames (cv::VideoWriter ou VCFrameWriter), definido em vc_output.cpp
+struct VCOutputSink;
+
+// Contadores da fila (para o relatório e para afinar a capacidade)
+struct VCOutputStats
+{
+	long long submitted; // Frames entregues a submit()
+	long long written;	 // Frames escritas pela thread de gravação
+	long long dropped;	 // Frames descartadas com a fila cheia
+	int capacity;
+	int maxdepth;	  // Maior número de frames em fila
+	double meandepth; // Frames em fila, em média, quando chega uma nova
+};
+
+// Saída do vídeo anotado: submit() copia a frame para uma fila limitada (buffers criados em open())
+// e regressa; uma thread própria codifica e escreve as frames por ordem. Com a fila cheia, a frame
+// é descartada (drop = true, o ciclo de deteção nunca espera) ou submit() espera por um lugar livre
+// (drop = false, todas as frames ficam no ficheiro). Só uma thread pode chamar submit().
+class VCVideoOutput
+{
+public:
+	explicit VCVideoOutput(int capacity = 8, bool drop = true);
+	~VCVideoOutput();
+
+	VCVideoOutput(const VCVideoOutput &) = delete;
+	VCVideoOutput &operator=(const VCVideoOutput &) = delete;
+
+	// Frames BGR com width x height; o ficheiro é aberto aqui, para os erros aparecerem logo
+	bool open(const char *filename, int format, int width, int height, double fps);
+	// Pôr uma cópia da frame na fila. Devolve false se a frame foi descartada.
+	bool submit(const IVC *frame);
+	// Escrever as frames que faltam, terminar a thread e fechar o ficheiro
+	void close();
+
+	bool is_open() const { return thread.joinable(); }
+	VCOutputStats stats() const;
+	// Uma linha com os contadores da fila
+	void report(FILE *file) const;
+
+private:
+	void writer_loop();
+
+	int capacity;
+	bool drop;
+	int format = VC_OUTPUT_VIDEO;
+	int width = 0, height = 0;
+	// Aberto por open() e usado só pela thread de gravação
+	std::unique_ptr<VCOutputSink> sink;
+
+	// Fila circular: frames em fila de slots[head] a slots[(head + count - 1) % capacity].
+	// O slot a ser escrito pela thread de gravação só é libertado depois da escrita.
+	std::vector<std::vector<unsigned char>> slots;
+	int head = 0;
+	int count = 0;
+	bool stopping = false;
+
+	mutable std::mutex mutex;
+	std::condition_variable notempty;
+	std::condition_variable notfull;
+	std::thread thread;
+
+	long long submitted = 0, written = 0, dropped = 0;
+	long long depthsum = 0;
+	int maxdepth = 0;
+};
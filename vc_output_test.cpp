@@ -0,0 +1,148 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//      TESTE DA FILA DA GRAVAÇÃO DO VÍDEO ANOTADO
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   vc_output_test    teste automático (ctest): VCVideoOutput grava uma sequência em bruto
+//                     (VC_OUTPUT_RAW) que é lida de volta com VCFrameReader. A espera com a fila
+//                     cheia tem de gravar todas as frames por ordem; o descarte tem de gravar
+//                     exatamente as frames aceites por submit(), com contadores coerentes.
+
+#include <chrono>
+#include <filesystem>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vc_frames.hpp"
+#include "vc_output.hpp"
+#include "vc_test.h"
+
+// Frames grandes: cada escrita demora muito mais do que pôr a frame seguinte na fila
+#define WIDTH 1280
+#define HEIGHT 720
+
+static std::string temp_path(const char *name)
+{
+	return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// Frame com o número n em todos os pixeis (n < 256) e um padrão por linha, com 16 bytes de espaço
+// no fim de cada linha
+static void fill(int n, std::vector<unsigned char> &buffer, IVC *image)
+{
+	const int stride = WIDTH * 3 + 16;
+
+	buffer.assign((size_t)stride * HEIGHT, 0xEE);
+	for (int y = 0; y < HEIGHT; y++)
+		for (int x = 0; x < WIDTH * 3; x++)
+			buffer[(size_t)y * stride + x] = (x % 3 == 0) ? (unsigned char)n : (unsigned char)(y + x);
+	*image = {buffer.data(), WIDTH, HEIGHT, 3, 255, stride};
+}
+
+// Os números das frames gravadas em path (verificando o resto dos pixeis de cada uma)
+static bool read_back(const std::string &path, std::vector<int> &numbers)
+{
+	VCFrameReader reader;
+	CHECK(reader.open(path.c_str()), "a gravação não abre: " << path);
+	CHECK((reader.width() == WIDTH) && (reader.height() == HEIGHT) && (reader.channels() == 3), "resolução da gravação");
+
+	numbers.clear();
+	for (int i = 0; i < reader.count(); i++)
+	{
+		IVC image;
+		CHECK(reader.frame(i, &image), "frame " << i << " da gravação");
+		int n = image.data[0];
+		for (int y = 0; y < HEIGHT; y++)
+		{
+			const unsigned char *row = image.data + (size_t)y * image.bytesperline;
+			for (int x = 0; x < WIDTH * 3; x++)
+				CHECK(row[x] == ((x % 3 == 0) ? (unsigned char)n : (unsigned char)(y + x)),
+					  "frame " << i << " da gravação, byte (" << x << ", " << y << ")");
+		}
+		numbers.push_back(n);
+	}
+	return true;
+}
+
+// A esperar por lugar na fila: todas as frames no ficheiro, pela ordem de submit()
+static bool test_block(void)
+{
+	const int nframes = 24;
+	std::string path = temp_path("vc_output_test_block.vcf");
+	std::vector<unsigned char> buffer;
+	IVC image;
+
+	VCVideoOutput output(2, false);
+	CHECK(output.open(path.c_str(), VC_OUTPUT_RAW, WIDTH, HEIGHT, 30.0), "open de " << path);
+	for (int n = 0; n < nframes; n++)
+	{
+		fill(n, buffer, &image);
+		CHECK(output.submit(&image), "frame " << n << " recusada a esperar pela fila");
+	}
+	output.close();
+
+	VCOutputStats s = output.stats();
+	CHECK((s.submitted == nframes) && (s.written == nframes) && (s.dropped == 0),
+		  s.submitted << " entregues, " << s.written << " escritas, " << s.dropped << " descartadas");
+	CHECK(s.maxdepth <= 2, "fila com " << s.maxdepth << " frames e capacidade 2");
+
+	std::vector<int> numbers;
+	if (!read_back(path, numbers))
+		return false;
+	CHECK((int)numbers.size() == nframes, numbers.size() << " frames no ficheiro, esperadas " << nframes);
+	for (int n = 0; n < nframes; n++)
+		CHECK(numbers[n] == n, "frame " << n << " do ficheiro é a " << numbers[n]);
+
+	std::remove(path.c_str());
+	printf("block: %d frames escritas por ordem\n", nframes);
+	return true;
+}
+
+// Com 1 lugar e frames entregues em rajadas de 8 (mais depressa do que são escritas, com uma pausa
+// entre rajadas para a fila esvaziar), as frames com a fila cheia são descartadas: o ficheiro tem
+// exatamente as aceites por submit(), por ordem
+static bool test_drop(void)
+{
+	const int nframes = 40;
+	std::string path = temp_path("vc_output_test_drop.vcf");
+	std::vector<unsigned char> buffers[nframes];
+	IVC images[nframes];
+	std::vector<int> accepted;
+
+	// Frames preparadas antes, para as entregas seguidas só copiarem
+	for (int n = 0; n < nframes; n++)
+		fill(n, buffers[n], &images[n]);
+
+	VCVideoOutput output(1, true);
+	CHECK(output.open(path.c_str(), VC_OUTPUT_RAW, WIDTH, HEIGHT, 30.0), "open de " << path);
+	for (int n = 0; n < nframes; n++)
+	{
+		if ((n > 0) && (n % 8 == 0))
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		if (output.submit(&images[n]))
+			accepted.push_back(n);
+	}
+	output.close();
+
+	VCOutputStats s = output.stats();
+	CHECK(s.submitted == s.written + s.dropped, s.submitted << " entregues != " << s.written << " escritas + " << s.dropped << " descartadas");
+	CHECK((s.submitted == nframes) && (s.written == (long long)accepted.size()), s.written << " escritas, " << accepted.size() << " aceites");
+	CHECK((s.dropped > 0) && (s.written > 0), "sem descartes (" << s.dropped << ") ou sem escritas (" << s.written << ")");
+	CHECK(s.maxdepth == 1, "fila com " << s.maxdepth << " frames e capacidade 1");
+
+	std::vector<int> numbers;
+	if (!read_back(path, numbers))
+		return false;
+	CHECK((long long)numbers.size() == s.written, numbers.size() << " frames no ficheiro, " << s.written << " escritas");
+	CHECK(numbers == accepted, "as frames do ficheiro não são as aceites por submit()");
+
+	std::remove(path.c_str());
+	printf("drop: %lld frames escritas, %lld descartadas\n", s.written, s.dropped);
+	return true;
+}
+
+int main(void)
+{
+	return vc_test_run({test_block, test_drop});
+}
@@ -0,0 +1,158 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//               ANOTAÇÕES SOBRE A IMAGEM (OVERLAY)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+#include "vc_overlay.hpp"
+
+// Número máximo de textos em cache (os valores das resistências mudam pouco entre frames)
+#define VC_OVERLAY_MAX_SPRITES 512
+
+// Tipo de letra usado em todo o programa
+#define VC_OVERLAY_FONT cv::FONT_HERSHEY_SIMPLEX
+#define VC_OVERLAY_SCALE 1.0
+
+void VCOverlay::clear()
+{
+	items.clear();
+
+	// Só se esvazia a cache entre frames, para os sprites da frame atual continuarem válidos
+	if (sprites.size() > VC_OVERLAY_MAX_SPRITES)
+		sprites.clear();
+}
+
+const VCTextSprite *VCOverlay::sprite(const std::string &text)
+{
+	auto it = sprites.find(text);
+	if (it != sprites.end())
+		return &it->second;
+
+	// Desenhar o texto uma vez: contorno com espessura 2 e preenchimento com espessura 1
+	int baseline = 0;
+	cv::Size size = cv::getTextSize(text, VC_OVERLAY_FONT, VC_OVERLAY_SCALE, 2, &baseline);
+	int margin = 2;
+
+	VCTextSprite s;
+	s.width = size.width + 2 * margin;
+	s.height = size.height + baseline + 2 * margin;
+	s.ox = -margin;
+	s.oy = -(size.height + margin);
+	s.mask.assign(s.width * s.height, 0);
+
+	cv::Mat mask(s.height, s.width, CV_8UC1, s.mask.data());
+	cv::Point origin(-s.ox, -s.oy);
+	cv::putText(mask, text, origin, VC_OVERLAY_FONT, VC_OVERLAY_SCALE, cv::Scalar(1), 2);
+	cv::putText(mask, text, origin, VC_OVERLAY_FONT, VC_OVERLAY_SCALE, cv::Scalar(2), 1);
+
+	return &sprites.emplace(text, std::move(s)).first->second;
+}
+
+void VCOverlay::add_text(const std::string &text, int x, int y)
+{
+	const VCTextSprite *s = sprite(text);
+
+	items.push_back({ITEM_TEXT, x + s->ox, y + s->oy, s->width, s->height, s});
+}
+
+void VCOverlay::add_box(int x, int y, int width, int height)
+{
+	items.push_back({ITEM_BOX, x, y, width, height, nullptr});
+}
+
+void VCOverlay::add_cross(int x, int y, int size)
+{
+	items.push_back({ITEM_CROSS, x - size, y - size, 2 * size + 1, 2 * size + 1, nullptr});
+}
+
+void VCOverlay::add_blob(const OVC *blob)
+{
+	// Os blobs demasiado grandes não são anotados
+	if (blob->area >= 7000)
+		return;
+
+	add_box(blob->x, blob->y, blob->width, blob->height);
+	add_cross(blob->xc, blob->yc);
+}
+
+void VCOverlay::render(IVC *dst)
+{
+	int bytesperline = dst->bytesperline;
+	int channels = dst->channels;
+	unsigned char *data = dst->data;
+
+	dirtyrects.clear();
+
+	for (const Item &item : items)
+	{
+		// Recortar a zona do item pelos limites da imagem
+		int x0 = std::max(item.x, 0);
+		int y0 = std::max(item.y, 0);
+		int x1 = std::min(item.x + item.width, dst->width);
+		int y1 = std::min(item.y + item.height, dst->height);
+		if ((x0 >= x1) || (y0 >= y1))
+			continue;
+
+		dirtyrects.push_back({x0, y0, x1 - x0, y1 - y0});
+
+		switch (item.type)
+		{
+		case ITEM_TEXT:
+		{
+			const VCTextSprite *s = item.sprite;
+
+			for (int y = y0; y < y1; y++)
+			{
+				const unsigned char *m = &s->mask[(y - item.y) * s->width + (x0 - item.x)];
+				unsigned char *p = data + y * bytesperline + x0 * channels;
+
+				for (int x = x0; x < x1; x++, m++, p += channels)
+				{
+					if (*m != 0)
+					{
+						unsigned char value = (*m == 1) ? 0 : 255;
+						for (int c = 0; c < channels; c++)
+							p[c] = value;
+					}
+				}
+			}
+			break;
+		}
+		case ITEM_BOX:
+		{
+			// Linhas horizontais
+			for (int y : {item.y, item.y + item.height - 1})
+			{
+				if ((y >= y0) && (y < y1))
+					memset(data + y * bytesperline + x0 * channels, 255, (x1 - x0) * channels);
+			}
+			// Linhas verticais
+			for (int x : {item.x, item.x + item.width - 1})
+			{
+				if ((x < x0) || (x >= x1))
+					continue;
+				for (int y = y0; y < y1; y++)
+					memset(data + y * bytesperline + x * channels, 255, channels);
+			}
+			break;
+		}
+		case ITEM_CROSS:
+		{
+			int xc = item.x + item.width / 2;
+			int yc = item.y + item.height / 2;
+
+			// Linha horizontal
+			if ((yc >= y0) && (yc < y1))
+				memset(data + yc * bytesperline + x0 * channels, 255, (x1 - x0) * channels);
+			// Linha vertical
+			if ((xc >= x0) && (xc < x1))
+			{
+				for (int y = y0; y < y1; y++)
+					memset(data + y * bytesperline + xc * channels, 255, channels);
+			}
+			break;
+		}
+		}
+	}
+}
@@ -0,0 +1,75 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//               ANOTAÇÕES SOBRE A IMAGEM (OVERLAY)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+extern "C"
+{
+#include "vc.h"
+}
+
+// Texto pré-desenhado: máscara com 0 = transparente, 1 = contorno (preto), 2 = preenchimento (branco)
+struct VCTextSprite
+{
+	int width, height;
+	int ox, oy; // Deslocamento do canto superior esquerdo em relação à origem do texto
+	std::vector<unsigned char> mask;
+};
+
+// Área da imagem alterada pelo overlay
+struct VCDirtyRect
+{
+	int x, y, width, height;
+};
+
+// Recolhe as anotações de uma frame (textos, caixas e centros de gravidade) e desenha-as de uma só vez.
+// Cada texto é desenhado com cv::putText uma única vez e guardado em cache; nas frames seguintes
+// apenas se copiam os pixeis da máscara para a zona da imagem que o texto ocupa.
+class VCOverlay
+{
+public:
+	// Limpar as anotações da frame anterior
+	void clear();
+
+	// Texto com a origem (canto inferior esquerdo) em (x, y), como em cv::putText
+	void add_text(const std::string &text, int x, int y);
+	// Caixa delimitadora com 1 pixel de espessura
+	void add_box(int x, int y, int width, int height);
+	// Cruz com centro em (x, y) e braços de size pixeis
+	void add_cross(int x, int y, int size = 2);
+	// Caixa e centro de gravidade de um blob (como vc_draw_border_box() e vc_draw_of_gravity())
+	void add_blob(const OVC *blob);
+
+	// Desenhar todas as anotações numa imagem de 1 ou 3 canais
+	void render(IVC *dst);
+
+	// Zonas alteradas pelo último render()
+	const std::vector<VCDirtyRect> &dirty() const { return dirtyrects; }
+	size_t cached() const { return sprites.size(); }
+
+private:
+	enum ItemType
+	{
+		ITEM_TEXT,
+		ITEM_BOX,
+		ITEM_CROSS
+	};
+
+	struct Item
+	{
+		ItemType type;
+		int x, y, width, height;
+		const VCTextSprite *sprite;
+	};
+
+	const VCTextSprite *sprite(const std::string &text);
+
+	std::vector<Item> items;
+	std::vector<VCDirtyRect> dirtyrects;
+	std::unordered_map<std::string, VCTextSprite> sprites;
+};
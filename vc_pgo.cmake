@@ -0,0 +1,87 @@
+# Profile-guided optimisation workflow (run by the vc_pgo target, see CMakePresets.json: preset "pgo")
+#
+#   1. instrumented build (VC_PGO=GENERATE) in <binary>/pgo-build
+#   2. headless training run over the reference video (replay benchmark mode of VC_Project)
+#   3. Clang only: merge the raw profiles into default.profdata
+#   4. rebuild the same directory with VC_PGO=USE (GCC matches profiles by object path)
+#   5. baseline build without PGO in <binary>/pgo-baseline and replay benchmark of both
+#
+# Variables: VC_SOURCE_DIR, VC_BINARY_DIR, VC_VIDEO, VC_FRAMES (frames kept in memory), VC_RUNS,
+# VC_FORWARD (cache arguments for the nested builds)
+cmake_minimum_required(VERSION 3.13)
+
+set(PGO_BUILD "${VC_BINARY_DIR}/pgo-build")
+set(PGO_BASELINE "${VC_BINARY_DIR}/pgo-baseline")
+set(PGO_DATA "${VC_BINARY_DIR}/pgo-data")
+separate_arguments(VC_FORWARD)
+
+function(vc_run)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        string(REPLACE ";" " " command "${ARGN}")
+        message(FATAL_ERROR "PGO: command failed (${result}): ${command}")
+    endif()
+endfunction()
+
+function(vc_configure_and_build dir pgo)
+    vc_run(${CMAKE_COMMAND} -S ${VC_SOURCE_DIR} -B ${dir} ${VC_FORWARD} -DVC_PGO=${pgo} -DVC_PGO_DIR=${PGO_DATA})
+    vc_run(${CMAKE_COMMAND} --build ${dir} --target VC_Project --parallel)
+endfunction()
+
+# 1. Instrumented build (old profiles would be mixed with the new ones)
+file(REMOVE_RECURSE ${PGO_DATA})
+message(STATUS "PGO: instrumented build")
+vc_configure_and_build(${PGO_BUILD} GENERATE)
+
+# 2. Training run
+message(STATUS "PGO: training run over ${VC_VIDEO}")
+vc_run(${PGO_BUILD}/VC_Project ${VC_VIDEO} --bench 1 --bench-frames ${VC_FRAMES} --bench-out ${PGO_BUILD}/training.json)
+
+# 3. Clang writes one .profraw per process, which must be merged
+file(GLOB PROFRAW "${PGO_DATA}/*.profraw")
+if(PROFRAW)
+    find_program(LLVM_PROFDATA NAMES llvm-profdata REQUIRED)
+    vc_run(${LLVM_PROFDATA} merge -o ${PGO_DATA}/default.profdata ${PROFRAW})
+endif()
+
+# 4. Optimised build in the same directory
+message(STATUS "PGO: optimised build")
+vc_configure_and_build(${PGO_BUILD} USE)
+
+# 5. Gain against the same options without PGO
+message(STATUS "PGO: baseline build")
+vc_configure_and_build(${PGO_BASELINE} OFF)
+
+message(STATUS "PGO: replay benchmark (${VC_RUNS} runs)")
+vc_run(${PGO_BASELINE}/VC_Project ${VC_VIDEO} --bench ${VC_RUNS} --bench-frames ${VC_FRAMES} --bench-out ${VC_BINARY_DIR}/pgo-baseline.json)
+vc_run(${PGO_BUILD}/VC_Project ${VC_VIDEO} --bench ${VC_RUNS} --bench-frames ${VC_FRAMES} --bench-out ${VC_BINARY_DIR}/pgo-optimised.json)
+
+file(READ ${VC_BINARY_DIR}/pgo-baseline.json baseline)
+file(READ ${VC_BINARY_DIR}/pgo-optimised.json optimised)
+
+# Values as written by VC_Project (string(JSON) would reformat them as doubles)
+function(vc_json_value json key out)
+    string(REGEX MATCH "\"${key}\":([0-9.]+)" match "${json}")
+    set(${out} ${CMAKE_MATCH_1} PARENT_SCOPE)
+endfunction()
+vc_json_value("${baseline}" fps baseline_fps)
+vc_json_value("${optimised}" fps optimised_fps)
+vc_json_value("${baseline}" p99 baseline_p99)
+vc_json_value("${optimised}" p99 optimised_p99)
+
+# fps is written with 3 decimals: compare in thousandths of a frame per second
+string(REPLACE "." "" baseline_mfps "${baseline_fps}")
+string(REPLACE "." "" optimised_mfps "${optimised_fps}")
+math(EXPR gain "(${optimised_mfps} - ${baseline_mfps}) * 1000 / ${baseline_mfps}")
+set(sign "+")
+if(gain LESS 0)
+    set(sign "-")
+    math(EXPR gain "-(${gain})")
+endif()
+math(EXPR gain_int "${gain} / 10")
+math(EXPR gain_frac "${gain} % 10")
+
+message(STATUS "PGO: baseline  ${baseline_fps} fps, p99 ${baseline_p99} us")
+message(STATUS "PGO: optimised ${optimised_fps} fps, p99 ${optimised_p99} us")
+message(STATUS "PGO: gain ${sign}${gain_int}.${gain_frac}%")
+message(STATUS "PGO: optimised binary in ${PGO_BUILD}, results in ${VC_BINARY_DIR}/pgo-*.json")
@@ -0,0 +1,242 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//            PROCESSAMENTO DE UMA FRAME (DETEÇÃO)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <limits>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "vc_canny.hpp"
+#include "vc_kernels.hpp"
+#include "vc_pipeline.hpp"
+#include "vc_stage.h"
+#include "vc_trace.h"
+
+VCPipeline::VCPipeline(int width, int height, VCThreadPool &pool) : width(width), height(height), pool(pool)
+{
+	set_level(0);
+
+	VCBlobFilter f;
+	f.set(VC_BLOB_WIDTH, 101.0f, std::numeric_limits<float>::infinity());
+	f.set(VC_BLOB_HEIGHT, -std::numeric_limits<float>::infinity(), 99.0f);
+	set_blob_filter(f);
+
+	// Preencher já a tabela de cores, para não atrasar a primeira frame
+	vc_color_table_init();
+}
+
+VCPipeline::~VCPipeline()
+{
+	for (Level &l : levels)
+	{
+		vc_image_free(l.rgb);
+		vc_image_free(l.hsv);
+		vc_image_free(l.mask);
+		vc_image_free(l.labels);
+	}
+}
+
+void VCPipeline::set_level(int n)
+{
+	if ((n < 0) || (n >= VC_PIPELINE_LEVELS))
+	{
+		printf("VCPipeline::set_level() - Erro: nível %d fora de [0, %d].\n", n, VC_PIPELINE_LEVELS - 1);
+		return;
+	}
+
+	Level &l = levels[n];
+	if (l.rgb == NULL)
+	{
+		l.rgb = vc_image_new(width >> n, height >> n, 3, 255);
+		l.hsv = vc_image_new(width >> n, height >> n, 3, 255);
+		l.mask = vc_image_new(width >> n, height >> n, 1, 255);
+		l.labels = vc_image_new(width >> n, height >> n, 1, 255);
+	}
+	level = n;
+}
+
+void VCPipeline::set_blob_filter(const VCBlobFilter &f)
+{
+	filter = f;
+	for (int n = 0; n < VC_PIPELINE_LEVELS; n++)
+		plans[n] = VCBlobPlan(filter.scaled(1 << n));
+}
+
+// Blob de um nível da pirâmide na resolução do vídeo
+static void vc_pipeline_scale_blob(OVC *blob, int scale)
+{
+	blob->x *= scale;
+	blob->y *= scale;
+	blob->width *= scale;
+	blob->height *= scale;
+	blob->area *= scale * scale;
+	blob->xc *= scale;
+	blob->yc *= scale;
+	blob->perimeter *= scale;
+}
+
+int VCPipeline::process(const IVC *frame)
+{
+	results.clear();
+
+	if ((frame == NULL) || (frame->width != width) || (frame->height != height) || (frame->channels != 3))
+	{
+		printf("VCPipeline::process() - Erro: a frame não tem a resolução do pipeline.\n");
+		return 0;
+	}
+
+	// Frames sem deteção: as resistências seguem a previsão dos tracks
+	bool detect = (interval <= 1) || (nframes % interval == 0);
+	nframes++;
+	if (!detect)
+	{
+		tracker.predict(results);
+		return 1;
+	}
+
+	// Imagens do nível da pirâmide em uso; as dimensões dos blobs são multiplicadas por scale
+	IVC *rgb = levels[level].rgb;
+	IVC *hsv = levels[level].hsv;
+	IVC *mask = levels[level].mask;
+	IVC *labels = levels[level].labels;
+	const int scale = 1 << level;
+
+	{
+		VCStageTimer timer(VC_STAGE_CONVERT);
+
+		// Transformação de uma imagem BGR para RGB (reduzida no nível 1) e de RGB para HSV
+		if (level == 0)
+			vc_bgr_to_rgb((IVC *)frame, rgb);
+		else
+			vc_bgr_to_rgb_half((IVC *)frame, rgb);
+		vc_rgb_to_hsv(rgb, hsv);
+	}
+
+	{
+		VCStageTimer timer(VC_STAGE_SEGMENTATION);
+
+		// Segmentação de uma imagem HSV
+		vc_hsv_segmentation(hsv, mask, 20, 50, 37, 100, 10, 100);
+	}
+
+	// Dilatar e erodir a imagem para remover ruído
+	// NÃO USAMOS PORQUE: não tem ganhos visíveis e aumenta o tempo de processamento
+	// vc_binary_close(mask, aux, 3, 3);
+
+	// Pesquisa de blobs (a etiquetagem e a informação dos blobs são medidas em vc.c)
+	int nblobs;
+	OVC *blobs = vc_binary_blob_labelling(mask, labels, &nblobs);
+	if (blobs == NULL)
+	{
+		tracker.update(results);
+		return 1;
+	}
+
+	// Limpeza de blobs indesejados, em colunas: primeiro as regras da caixa e da área (que a
+	// etiquetagem já preencheu), para só os restantes passarem por vc_binary_blob_info
+	const VCBlobPlan &plan = plans[level];
+	table.assign(blobs, nblobs);
+	nblobs = table.select(plan, VC_BLOB_STAGE_LABELLING, VC_BLOB_STAGE_LABELLING, candidates);
+	for (int i = 0; i < nblobs; i++)
+		blobs[i] = blobs[candidates[i]];
+
+	// Informação dos blobs
+	vc_binary_blob_info(labels, blobs, nblobs);
+
+	// Regras do perímetro e da orientação
+	table.assign(blobs, nblobs);
+	free(blobs);
+	if (!plan.empty(VC_BLOB_STAGE_MOMENTS))
+		table.moments(labels);
+	table.select(plan, VC_BLOB_STAGE_INFO, VC_BLOB_STAGE_MOMENTS, candidates);
+	for (int i : candidates)
+	{
+		VCDetection d = {};
+		d.blob = table.blob(i);
+		results.push_back(d);
+	}
+
+	// Identificar e descodificar as bandas de cor de cada blob (a imagem HSV só é lida)
+	{
+		VCStageTimer timer(VC_STAGE_CLASSIFICATION);
+		pool.parallel_for((int)results.size(), [&](int i)
+						  {
+							  VCTraceScope scope("resistor");
+							  VCDetection &d = results[i];
+							  // Com os contornos, as bandas são os intervalos entre eles; as
+							  // transições de cor só ficam para quando não dão um valor válido
+							  d.decoded = 0;
+							  if (bandedges && (scale == 1))
+							  {
+								  band_edges(d);
+								  d.decoded = vc_filtro_resistencias_limites(hsv, &d.blob, d.boundary, d.nboundaries, &d.resistor, NULL);
+							  }
+							  if (!d.decoded)
+								  d.decoded = vc_filtro_resistencias(hsv, &d.blob, &d.resistor, NULL);
+							  if (scale > 1)
+								  vc_pipeline_scale_blob(&d.blob, scale); });
+	}
+
+	// Identificador de cada resistência ao longo das frames
+	tracker.update(results);
+
+	return 1;
+}
+
+// Limiares do Canny (|gx| + |gy| da imagem suavizada) para os limites das bandas
+#define VC_BAND_EDGE_LOW 16
+#define VC_BAND_EDGE_HIGH 40
+
+void VCPipeline::band_edges(VCDetection &d) const
+{
+	// Buffers de cada thread do pool, reaproveitados entre blobs e frames
+	thread_local VCCanny canny;
+	thread_local std::vector<unsigned char> gray, edges;
+	thread_local std::vector<int> counts;
+
+	d.nboundaries = 0;
+
+	// Janela: metade central da altura do blob, com a margem do Canny à volta (limitada à imagem)
+	const int m = VCCanny::margin;
+	int x0 = MAX_VC(d.blob.x - m, 0);
+	int x1 = MIN_VC(d.blob.x + d.blob.width + m, width);
+	int y0 = MAX_VC(d.blob.y + d.blob.height / 4 - m, 0);
+	int y1 = MIN_VC(d.blob.y + 3 * d.blob.height / 4 + m, height);
+	int w = x1 - x0, h = y1 - y0;
+	if ((w <= 2 * m + 2) || (h <= 2 * m))
+		return;
+
+	gray.resize((size_t)w * h);
+	edges.resize((size_t)w * h);
+	counts.assign((size_t)w, 0);
+	VCGray8 grayroi(gray.data(), w, h), edgesroi(edges.data(), w, h);
+
+	vc_kernel_rgb_to_gray(VCRGB8::from(levels[0].rgb).sub(x0, y0, w, h), grayroi);
+	canny.detect(grayroi, edgesroi, VC_BAND_EDGE_LOW, VC_BAND_EDGE_HIGH);
+
+	// Pixeis de contorno por coluna, nas linhas com resultado
+	for (int y = m; y < h - m; y++)
+	{
+		const unsigned char *e = edgesroi.row(y);
+		for (int x = m; x < w - m; x++)
+			counts[x] += (e[x] != 0);
+	}
+
+	// Um limite é uma sequência de colunas em que (com as vizinhas, para tolerar uma resistência
+	// ligeiramente inclinada) pelo menos metade das linhas tem contorno; fica o centro da sequência
+	const int rows = h - 2 * m;
+	int start = -1;
+	for (int x = m + 1; x <= w - m - 1; x++)
+	{
+		bool edge = (x < w - m - 1) && ((counts[x - 1] + counts[x] + counts[x + 1]) * 2 >= rows);
+
+		if (edge && (start < 0))
+			start = x;
+		else if (!edge && (start >= 0))
+		{
+			if (d.nboundaries < VC_MAX_BOUNDARIES)
+				d.boundary[d.nboundaries++] = x0 + (start + x - 1) / 2;
+			start = -1;
+		}
+	}
+}
@@ -0,0 +1,103 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//            PROCESSAMENTO DE UMA FRAME (DETEÇÃO)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <vector>
+
+extern "C"
+{
+#include "vc.h"
+}
+
+#include "vc_blobs.hpp"
+#include "vc_pool.hpp"
+#include "vc_track.hpp"
+
+#define VC_MAX_BOUNDARIES (2 * VC_MAX_BANDS + 2)
+// Níveis da pirâmide para a deteção: 0 = resolução do vídeo, 1 = metade
+#define VC_PIPELINE_LEVELS 2
+
+// Blob candidato a resistência e o resultado da descodificação das bandas
+struct VCDetection
+{
+	OVC blob;
+	RVC resistor;
+	int decoded; // 1 se as bandas formam um valor válido
+	int track;	 // Identificador da resistência ao longo das frames (VCTracker, a partir de 1)
+
+	// Limites das bandas pelos contornos (só com VCPipeline::set_band_edges(true)):
+	// colunas (x na imagem) dos contornos verticais no blob, da esquerda para a direita
+	int nboundaries;
+	int boundary[VC_MAX_BOUNDARIES];
+};
+
+// Caminho de processamento de main.cpp, sem descodificação do vídeo nem janela:
+// BGR -> RGB -> HSV -> segmentação -> etiquetagem -> informação dos blobs -> descodificação das bandas.
+// As imagens intermédias são criadas uma única vez para a resolução do vídeo.
+class VCPipeline
+{
+public:
+	VCPipeline(int width, int height, VCThreadPool &pool);
+	~VCPipeline();
+
+	VCPipeline(const VCPipeline &) = delete;
+	VCPipeline &operator=(const VCPipeline &) = delete;
+
+	// Processar uma frame BGR (3 canais, com a resolução do pipeline). A frame só é lida.
+	int process(const IVC *frame);
+
+	// Resultados da última frame processada
+	const std::vector<VCDetection> &detections() const { return results; }
+	// Esquecer os tracks (ex.: ao saltar para outra posição do vídeo)
+	void reset_tracks() { tracker.reset(); }
+
+	// Limites das bandas por contornos (Canny na metade central de cada blob): as bandas passam a
+	// ser os intervalos entre contornos (vc_filtro_resistencias_limites), com as transições de
+	// cor só quando os contornos não dão um valor válido. Só no nível 0.
+	void set_band_edges(bool enable) { bandedges = enable; }
+
+	// Modos mais rápidos (e menos exatos) para quando o processamento não acompanha o vídeo:
+	// deteção num nível da pirâmide (as caixas continuam na resolução do vídeo)
+	void set_level(int level);
+	int get_level() const { return level; }
+	// Deteção só em 1 de cada n frames; nas outras, as deteções são a previsão dos tracks
+	void set_detection_interval(int n) { interval = (n > 1) ? n : 1; }
+	int get_detection_interval() const { return interval; }
+
+	// Regras dos blobs candidatos a resistência, na resolução do vídeo (por omissão, largura
+	// > 100 e altura < 100). As regras da caixa e da área são avaliadas logo a seguir à
+	// etiquetagem: os blobs excluídos não passam por vc_binary_blob_info nem pela classificação.
+	void set_blob_filter(const VCBlobFilter &f);
+	const VCBlobFilter &get_blob_filter() const { return filter; }
+
+private:
+	// Imagens intermédias de um nível da pirâmide (criadas quando o nível é usado pela primeira vez)
+	struct Level
+	{
+		IVC *rgb;
+		IVC *hsv;
+		IVC *mask;
+		IVC *labels;
+	};
+
+	void band_edges(VCDetection &d) const;
+
+	int width, height;
+	VCThreadPool &pool;
+
+	Level levels[VC_PIPELINE_LEVELS] = {};
+	int level = 0;
+	int interval = 1;
+	unsigned int nframes = 0;
+
+	VCBlobFilter filter;
+	VCBlobPlan plans[VC_PIPELINE_LEVELS]; // O filtro compilado para cada nível da pirâmide
+	VCBlobTable table;
+	std::vector<int> candidates;
+
+	std::vector<VCDetection> results;
+	VCTracker tracker;
+	bool bandedges = false;
+};
@@ -0,0 +1,184 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//                  POOL DE THREADS DE TRABALHO
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include "vc_pool.hpp"
+
+// Pool e índice da thread atual (para as tarefas criadas dentro do pool irem para a fila da thread)
+static thread_local const VCThreadPool *current_pool = nullptr;
+static thread_local int current_index = -1;
+
+// Trabalho de um parallel_for(), partilhado pelas tarefas auxiliares: quem chega depois de todos
+// os índices estarem atribuídos só lê next
+struct VCParallelJob
+{
+	const std::function<void(int)> *fn;
+	int n;
+	std::atomic<int> next{0};
+	std::atomic<int> finished{0};
+	std::mutex mutex;
+	std::condition_variable done;
+};
+
+static void run_job(VCParallelJob &job)
+{
+	int i;
+
+	while ((i = job.next.fetch_add(1)) < job.n)
+	{
+		(*job.fn)(i);
+		if (job.finished.fetch_add(1) + 1 == job.n)
+		{
+			// Passar pelo mutex garante que quem espera já está em wait() ou ainda vai ver finished
+			{
+				std::lock_guard<std::mutex> lock(job.mutex);
+			}
+			job.done.notify_all();
+		}
+	}
+}
+
+VCThreadPool::VCThreadPool(unsigned int nthreads)
+{
+	if (nthreads == 0)
+		nthreads = std::thread::hardware_concurrency();
+	if (nthreads == 0)
+		nthreads = 1;
+
+	// A thread que chama parallel_for() conta como uma das threads do pool
+	for (unsigned int i = 0; i < nthreads; i++)
+		queues.emplace_back(new Queue);
+	for (unsigned int i = 1; i < nthreads; i++)
+		workers.emplace_back(&VCThreadPool::worker_loop, this, (int)i - 1);
+}
+
+VCThreadPool::~VCThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (std::thread &t : workers)
+		t.join();
+
+	// Sem threads auxiliares, as tarefas entregues com submit() correm aqui
+	std::function<void()> task;
+	while (pop((int)queues.size() - 1, task))
+		task();
+}
+
+void VCThreadPool::push(std::function<void()> task)
+{
+	// Dentro do pool, na fila da própria thread; de fora, na última fila
+	int index = (current_pool == this) ? current_index : (int)queues.size() - 1;
+	{
+		std::lock_guard<std::mutex> lock(queues[index]->mutex);
+		queues[index]->tasks.push_back(std::move(task));
+	}
+
+	pending.fetch_add(1);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+	}
+	wake.notify_one();
+}
+
+bool VCThreadPool::pop(int index, std::function<void()> &task)
+{
+	int nqueues = (int)queues.size();
+
+	for (int k = 0; k < nqueues; k++)
+	{
+		// k = 0: a própria fila (a tarefa mais recente, ainda na cache); depois as outras, a começar
+		// pela fila de fora
+		int q = (k == 0) ? index : (index + nqueues - k) % nqueues;
+		Queue &queue = *queues[q];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty())
+			continue;
+
+		if ((k == 0) && (index < (int)workers.size()))
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		}
+		else
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+		pending.fetch_sub(1);
+		return true;
+	}
+
+	return false;
+}
+
+void VCThreadPool::submit(std::function<void()> task)
+{
+	// Sem threads auxiliares não há quem a execute mais tarde
+	if (workers.empty())
+	{
+		task();
+		return;
+	}
+	push(std::move(task));
+}
+
+void VCThreadPool::parallel_for(int n, const std::function<void(int)> &fn)
+{
+	if (n <= 0)
+		return;
+
+	// Sem threads auxiliares ou com uma só tarefa não vale a pena acordar ninguém
+	if (workers.empty() || n == 1)
+	{
+		for (int i = 0; i < n; i++)
+			fn(i);
+		return;
+	}
+
+	std::shared_ptr<VCParallelJob> job = std::make_shared<VCParallelJob>();
+	job->fn = &fn;
+	job->n = n;
+
+	// Uma tarefa auxiliar por thread que possa ajudar; cada uma tira índices até não haver mais
+	int helpers = (n - 1 < (int)workers.size()) ? n - 1 : (int)workers.size();
+	for (int h = 0; h < helpers; h++)
+		push([job]
+			 { run_job(*job); });
+
+	run_job(*job);
+
+	// Esperar pelos índices que ainda estão a ser executados por outras threads (todos já foram
+	// atribuídos, por isso esperar aqui não impede nenhum de terminar)
+	std::unique_lock<std::mutex> lock(job->mutex);
+	job->done.wait(lock, [&]
+				   { return job->finished.load() == n; });
+}
+
+void VCThreadPool::worker_loop(int index)
+{
+	current_pool = this;
+	current_index = index;
+
+	std::function<void()> task;
+	for (;;)
+	{
+		if (pop(index, task))
+		{
+			task();
+			task = nullptr;
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex);
+		wake.wait(lock, [&]
+				  { return stopping || pending.load() > 0; });
+		// As tarefas em fila são executadas antes de terminar
+		if (stopping && (pending.load() == 0))
+			return;
+	}
+}
@@ -0,0 +1,62 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//                  POOL DE THREADS DE TRABALHO
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de threads fixo com roubo de trabalho: cada thread tem a sua fila de tarefas (executa as
+// suas pela ordem inversa e, sem trabalho, rouba as mais antigas das outras) e há uma fila para
+// as tarefas entregues por threads de fora do pool.
+// parallel_for() pode ser chamado de várias threads ao mesmo tempo e de dentro de tarefas do pool
+// (ex.: a classificação dos blobs dentro do processamento de uma frame de um de vários vídeos).
+class VCThreadPool
+{
+public:
+	// nthreads = 0 usa o número de núcleos disponíveis
+	explicit VCThreadPool(unsigned int nthreads = 0);
+	// Executa as tarefas ainda em fila e termina as threads
+	~VCThreadPool();
+
+	VCThreadPool(const VCThreadPool &) = delete;
+	VCThreadPool &operator=(const VCThreadPool &) = delete;
+
+	// Executa fn(i) para i em [0, n). A thread que chama também executa tarefas e só regressa
+	// quando todas terminam.
+	void parallel_for(int n, const std::function<void(int)> &fn);
+	// Executar task numa thread do pool (sem esperar)
+	void submit(std::function<void()> task);
+
+	unsigned int size() const { return (unsigned int)workers.size() + 1; }
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	void worker_loop(int index);
+	// Próxima tarefa para a thread index: da própria fila (a mais recente), da fila de fora ou
+	// roubada a outra thread (a mais antiga)
+	bool pop(int index, std::function<void()> &task);
+	void push(std::function<void()> task);
+
+	std::vector<std::thread> workers;
+	// Uma fila por thread do pool e, no fim, a fila das tarefas de fora
+	std::vector<std::unique_ptr<Queue>> queues;
+
+	// Tarefas em fila (para as threads sem trabalho saberem quando acordar)
+	std::atomic<int> pending{0};
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping = false;
+};
@@ -0,0 +1,202 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//          RESULTADOS DA DETEÇÃO EM FICHEIRO (POR FRAME)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <cstdarg>
+#include <cstring>
+
+#include "vc_results.hpp"
+
+static const char vc_results_magic[8] = {'V', 'C', 'R', 'E', 'S', 'U', 'L', 'T'};
+static const uint32_t vc_results_version = 1;
+
+static_assert(sizeof(VCResultRecord) == 64, "VCResultRecord tem de ter 64 bytes");
+
+// Acrescentar texto formatado ao buffer
+static void vc_results_printf(std::vector<char> &buffer, const char *format, ...)
+{
+	char line[256];
+	va_list args;
+
+	va_start(args, format);
+	int n = vsnprintf(line, sizeof(line), format, args);
+	va_end(args);
+	if (n > 0)
+		buffer.insert(buffer.end(), line, line + MIN_VC(n, (int)sizeof(line) - 1));
+}
+
+int VCResultsSink::format_from_name(const char *filename)
+{
+	size_t n = (filename != NULL) ? strlen(filename) : 0;
+
+	if ((n >= 4) && (strcmp(filename + n - 4, ".csv") == 0))
+		return VC_RESULTS_CSV;
+	if ((n >= 4) && (strcmp(filename + n - 4, ".bin") == 0))
+		return VC_RESULTS_BINARY;
+	return VC_RESULTS_JSONL;
+}
+
+bool VCResultsSink::open(const char *filename, int format, size_t maxbacklog)
+{
+	close();
+
+	if ((filename == NULL) || (format < VC_RESULTS_JSONL) || (format > VC_RESULTS_BINARY))
+	{
+		printf("VCResultsSink::open() - Erro nos parametros de entrada.\n");
+		return false;
+	}
+
+	file = (strcmp(filename, "-") == 0) ? stdout : fopen(filename, (format == VC_RESULTS_BINARY) ? "wb" : "w");
+	if (file == NULL)
+	{
+		printf("VCResultsSink::open() - Erro ao abrir o ficheiro %s\n", filename);
+		return false;
+	}
+
+	this->format = format;
+	this->maxbacklog = maxbacklog;
+	frames = records = dropped = bytes = 0;
+	failed = false;
+	stopping = false;
+	pending.clear();
+
+	// Cabeçalho (fica no buffer como o resto)
+	preamble(pending, format);
+
+	thread = std::thread(&VCResultsSink::writer_loop, this);
+
+	return true;
+}
+
+void VCResultsSink::preamble(std::vector<char> &buffer, int format)
+{
+	if (format == VC_RESULTS_CSV)
+		vc_results_printf(buffer, "frame,track,x,y,width,height,xc,yc,area,decoded,value,min,max\n");
+	else if (format == VC_RESULTS_BINARY)
+	{
+		uint32_t header[2] = {vc_results_version, (uint32_t)sizeof(VCResultRecord)};
+		buffer.insert(buffer.end(), vc_results_magic, vc_results_magic + sizeof(vc_results_magic));
+		buffer.insert(buffer.end(), (const char *)header, (const char *)header + sizeof(header));
+	}
+}
+
+void VCResultsSink::format_frame(std::vector<char> &buffer, int format, int nframe, const std::vector<VCDetection> &detections)
+{
+	if (format == VC_RESULTS_JSONL)
+		vc_results_printf(buffer, "{\"frame\":%d,\"blobs\":[", nframe);
+
+	for (size_t i = 0; i < detections.size(); i++)
+	{
+		const OVC &b = detections[i].blob;
+		const RVC &r = detections[i].resistor;
+		int decoded = detections[i].decoded;
+		// Limites como em vc_draw_resistance_value()
+		double value = decoded ? r.value : 0.0;
+		double min = decoded ? r.value * (1.0 - r.tolerance / 100.0) : 0.0;
+		double max = decoded ? r.value * (1.0 + r.tolerance / 100.0) : 0.0;
+
+		if (format == VC_RESULTS_JSONL)
+		{
+			vc_results_printf(buffer, "%s{\"track\":%d,\"x\":%d,\"y\":%d,\"width\":%d,\"height\":%d,\"xc\":%d,\"yc\":%d,\"area\":%d,",
+							  (i > 0) ? "," : "", detections[i].track, b.x, b.y, b.width, b.height, b.xc, b.yc, b.area);
+			if (decoded)
+				vc_results_printf(buffer, "\"decoded\":true,\"value\":%.10g,\"min\":%.10g,\"max\":%.10g}", value, min, max);
+			else
+				vc_results_printf(buffer, "\"decoded\":false,\"value\":null,\"min\":null,\"max\":null}");
+		}
+		else if (format == VC_RESULTS_CSV)
+		{
+			vc_results_printf(buffer, "%d,%d,%d,%d,%d,%d,%d,%d,%d,", nframe, detections[i].track, b.x, b.y, b.width, b.height, b.xc, b.yc, b.area);
+			if (decoded)
+				vc_results_printf(buffer, "1,%.10g,%.10g,%.10g\n", value, min, max);
+			else
+				vc_results_printf(buffer, "0,,,\n");
+		}
+		else
+		{
+			VCResultRecord record = {(uint32_t)nframe, detections[i].track, b.x, b.y, b.width, b.height,
+									 b.xc, b.yc, b.area, decoded, value, min, max};
+			buffer.insert(buffer.end(), (const char *)&record, (const char *)&record + sizeof(record));
+		}
+	}
+
+	if (format == VC_RESULTS_JSONL)
+		vc_results_printf(buffer, "]}\n");
+}
+
+void VCResultsSink::write(int nframe, const std::vector<VCDetection> &detections)
+{
+	if (!thread.joinable())
+		return;
+
+	// Formatação fora do lock
+	scratch.clear();
+	format_frame(scratch, format, nframe, detections);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		frames++;
+		if (pending.size() + scratch.size() > maxbacklog)
+		{
+			dropped++;
+			return;
+		}
+		pending.insert(pending.end(), scratch.begin(), scratch.end());
+		records += (long long)detections.size();
+	}
+	wake.notify_one();
+}
+
+void VCResultsSink::writer_loop()
+{
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this]
+					  { return !pending.empty() || stopping; });
+			if (pending.empty())
+				break;
+			// O buffer cheio passa para esta thread; o vazio volta para write()
+			writing.swap(pending);
+		}
+
+		size_t n = fwrite(writing.data(), 1, writing.size(), file);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			bytes += (long long)n;
+			if (n != writing.size())
+				failed = true;
+		}
+		writing.clear();
+	}
+
+	fflush(file);
+}
+
+void VCResultsSink::close()
+{
+	if (!thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	thread.join();
+
+	if (file != stdout)
+		fclose(file);
+	file = nullptr;
+	if (failed)
+		printf("VCResultsSink::close() - Erro ao escrever os resultados.\n");
+}
+
+void VCResultsSink::report(FILE *out) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	fprintf(out, "results: %lld frames, %lld records, %lld bytes, %lld frames dropped\n", frames, records, bytes, dropped);
+	fflush(out);
+}
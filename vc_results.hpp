@@ -0,0 +1,85 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//          RESULTADOS DA DETEÇÃO EM FICHEIRO (POR FRAME)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "vc_pipeline.hpp"
+
+// Formatos dos resultados
+#define VC_RESULTS_JSONL 0	// Uma linha JSON por frame: {"frame":N,"blobs":[{...},...]}
+#define VC_RESULTS_CSV 1	// Uma linha por blob, com cabeçalho
+#define VC_RESULTS_BINARY 2 // Cabeçalho de 16 bytes e um VCResultRecord (64 bytes) por blob
+
+// Registo do formato binário (little-endian). Sem descodificação: decoded = 0 e valores a 0.
+struct VCResultRecord
+{
+	uint32_t frame;
+	int32_t track;
+	int32_t x, y, width, height;
+	int32_t xc, yc;
+	int32_t area;
+	int32_t decoded;
+	double value; // Ohms
+	double min, max; // Limites pela tolerância
+};
+
+// Resultados de cada frame (caixa, centro de massa, área, valor e limites pela tolerância de cada
+// blob, e o track) para processamento a jusante. write() formata na thread que chama e só junta o
+// texto a um buffer; uma thread própria escreve o buffer no ficheiro. Se a escrita não acompanhar
+// e o buffer passar de maxbacklog bytes, as frames seguintes são descartadas (e contadas) em vez
+// de fazerem esperar o ciclo.
+class VCResultsSink
+{
+public:
+	VCResultsSink() = default;
+	~VCResultsSink() { close(); }
+
+	VCResultsSink(const VCResultsSink &) = delete;
+	VCResultsSink &operator=(const VCResultsSink &) = delete;
+
+	// filename "-" escreve para stdout
+	bool open(const char *filename, int format, size_t maxbacklog = (size_t)64 << 20);
+	void write(int nframe, const std::vector<VCDetection> &detections);
+	// Escrever o que falta e fechar o ficheiro
+	void close();
+
+	bool is_open() const { return thread.joinable(); }
+	// Formato pela extensão: .csv, .bin; qualquer outra é JSON Lines
+	static int format_from_name(const char *filename);
+	// Cabeçalho do formato (CSV e binário) e texto/registos de uma frame, acrescentados a buffer
+	// (usados também por VCResultsServer)
+	static void preamble(std::vector<char> &buffer, int format);
+	static void format_frame(std::vector<char> &buffer, int format, int nframe, const std::vector<VCDetection> &detections);
+	// Uma linha com frames, registos, bytes e descartes
+	void report(FILE *file) const;
+
+private:
+	void writer_loop();
+
+	FILE *file = nullptr;
+	int format = VC_RESULTS_JSONL;
+	size_t maxbacklog = 0;
+
+	// Texto da frame atual (thread de quem chama write())
+	std::vector<char> scratch;
+	// Texto à espera da thread de escrita e texto a ser escrito (trocados sob o lock)
+	std::vector<char> pending;
+	std::vector<char> writing;
+	bool stopping = false;
+
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	std::thread thread;
+
+	long long frames = 0, records = 0, dropped = 0;
+	long long bytes = 0;
+	bool failed = false;
+};
@@ -0,0 +1,342 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//       SERVIDOR LOCAL DOS RESULTADOS (SOCKET UNIX / TCP)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include "vc_server.hpp"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Identificadores do socket de escuta e do eventfd nos eventos do epoll (os clientes usam o fd)
+#define VC_SERVER_LISTEN -1
+#define VC_SERVER_WAKE -2
+
+// Acordar a thread do servidor (o write só falha com o contador do eventfd no máximo, ou seja,
+// com avisos ainda por ler)
+static void vc_server_wake(int wakefd)
+{
+	uint64_t one = 1;
+	ssize_t n = write(wakefd, &one, sizeof(one));
+	(void)n;
+}
+
+bool VCResultsServer::open(const char *address, int format)
+{
+	close();
+
+	if ((address == NULL) || (format < VC_RESULTS_JSONL) || (format > VC_RESULTS_BINARY))
+	{
+		printf("VCResultsServer::open() - Erro nos parametros de entrada.\n");
+		return false;
+	}
+
+	if (strncmp(address, "tcp:", 4) == 0)
+	{
+		struct sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = htons((uint16_t)atoi(address + 4));
+
+		listenfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		int one = 1;
+		if ((listenfd < 0) || (setsockopt(listenfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0) ||
+			(bind(listenfd, (struct sockaddr *)&addr, sizeof(addr)) != 0))
+		{
+			printf("VCResultsServer::open() - Erro ao abrir a porta %s: %s\n", address + 4, strerror(errno));
+			close();
+			return false;
+		}
+		socklen_t len = sizeof(addr);
+		getsockname(listenfd, (struct sockaddr *)&addr, &len);
+		tcpport = ntohs(addr.sin_port);
+	}
+	else
+	{
+		struct sockaddr_un addr = {};
+		addr.sun_family = AF_UNIX;
+		if (strlen(address) >= sizeof(addr.sun_path))
+		{
+			printf("VCResultsServer::open() - Caminho do socket demasiado longo: %s\n", address);
+			return false;
+		}
+		strcpy(addr.sun_path, address);
+
+		// Um socket deixado por uma execução anterior impede o bind
+		unlink(address);
+		listenfd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if ((listenfd < 0) || (bind(listenfd, (struct sockaddr *)&addr, sizeof(addr)) != 0))
+		{
+			printf("VCResultsServer::open() - Erro ao abrir o socket %s: %s\n", address, strerror(errno));
+			close();
+			return false;
+		}
+		unixpath = address;
+	}
+
+	epollfd = epoll_create1(EPOLL_CLOEXEC);
+	wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if ((listen(listenfd, 16) != 0) || (epollfd < 0) || (wakefd < 0))
+	{
+		printf("VCResultsServer::open() - Erro ao iniciar o servidor: %s\n", strerror(errno));
+		close();
+		return false;
+	}
+
+	struct epoll_event ev = {};
+	ev.events = EPOLLIN;
+	ev.data.fd = VC_SERVER_LISTEN;
+	epoll_ctl(epollfd, EPOLL_CTL_ADD, listenfd, &ev);
+	ev.data.fd = VC_SERVER_WAKE;
+	epoll_ctl(epollfd, EPOLL_CTL_ADD, wakefd, &ev);
+
+	this->format = format;
+	std::vector<char> preamble;
+	VCResultsSink::preamble(preamble, format);
+	header = preamble.empty() ? nullptr : std::make_shared<const std::vector<char>>(std::move(preamble));
+	accepted = frames = dropped = sentbytes = 0;
+	stopping = false;
+
+	thread = std::thread(&VCResultsServer::server_loop, this);
+
+	return true;
+}
+
+void VCResultsServer::publish(int nframe, const std::vector<VCDetection> &detections)
+{
+	if (!thread.joinable())
+		return;
+
+	// Formatação fora do lock; a mensagem é partilhada por todas as filas
+	scratch.clear();
+	VCResultsSink::format_frame(scratch, format, nframe, detections);
+	if (scratch.empty())
+		return;
+	Message message = std::make_shared<const std::vector<char>>(scratch);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		frames++;
+		for (auto &c : clients)
+		{
+			if ((int)c.second.queue.size() >= maxqueue)
+				dropped++;
+			else
+				c.second.queue.push_back(message);
+		}
+	}
+
+	vc_server_wake(wakefd);
+}
+
+void VCResultsServer::accept_clients()
+{
+	for (;;)
+	{
+		int fd = accept4(listenfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0)
+			return;
+
+		struct epoll_event ev = {};
+		ev.events = EPOLLIN | EPOLLRDHUP;
+		ev.data.fd = fd;
+		epoll_ctl(epollfd, EPOLL_CTL_ADD, fd, &ev);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		Client &client = clients[fd];
+		// O cabeçalho não conta para o limite da fila
+		if (header)
+			client.queue.push_back(header);
+		accepted++;
+		if (!flush(fd, client))
+			drop_client(fd);
+	}
+}
+
+bool VCResultsServer::flush(int fd, Client &client)
+{
+	while (!client.queue.empty())
+	{
+		const std::vector<char> &message = *client.queue.front();
+		ssize_t n = send(fd, message.data() + client.offset, message.size() - client.offset, MSG_NOSIGNAL);
+		if (n < 0)
+		{
+			if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+				return false;
+
+			// Socket cheio: continuar quando o cliente ler
+			if (!client.waitwrite)
+			{
+				struct epoll_event ev = {};
+				ev.events = EPOLLIN | EPOLLRDHUP | EPOLLOUT;
+				ev.data.fd = fd;
+				epoll_ctl(epollfd, EPOLL_CTL_MOD, fd, &ev);
+				client.waitwrite = true;
+			}
+			return true;
+		}
+
+		sentbytes += n;
+		client.offset += (size_t)n;
+		if (client.offset == message.size())
+		{
+			client.queue.pop_front();
+			client.offset = 0;
+		}
+	}
+
+	if (client.waitwrite)
+	{
+		struct epoll_event ev = {};
+		ev.events = EPOLLIN | EPOLLRDHUP;
+		ev.data.fd = fd;
+		epoll_ctl(epollfd, EPOLL_CTL_MOD, fd, &ev);
+		client.waitwrite = false;
+	}
+	return true;
+}
+
+// Chamada com o mutex
+void VCResultsServer::drop_client(int fd)
+{
+	epoll_ctl(epollfd, EPOLL_CTL_DEL, fd, NULL);
+	::close(fd);
+	clients.erase(fd);
+}
+
+void VCResultsServer::server_loop()
+{
+	struct epoll_event events[64];
+
+	while (!stopping.load())
+	{
+		int n = epoll_wait(epollfd, events, 64, -1);
+		if ((n < 0) && (errno != EINTR))
+			break;
+
+		for (int i = 0; i < n; i++)
+		{
+			int fd = events[i].data.fd;
+
+			if (fd == VC_SERVER_LISTEN)
+				accept_clients();
+			else if (fd == VC_SERVER_WAKE)
+			{
+				// Frames novas: enviar a todos os subscritores (o read só limpa o contador)
+				uint64_t count;
+				ssize_t r = read(wakefd, &count, sizeof(count));
+				(void)r;
+				std::lock_guard<std::mutex> lock(mutex);
+				for (auto it = clients.begin(); it != clients.end();)
+				{
+					int cfd = it->first;
+					Client &client = (it++)->second;
+					if (!flush(cfd, client))
+						drop_client(cfd);
+				}
+			}
+			else
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				auto it = clients.find(fd);
+				if (it == clients.end())
+					continue;
+
+				bool alive = (events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) == 0;
+				// Os subscritores não enviam nada: o que chegar é descartado
+				if (alive && (events[i].events & EPOLLIN))
+				{
+					char discard[256];
+					ssize_t r;
+					while ((r = recv(fd, discard, sizeof(discard), 0)) > 0)
+						;
+					alive = (r < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK));
+				}
+				if (alive && (events[i].events & EPOLLOUT))
+					alive = flush(fd, it->second);
+				if (!alive)
+					drop_client(fd);
+			}
+		}
+	}
+}
+
+void VCResultsServer::close()
+{
+	if (thread.joinable())
+	{
+		stopping = true;
+		vc_server_wake(wakefd);
+		thread.join();
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto &c : clients)
+		::close(c.first);
+	clients.clear();
+	if (listenfd >= 0)
+		::close(listenfd);
+	if (epollfd >= 0)
+		::close(epollfd);
+	if (wakefd >= 0)
+		::close(wakefd);
+	listenfd = epollfd = wakefd = -1;
+	if (!unixpath.empty())
+		unlink(unixpath.c_str());
+	unixpath.clear();
+	tcpport = 0;
+}
+
+#else
+
+bool VCResultsServer::open(const char *address, int format)
+{
+	(void)address;
+	(void)format;
+	printf("VCResultsServer::open() - O servidor de resultados só existe em Linux.\n");
+	return false;
+}
+
+void VCResultsServer::publish(int nframe, const std::vector<VCDetection> &detections)
+{
+	(void)nframe;
+	(void)detections;
+}
+
+void VCResultsServer::close()
+{
+}
+
+#endif
+
+VCServerStats VCResultsServer::stats() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	VCServerStats s;
+
+	s.clients = (int)clients.size();
+	s.accepted = accepted;
+	s.frames = frames;
+	s.dropped = dropped;
+	s.sentbytes = sentbytes;
+
+	return s;
+}
+
+void VCResultsServer::report(FILE *file) const
+{
+	VCServerStats s = stats();
+
+	fprintf(file, "server: %lld frames, %d clients (%lld accepted), %lld bytes sent, %lld frames dropped\n",
+			s.frames, s.clients, s.accepted, s.sentbytes, s.dropped);
+	fflush(file);
+}
@@ -0,0 +1,92 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//       SERVIDOR LOCAL DOS RESULTADOS (SOCKET UNIX / TCP)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "vc_results.hpp"
+
+// Contadores do servidor
+struct VCServerStats
+{
+	int clients;		 // Subscritores ligados
+	long long accepted;	 // Ligações aceites desde open()
+	long long frames;	 // Frames publicadas
+	long long dropped;	 // Frames não entregues a um subscritor (fila cheia), somadas em todos
+	long long sentbytes; // Bytes enviados, somados em todos
+};
+
+// Envio dos resultados de cada frame (nos formatos de VCResultsSink) a qualquer número de
+// subscritores ligados a um socket Unix ou a uma porta TCP em 127.0.0.1. Uma thread própria aceita
+// as ligações e escreve nos sockets (não bloqueantes, com epoll). Cada subscritor tem uma fila de
+// no máximo maxqueue frames: com a fila cheia, as frames novas não lhe são entregues (as frames
+// têm número, por isso as falhas são visíveis do lado do cliente) e o ciclo de deteção nunca espera.
+// Só em Linux; nos outros sistemas open() falha.
+class VCResultsServer
+{
+public:
+	explicit VCResultsServer(int maxqueue = 64) : maxqueue(maxqueue > 0 ? maxqueue : 1) {}
+	~VCResultsServer() { close(); }
+
+	VCResultsServer(const VCResultsServer &) = delete;
+	VCResultsServer &operator=(const VCResultsServer &) = delete;
+
+	// address: "tcp:PORTA" (PORTA 0 escolhe uma porta livre, ver port()) ou o caminho do socket Unix
+	bool open(const char *address, int format);
+	// Pôr os resultados de uma frame na fila de cada subscritor
+	void publish(int nframe, const std::vector<VCDetection> &detections);
+	// Desligar os subscritores (sem esperar pelas filas) e fechar o socket
+	void close();
+
+	bool is_open() const { return thread.joinable(); }
+	// Porta TCP em escuta (0 num socket Unix)
+	int port() const { return tcpport; }
+	VCServerStats stats() const;
+	// Uma linha com os contadores
+	void report(FILE *file) const;
+
+private:
+	typedef std::shared_ptr<const std::vector<char>> Message;
+
+	struct Client
+	{
+		std::deque<Message> queue;
+		size_t offset = 0;		// Bytes já enviados de queue.front()
+		bool waitwrite = false; // À espera de EPOLLOUT
+	};
+
+	void server_loop();
+	void accept_clients();
+	// Enviar o que o socket aceitar; false se o cliente tem de ser desligado
+	bool flush(int fd, Client &client);
+	void drop_client(int fd);
+
+	int maxqueue;
+	int format = VC_RESULTS_JSONL;
+	int listenfd = -1, epollfd = -1, wakefd = -1;
+	int tcpport = 0;
+	std::string unixpath;
+
+	// Cabeçalho do formato, enviado a cada subscritor ao ligar
+	Message header;
+	// Texto da frame atual (thread de quem chama publish())
+	std::vector<char> scratch;
+
+	// Subscritores por descritor (protegidos por mutex)
+	std::unordered_map<int, Client> clients;
+	mutable std::mutex mutex;
+	std::atomic<bool> stopping{false};
+	std::thread thread;
+
+	long long accepted = 0, frames = 0, dropped = 0, sentbytes = 0;
+};
@@ -0,0 +1,272 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//        TESTE DO SERVIDOR DE RESULTADOS (CLIENTE LOCAL)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   vc_server_test                                  teste automático (ctest): um subscritor rápido
+//                                                   recebe todas as frames, um parado não atrasa quem
+//                                                   publica; socket Unix em JSON Lines e TCP em binário
+//   vc_server_test subscribe <endereço> [--stall]   cliente de substituição: escreve o que recebe de
+//                                                   VC_Project --serve (--stall liga-se e não lê)
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "vc_server.hpp"
+#include "vc_stage.h"
+#include "vc_test.h"
+
+// Ligar a "tcp:PORTA" (127.0.0.1) ou a um socket Unix; rcvbuf > 0 reduz o buffer de receção
+static int connect_to(const char *address, int rcvbuf = 0)
+{
+	int fd;
+
+	if (strncmp(address, "tcp:", 4) == 0)
+	{
+		struct sockaddr_in addr = {};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = htons((uint16_t)atoi(address + 4));
+		fd = socket(AF_INET, SOCK_STREAM, 0);
+		if (rcvbuf > 0)
+			setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+		if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+		{
+			close(fd);
+			return -1;
+		}
+	}
+	else
+	{
+		struct sockaddr_un addr = {};
+		addr.sun_family = AF_UNIX;
+		strncpy(addr.sun_path, address, sizeof(addr.sun_path) - 1);
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (rcvbuf > 0)
+			setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+		if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+		{
+			close(fd);
+			return -1;
+		}
+	}
+
+	return fd;
+}
+
+// Cliente que lê tudo até o servidor fechar a ligação
+struct VCTestClient
+{
+	int fd = -1;
+	std::thread thread;
+	std::mutex mutex;
+	std::string received;
+
+	bool start(const char *address)
+	{
+		fd = connect_to(address);
+		if (fd < 0)
+			return false;
+		thread = std::thread([this]
+							 {
+								 char buffer[65536];
+								 ssize_t n;
+								 while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+								 {
+									 std::lock_guard<std::mutex> lock(mutex);
+									 received.append(buffer, (size_t)n);
+								 } });
+		return true;
+	}
+
+	size_t lines()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		size_t n = 0;
+		for (char c : received)
+			n += (c == '\n');
+		return n;
+	}
+
+	void join()
+	{
+		if (thread.joinable())
+			thread.join();
+		if (fd >= 0)
+			close(fd);
+		fd = -1;
+	}
+};
+
+// Esperar até cond() ser verdadeira (no máximo ms milissegundos)
+template <typename Cond>
+static bool wait_for(Cond cond, int ms)
+{
+	for (int i = 0; i < ms; i++)
+	{
+		if (cond())
+			return true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return cond();
+}
+
+static std::vector<VCDetection> test_detections(int n)
+{
+	std::vector<VCDetection> detections(n);
+	for (int i = 0; i < n; i++)
+	{
+		VCDetection &d = detections[i];
+		d.blob.x = 40 + 80 * i;
+		d.blob.y = 300;
+		d.blob.width = 150;
+		d.blob.height = 55;
+		d.blob.area = 3800 + i;
+		d.track = i + 1;
+		d.decoded = 1;
+		d.resistor.value = 1000.0 * (i + 1);
+		d.resistor.tolerance = 5.0f;
+	}
+	return detections;
+}
+
+// Socket Unix, JSON Lines: um subscritor rápido e um parado
+static bool test_slow_consumer(void)
+{
+	const int nframes = 3000;
+	std::string path = "/tmp/vc_server_test_" + std::to_string(getpid()) + ".sock";
+
+	VCResultsServer server(16);
+	CHECK(server.open(path.c_str(), VC_RESULTS_JSONL), "abrir o socket Unix");
+
+	VCTestClient fast;
+	CHECK(fast.start(path.c_str()), "ligar o subscritor rápido");
+	// O parado tem um buffer de receção mínimo e nunca lê
+	int stalled = connect_to(path.c_str(), 4096);
+	CHECK(stalled >= 0, "ligar o subscritor parado");
+	CHECK(wait_for([&]
+				   { return server.stats().clients == 2; },
+				   2000),
+		  "o servidor não aceitou os dois subscritores");
+
+	std::vector<VCDetection> detections = test_detections(8);
+	unsigned long long maxpublish = 0;
+	for (int f = 0; f < nframes; f++)
+	{
+		unsigned long long t0 = vc_stage_now();
+		server.publish(f, detections);
+		unsigned long long dt = vc_stage_now() - t0;
+		if (dt > maxpublish)
+			maxpublish = dt;
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+
+	CHECK(wait_for([&]
+				   { return fast.lines() == (size_t)nframes; },
+				   5000),
+		  "o subscritor rápido recebeu " << fast.lines() << " de " << nframes << " frames");
+	VCServerStats s = server.stats();
+	CHECK(s.dropped > 0, "o subscritor parado não perdeu frames");
+	CHECK(s.dropped < nframes, "o subscritor parado não recebeu nenhuma frame");
+
+	server.close();
+	fast.join();
+	close(stalled);
+
+	// Frames completas e pela ordem
+	size_t pos = 0;
+	for (int f = 0; f < nframes; f++)
+	{
+		std::string prefix = "{\"frame\":" + std::to_string(f) + ",";
+		CHECK(fast.received.compare(pos, prefix.size(), prefix) == 0, "frame " << f << " fora de ordem");
+		pos = fast.received.find('\n', pos) + 1;
+	}
+
+	printf("slow consumer: %d frames, parado perdeu %lld, publish max %.1f us\n", nframes, s.dropped, maxpublish / 1000.0);
+	return true;
+}
+
+// TCP, binário: cabeçalho seguido dos registos
+static bool test_tcp_binary(void)
+{
+	VCResultsServer server(64);
+	CHECK(server.open("tcp:0", VC_RESULTS_BINARY), "abrir a porta TCP");
+	std::string address = "tcp:" + std::to_string(server.port());
+
+	VCTestClient client;
+	CHECK(client.start(address.c_str()), "ligar a " << address);
+	CHECK(wait_for([&]
+				   { return server.stats().clients == 1; },
+				   2000),
+		  "o servidor não aceitou o subscritor");
+
+	std::vector<VCDetection> detections = test_detections(2);
+	for (int f = 0; f < 10; f++)
+		server.publish(f, detections);
+	size_t expected = 16 + 20 * sizeof(VCResultRecord);
+	CHECK(wait_for([&]
+				   { std::lock_guard<std::mutex> lock(client.mutex); return client.received.size() == expected; },
+				   2000),
+		  "recebidos " << client.received.size() << " de " << expected << " bytes");
+	int port = server.port();
+	server.close();
+	client.join();
+
+	CHECK(client.received.compare(0, 8, "VCRESULT") == 0, "cabeçalho binário");
+	for (int r = 0; r < 20; r++)
+	{
+		VCResultRecord record;
+		memcpy(&record, client.received.data() + 16 + r * sizeof(record), sizeof(record));
+		CHECK((record.frame == (uint32_t)(r / 2)) && (record.track == r % 2 + 1) && (record.value == 1000.0 * (r % 2 + 1)),
+			  "registo " << r);
+	}
+
+	printf("tcp binary: porta %d, 20 registos\n", port);
+	return true;
+}
+
+// Cliente de substituição: escrever o que chega (ou ficar parado)
+static int subscribe(const char *address, bool stall)
+{
+	int fd = connect_to(address, stall ? 4096 : 0);
+	if (fd < 0)
+	{
+		std::cerr << "Erro ao ligar a " << address << "!\n";
+		return 1;
+	}
+
+	char buffer[65536];
+	ssize_t n;
+	if (stall)
+		pause();
+	while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+		fwrite(buffer, 1, (size_t)n, stdout);
+	close(fd);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if ((argc >= 3) && (strcmp(argv[1], "subscribe") == 0))
+		return subscribe(argv[2], (argc >= 4) && (strcmp(argv[3], "--stall") == 0));
+	if (argc != 1)
+	{
+		std::cerr << "Uso: " << argv[0] << " [subscribe <endereço> [--stall]]\n";
+		return 2;
+	}
+
+	return vc_test_run({test_slow_consumer, test_tcp_binary});
+}
@@ -0,0 +1,80 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//              ORIGEM DAS FRAMES (VÍDEO OU SEQUÊNCIA)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <cstring>
+#include <iostream>
+
+#include "vc_source.hpp"
+
+bool VCVideoSource::open(const char *input, int apiPreference)
+{
+	if (raw.open(input))
+	{
+		if (raw.channels() != 3)
+		{
+			std::cerr << "Erro: a sequência de frames não é BGR!\n";
+			return false;
+		}
+		width = raw.width();
+		height = raw.height();
+		ntotalframes = raw.count();
+		fps = (int)raw.fps();
+		return true;
+	}
+
+	capture.open(input, apiPreference);
+	if (!capture.isOpened())
+		return false;
+	width = (int)capture.get(cv::CAP_PROP_FRAME_WIDTH);
+	height = (int)capture.get(cv::CAP_PROP_FRAME_HEIGHT);
+	ntotalframes = (int)capture.get(cv::CAP_PROP_FRAME_COUNT);
+	fps = (int)capture.get(cv::CAP_PROP_FPS);
+	return true;
+}
+
+bool VCVideoSource::read(IVC *image, bool writable)
+{
+	if (raw.is_open())
+	{
+		if ((position >= raw.count()) || !raw.frame(position, image))
+			return false;
+		if (writable)
+		{
+			frame.create(height, width, CV_8UC3);
+			memcpy(frame.data, image->data, (size_t)image->bytesperline * height);
+			image->data = frame.data;
+		}
+	}
+	else
+	{
+		if (!capture.read(frame) || frame.empty())
+			return false;
+		*image = {frame.data, width, height, 3, 255, width * 3};
+	}
+	position++;
+
+	if (record.is_open())
+		record.write(image);
+	return true;
+}
+
+bool VCVideoSource::skip()
+{
+	if (record.is_open())
+	{
+		IVC image;
+		return read(&image, false);
+	}
+
+	if (raw.is_open())
+	{
+		if (position >= raw.count())
+			return false;
+	}
+	else if (!capture.grab())
+		return false;
+	position++;
+
+	return true;
+}
@@ -0,0 +1,31 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//              ORIGEM DAS FRAMES (VÍDEO OU SEQUÊNCIA)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include "vc_frames.hpp"
+
+// Origem das frames: uma sequência de frames em bruto (vc_frames.hpp, sem descodificação) ou um
+// vídeo lido pelo OpenCV. Com record aberto, cada frame lida é também gravada (antes das anotações).
+struct VCVideoSource
+{
+	VCFrameReader raw;
+	cv::VideoCapture capture;
+	cv::Mat frame;
+	VCFrameWriter record;
+	int width = 0, height = 0;
+	int ntotalframes = 0;
+	int fps = 0;
+	int position = 0; // Número de frames lidas
+
+	bool open(const char *input, int apiPreference);
+	// Próxima frame BGR em image. writable: a frame vai ser alterada, por isso as frames de uma
+	// sequência em bruto são copiadas para frame; sem writable apontam para o ficheiro mapeado.
+	bool read(IVC *image, bool writable);
+	// Saltar a próxima frame: num vídeo é descodificada mas não convertida para BGR (grab sem
+	// retrieve). Com record aberto é lida, para a sequência gravada ficar completa.
+	bool skip();
+};
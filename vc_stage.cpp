@@ -0,0 +1,138 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//            MEDIÇÃO DA LATÊNCIA DE CADA ETAPA
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <atomic>
+#include <chrono>
+
+#include "vc_stage.h"
+#include "vc_trace.h"
+
+// Histograma log-linear (estilo HDR): os valores até 63 ns têm um balde cada; acima disso,
+// cada potência de 2 é dividida em 32 baldes, o que dá um erro relativo inferior a 3%.
+#define VC_STAGE_SUBBITS 5
+#define VC_STAGE_SUBBUCKETS (1 << VC_STAGE_SUBBITS)
+#define VC_STAGE_BUCKETS ((64 - VC_STAGE_SUBBITS) * VC_STAGE_SUBBUCKETS)
+
+struct VCStageHistogram
+{
+	std::atomic<unsigned long long> buckets[VC_STAGE_BUCKETS];
+	std::atomic<unsigned long long> count;
+	std::atomic<unsigned long long> sum;
+	std::atomic<unsigned long long> max;
+};
+
+static VCStageHistogram histograms[VC_NSTAGES];
+
+static const char *stage_names[VC_NSTAGES] = {"decode", "convert", "segmentation", "labelling", "blob info", "classification", "overlay", "display", "output", "frame", "encode"};
+
+static int bucket_index(unsigned long long ns)
+{
+	if (ns < 2 * VC_STAGE_SUBBUCKETS)
+		return (int)ns;
+
+	// Deslocamento que deixa o valor em [32, 63]
+	int shift = 63 - __builtin_clzll(ns) - VC_STAGE_SUBBITS;
+	return VC_STAGE_SUBBUCKETS * shift + (int)(ns >> shift);
+}
+
+// Maior valor que cai no balde
+static unsigned long long bucket_value(int index)
+{
+	int shift = index / VC_STAGE_SUBBUCKETS - 1;
+
+	if (shift <= 0)
+		return (unsigned long long)index;
+
+	return ((unsigned long long)(index - VC_STAGE_SUBBUCKETS * shift) << shift) + (1ULL << shift) - 1;
+}
+
+extern "C" unsigned long long vc_stage_now(void)
+{
+	return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+extern "C" void vc_stage_record(int stage, unsigned long long ns)
+{
+	if ((stage < 0) || (stage >= VC_NSTAGES))
+		return;
+
+	VCStageHistogram &h = histograms[stage];
+	h.buckets[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+	h.count.fetch_add(1, std::memory_order_relaxed);
+	h.sum.fetch_add(ns, std::memory_order_relaxed);
+
+	unsigned long long max = h.max.load(std::memory_order_relaxed);
+	while ((ns > max) && !h.max.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+		;
+
+#ifndef VC_NO_TRACE
+	// Cada etapa medida também fica no registo de eventos, se estiver ativo
+	if (vc_trace_active.load(std::memory_order_relaxed))
+		vc_trace_complete(stage_names[stage], vc_stage_now() - ns, ns);
+#endif
+}
+
+extern "C" unsigned long long vc_stage_percentile(int stage, double percentile)
+{
+	if ((stage < 0) || (stage >= VC_NSTAGES))
+		return 0;
+
+	VCStageHistogram &h = histograms[stage];
+	unsigned long long count = h.count.load(std::memory_order_relaxed);
+	if (count == 0)
+		return 0;
+
+	// Número de amostras que têm de ficar abaixo do percentil (pelo menos uma)
+	unsigned long long target = (unsigned long long)(percentile / 100.0 * (double)count + 0.5);
+	if (target < 1)
+		target = 1;
+
+	unsigned long long seen = 0;
+	for (int i = 0; i < VC_STAGE_BUCKETS; i++)
+	{
+		seen += h.buckets[i].load(std::memory_order_relaxed);
+		if (seen >= target)
+		{
+			// O valor do balde nunca ultrapassa o máximo observado
+			unsigned long long value = bucket_value(i);
+			unsigned long long max = h.max.load(std::memory_order_relaxed);
+			return (value < max) ? value : max;
+		}
+	}
+
+	return h.max.load(std::memory_order_relaxed);
+}
+
+extern "C" void vc_stage_report(FILE *file)
+{
+	fprintf(file, "%-16s %10s %10s %10s %10s %10s %10s\n", "stage (us)", "count", "mean", "p50", "p95", "p99", "max");
+
+	for (int s = 0; s < VC_NSTAGES; s++)
+	{
+		unsigned long long count = histograms[s].count.load(std::memory_order_relaxed);
+		if (count == 0)
+			continue;
+
+		fprintf(file, "%-16s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f\n", stage_names[s], count,
+				(double)histograms[s].sum.load(std::memory_order_relaxed) / (double)count / 1000.0,
+				vc_stage_percentile(s, 50.0) / 1000.0,
+				vc_stage_percentile(s, 95.0) / 1000.0,
+				vc_stage_percentile(s, 99.0) / 1000.0,
+				histograms[s].max.load(std::memory_order_relaxed) / 1000.0);
+	}
+
+	fflush(file);
+}
+
+extern "C" void vc_stage_reset(void)
+{
+	for (int s = 0; s < VC_NSTAGES; s++)
+	{
+		for (int i = 0; i < VC_STAGE_BUCKETS; i++)
+			histograms[s].buckets[i].store(0, std::memory_order_relaxed);
+		histograms[s].count.store(0, std::memory_order_relaxed);
+		histograms[s].sum.store(0, std::memory_order_relaxed);
+		histograms[s].max.store(0, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,71 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//            MEDIÇÃO DA LATÊNCIA DE CADA ETAPA
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#ifndef VC_STAGE_H
+#define VC_STAGE_H
+
+#include <stdio.h>
+
+// Etapas do processamento de uma frame
+#define VC_STAGE_DECODE 0
+#define VC_STAGE_CONVERT 1
+#define VC_STAGE_SEGMENTATION 2
+#define VC_STAGE_LABELLING 3
+#define VC_STAGE_BLOBINFO 4
+#define VC_STAGE_CLASSIFICATION 5
+#define VC_STAGE_OVERLAY 6
+#define VC_STAGE_DISPLAY 7
+#define VC_STAGE_OUTPUT 8 // Cópia da frame anotada para a fila de gravação
+#define VC_STAGE_FRAME 9 // Frame completa
+#define VC_STAGE_ENCODE 10 // Escrita de uma frame anotada (na thread de gravação, fora da frame)
+#define VC_NSTAGES 11
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	// Relógio monotónico em nanossegundos
+	unsigned long long vc_stage_now(void);
+	// Registar a duração (em nanossegundos) de uma execução de uma etapa (pode ser chamada de várias threads)
+	void vc_stage_record(int stage, unsigned long long ns);
+	// Escrever a tabela com contagem, média, p50, p95, p99 e máximo de cada etapa (em microssegundos)
+	void vc_stage_report(FILE *file);
+	// Esvaziar os histogramas
+	void vc_stage_reset(void);
+	// Percentil (0-100) de uma etapa em nanossegundos
+	unsigned long long vc_stage_percentile(int stage, double percentile);
+
+#ifdef __cplusplus
+}
+#endif
+
+// Macros para medir uma etapa dentro de uma função (VC_STAGE_BEGIN e VC_STAGE_END no mesmo bloco).
+// Compilar com VC_NO_STAGE_TIMING para as remover.
+#ifndef VC_NO_STAGE_TIMING
+#define VC_STAGE_BEGIN(stage) unsigned long long vc_stage_t0_##stage = vc_stage_now()
+#define VC_STAGE_END(stage) vc_stage_record((stage), vc_stage_now() - vc_stage_t0_##stage)
+#else
+#define VC_STAGE_BEGIN(stage) ((void)0)
+#define VC_STAGE_END(stage) ((void)0)
+#endif
+
+#ifdef __cplusplus
+// Mede a etapa desde a construção até à destruição do objeto
+class VCStageTimer
+{
+public:
+	explicit VCStageTimer(int stage) : stage(stage), t0(vc_stage_now()) {}
+	~VCStageTimer() { vc_stage_record(stage, vc_stage_now() - t0); }
+
+	VCStageTimer(const VCStageTimer &) = delete;
+	VCStageTimer &operator=(const VCStageTimer &) = delete;
+
+private:
+	int stage;
+	unsigned long long t0;
+};
+#endif
+
+#endif // VC_STAGE_H
@@ -0,0 +1,261 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//          VÁRIOS VÍDEOS NUM SÓ POOL DE THREADS
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <thread>
+
+#include "vc_pipeline.hpp"
+#include "vc_source.hpp"
+#include "vc_stage.h"
+#include "vc_streams.hpp"
+
+struct VCStreamRunner::Stream
+{
+	std::string input;
+	unsigned long long budget; // ns; 0 = sem limite
+	VCVideoSource source;
+	std::unique_ptr<VCPipeline> pipeline;
+
+	// Buffers das frames (criados uma vez) e as filas dos livres e dos prontos (sob o mutex do runner)
+	std::vector<std::vector<unsigned char>> buffers;
+	std::deque<int> free;
+	std::deque<Ready> ready;
+	bool busy = false;
+	bool eof = false;
+	std::thread decoder;
+
+	// Medidas (sob o mutex do runner)
+	std::vector<unsigned long long> queuelat, totallat;
+	int skipped = 0, misses = 0;
+	long long detections = 0;
+	unsigned long long first = 0, last = 0;
+};
+
+VCStreamRunner::VCStreamRunner(VCThreadPool &pool, int nbuffers)
+	: pool(pool), nbuffers(nbuffers > 0 ? nbuffers : 1)
+{
+}
+
+VCStreamRunner::~VCStreamRunner()
+{
+	for (std::unique_ptr<Stream> &s : streams)
+		if (s->decoder.joinable())
+			s->decoder.join();
+}
+
+bool VCStreamRunner::add(const char *input, double budgetms, int apiPreference, const VCBlobFilter *filter)
+{
+	std::unique_ptr<Stream> s(new Stream);
+
+	if (!s->source.open(input, apiPreference))
+	{
+		printf("VCStreamRunner::add() - Erro ao abrir %s\n", input);
+		return false;
+	}
+	s->input = input;
+	s->budget = (budgetms > 0.0) ? (unsigned long long)(budgetms * 1e6) : 0;
+	s->pipeline.reset(new VCPipeline(s->source.width, s->source.height, pool));
+	if (filter != NULL)
+		s->pipeline->set_blob_filter(*filter);
+	s->buffers.assign(nbuffers, std::vector<unsigned char>((size_t)s->source.width * s->source.height * 3));
+	for (int b = 0; b < nbuffers; b++)
+		s->free.push_back(b);
+
+	streams.push_back(std::move(s));
+	return true;
+}
+
+void VCStreamRunner::decode_loop(Stream &s, int maxframes)
+{
+	size_t framesize = s.buffers[0].size();
+
+	for (int n = 0; (maxframes <= 0) || (n < maxframes); n++)
+	{
+		int buffer;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			changed.wait(lock, [&]
+						 { return !s.free.empty(); });
+			buffer = s.free.front();
+			s.free.pop_front();
+		}
+
+		IVC image;
+		bool read;
+		{
+			VCStageTimer timer(VC_STAGE_DECODE);
+			read = s.source.read(&image, false);
+			if (read)
+				memcpy(s.buffers[buffer].data(), image.data, framesize);
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!read)
+		{
+			s.free.push_back(buffer);
+			break;
+		}
+		s.ready.push_back({buffer, vc_stage_now()});
+		if (s.first == 0)
+			s.first = s.ready.back().t;
+		changed.notify_all();
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	s.eof = true;
+	changed.notify_all();
+}
+
+void VCStreamRunner::process(Stream &s, Ready frame)
+{
+	unsigned long long start = vc_stage_now();
+	{
+		VCStageTimer timer(VC_STAGE_FRAME);
+
+		IVC image = {s.buffers[frame.buffer].data(), s.source.width, s.source.height, 3, 255, s.source.width * 3};
+		s.pipeline->process(&image);
+	}
+	unsigned long long end = vc_stage_now();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	s.queuelat.push_back(start - frame.t);
+	s.totallat.push_back(end - frame.t);
+	if ((s.budget > 0) && (end - frame.t > s.budget))
+		s.misses++;
+	s.detections += (long long)s.pipeline->detections().size();
+	s.last = end;
+	s.free.push_back(frame.buffer);
+	s.busy = false;
+	inflight--;
+	changed.notify_all();
+}
+
+void VCStreamRunner::run(int maxframes)
+{
+	for (std::unique_ptr<Stream> &s : streams)
+		s->decoder = std::thread(&VCStreamRunner::decode_loop, this, std::ref(*s), maxframes);
+
+	// Uma frame por thread auxiliar do pool (esta thread só escolhe as frames); sem threads
+	// auxiliares, submit() processa a frame aqui
+	const int maxinflight = std::max(1, (int)pool.size() - 1);
+	std::vector<std::pair<Stream *, Ready>> dispatch;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;)
+	{
+		// Frames a entregar: a de limite mais próximo primeiro, de vídeos sem frame em processamento
+		dispatch.clear();
+		while (inflight < maxinflight)
+		{
+			Stream *best = nullptr;
+			unsigned long long bestdeadline = 0;
+			for (std::unique_ptr<Stream> &s : streams)
+			{
+				if (s->busy || s->ready.empty())
+					continue;
+				unsigned long long deadline = s->ready.front().t + s->budget;
+				if ((best == nullptr) || (deadline < bestdeadline))
+				{
+					best = s.get();
+					bestdeadline = deadline;
+				}
+			}
+			if (best == nullptr)
+				break;
+
+			// Frames que já passaram o limite dão lugar à mais recente
+			unsigned long long now = vc_stage_now();
+			Ready frame = best->ready.front();
+			best->ready.pop_front();
+			while ((best->budget > 0) && (now - frame.t > best->budget) && !best->ready.empty())
+			{
+				best->skipped++;
+				best->free.push_back(frame.buffer);
+				frame = best->ready.front();
+				best->ready.pop_front();
+			}
+
+			best->busy = true;
+			inflight++;
+			dispatch.emplace_back(best, frame);
+		}
+
+		if (!dispatch.empty())
+		{
+			// Os buffers libertados acordam as threads de descodificação
+			changed.notify_all();
+			lock.unlock();
+			for (std::pair<Stream *, Ready> &d : dispatch)
+			{
+				Stream *s = d.first;
+				Ready frame = d.second;
+				pool.submit([this, s, frame]
+							{ process(*s, frame); });
+			}
+			lock.lock();
+			continue;
+		}
+
+		bool finished = true;
+		for (std::unique_ptr<Stream> &s : streams)
+			finished = finished && s->eof && s->ready.empty() && !s->busy;
+		if (finished)
+			break;
+
+		changed.wait(lock);
+	}
+	lock.unlock();
+
+	for (std::unique_ptr<Stream> &s : streams)
+		s->decoder.join();
+}
+
+// Percentil (0-100) de latências em ns, em microssegundos
+static double vc_streams_percentile(std::vector<unsigned long long> values, double percentile)
+{
+	if (values.empty())
+		return 0.0;
+
+	size_t k = (size_t)(percentile / 100.0 * (values.size() - 1) + 0.5);
+	std::nth_element(values.begin(), values.begin() + k, values.end());
+	return values[k] / 1000.0;
+}
+
+VCStreamStats VCStreamRunner::stats(int stream) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	const Stream &s = *streams[stream];
+	VCStreamStats st;
+
+	st.frames = (int)s.queuelat.size();
+	st.skipped = s.skipped;
+	st.misses = s.misses;
+	st.detections = s.detections;
+	st.fps = (s.last > s.first) ? st.frames / ((s.last - s.first) / 1e9) : 0.0;
+	st.queue_p50 = vc_streams_percentile(s.queuelat, 50.0);
+	st.queue_p95 = vc_streams_percentile(s.queuelat, 95.0);
+	st.queue_p99 = vc_streams_percentile(s.queuelat, 99.0);
+	st.queue_max = vc_streams_percentile(s.queuelat, 100.0);
+	st.total_p50 = vc_streams_percentile(s.totallat, 50.0);
+	st.total_p99 = vc_streams_percentile(s.totallat, 99.0);
+
+	return st;
+}
+
+void VCStreamRunner::report(FILE *file) const
+{
+	fprintf(file, "%-6s %8s %8s %8s %10s %8s %10s %10s %10s %10s %10s %10s  %s\n", "stream", "frames", "skipped", "misses", "detections", "fps",
+			"queue p50", "queue p95", "queue p99", "queue max", "total p50", "total p99", "input");
+
+	for (int i = 0; i < count(); i++)
+	{
+		VCStreamStats s = stats(i);
+		fprintf(file, "%-6d %8d %8d %8d %10lld %8.1f %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f  %s\n", i, s.frames, s.skipped, s.misses, s.detections, s.fps,
+				s.queue_p50, s.queue_p95, s.queue_p99, s.queue_max, s.total_p50, s.total_p99, streams[i]->input.c_str());
+	}
+	fflush(file);
+}
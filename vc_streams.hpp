@@ -0,0 +1,77 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//          VÁRIOS VÍDEOS NUM SÓ POOL DE THREADS
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "vc_blobs.hpp"
+#include "vc_pool.hpp"
+
+// Medidas de um vídeo (latências em microssegundos, desde a frame estar descodificada)
+struct VCStreamStats
+{
+	int frames;		   // Frames processadas
+	int skipped;	   // Frames descartadas por já terem passado o limite antes de começarem
+	int misses;		   // Frames processadas que acabaram depois do limite
+	long long detections;
+	double fps;		   // Frames processadas por segundo, desde a primeira frame pronta
+	double queue_p50, queue_p95, queue_p99, queue_max; // Espera até começar o processamento
+	double total_p50, total_p99;					   // Até ao fim do processamento
+};
+
+// Processamento de vários vídeos (ex.: várias linhas de câmaras numa só máquina). Cada vídeo tem
+// uma thread de descodificação, os seus buffers de frames, o seu VCPipeline (com o seu tracker) e
+// no máximo uma frame em processamento (as frames de um vídeo são processadas pela ordem).
+// As frames prontas são entregues ao pool partilhado por ordem do limite de cada uma (chegada +
+// limite do vídeo; sem limite, por ordem de chegada), no máximo uma por thread do pool, para
+// nenhum vídeo ficar à espera atrás das frames de outro. A classificação dentro de cada frame
+// usa o mesmo pool (parallel_for dentro das tarefas).
+class VCStreamRunner
+{
+public:
+	// nbuffers: frames descodificadas à espera, por vídeo
+	explicit VCStreamRunner(VCThreadPool &pool, int nbuffers = 4);
+	~VCStreamRunner();
+
+	VCStreamRunner(const VCStreamRunner &) = delete;
+	VCStreamRunner &operator=(const VCStreamRunner &) = delete;
+
+	// Abrir um vídeo (ou sequência de frames). budgetms: tempo máximo desde a frame estar pronta
+	// até ao fim do processamento; uma frame que já o ultrapassou antes de começar é descartada
+	// se houver uma mais recente. 0 = sem limite (todas as frames são processadas).
+	// filter: regras dos blobs candidatos (NULL = as do VCPipeline).
+	bool add(const char *input, double budgetms, int apiPreference, const VCBlobFilter *filter = NULL);
+	// Processar todos os vídeos até ao fim (ou até maxframes frames de cada um)
+	void run(int maxframes = 0);
+
+	int count() const { return (int)streams.size(); }
+	VCStreamStats stats(int stream) const;
+	// Tabela com uma linha por vídeo
+	void report(FILE *file) const;
+
+private:
+	struct Stream;
+	struct Ready
+	{
+		int buffer;
+		unsigned long long t; // Instante em que ficou pronta
+	};
+
+	void decode_loop(Stream &s, int maxframes);
+	void process(Stream &s, Ready frame);
+
+	VCThreadPool &pool;
+	int nbuffers;
+	std::vector<std::unique_ptr<Stream>> streams;
+
+	// Estado das filas de todos os vídeos
+	mutable std::mutex mutex;
+	std::condition_variable changed;
+	int inflight = 0;
+};
@@ -0,0 +1,121 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//        TESTE DE VÁRIOS VÍDEOS NUM SÓ POOL DE THREADS
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+//   vc_streams_test <vídeo>    teste automático (ctest): as primeiras frames do vídeo são gravadas
+//                              numa sequência em bruto e VCStreamRunner processa várias cópias
+//                              (e o próprio vídeo). Sem limite, todas as frames de cada vídeo são
+//                              processadas, com as mesmas deteções que um vídeo sozinho; com um
+//                              limite muito pequeno, as frames atrasadas são descartadas.
+
+#include <filesystem>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "vc_streams.hpp"
+#include "vc_source.hpp"
+#include "vc_test.h"
+
+// Frames de cada vídeo
+#define NFRAMES 40
+
+static const char *video = NULL;
+static std::string sequence;
+
+// As primeiras NFRAMES frames do vídeo numa sequência em bruto (lida sem descodificação)
+static bool record_sequence(void)
+{
+	VCVideoSource source;
+	CHECK(source.open(video, cv::CAP_ANY), "o vídeo não abre: " << video);
+
+	sequence = (std::filesystem::temp_directory_path() / "vc_streams_test.vcf").string();
+	VCFrameWriter writer;
+	CHECK(writer.open(sequence.c_str(), source.width, source.height, 3, source.fps), "open de " << sequence);
+	IVC image;
+	for (int n = 0; n < NFRAMES; n++)
+	{
+		CHECK(source.read(&image, false), "o vídeo tem menos de " << NFRAMES << " frames");
+		CHECK(writer.write(&image), "escrita da frame " << n);
+	}
+	CHECK(writer.close(), "close de " << sequence);
+	return true;
+}
+
+// Deteções de um vídeo processado sozinho
+static long long single_detections(void)
+{
+	VCThreadPool pool(4);
+	VCStreamRunner runner(pool);
+
+	if (!runner.add(sequence.c_str(), 0.0, cv::CAP_ANY))
+		return -1;
+	runner.run();
+	return runner.stats(0).detections;
+}
+
+// Sem limite: duas cópias da sequência e o vídeo, todas as frames processadas e as deteções de
+// cada um iguais às de um vídeo sozinho
+static bool test_no_budget(void)
+{
+	long long expected = single_detections();
+	CHECK(expected > 0, "sem deteções no vídeo sozinho (" << expected << ")");
+
+	VCThreadPool pool(4);
+	VCStreamRunner runner(pool);
+	const char *inputs[] = {sequence.c_str(), sequence.c_str(), video};
+	for (const char *input : inputs)
+		CHECK(runner.add(input, 0.0, cv::CAP_ANY), "add de " << input);
+	runner.run(NFRAMES);
+
+	for (int i = 0; i < runner.count(); i++)
+	{
+		VCStreamStats s = runner.stats(i);
+		CHECK((s.frames == NFRAMES) && (s.skipped == 0) && (s.misses == 0),
+			  "vídeo " << i << ": " << s.frames << " frames, " << s.skipped << " descartadas, " << s.misses << " atrasadas");
+		CHECK(s.detections == expected, "vídeo " << i << ": " << s.detections << " deteções, " << expected << " sozinho");
+	}
+
+	printf("no budget: %d vídeos x %d frames, %lld deteções em cada\n", runner.count(), NFRAMES, expected);
+	return true;
+}
+
+// Limite de 1 us (menos do que qualquer frame demora): as frames que esperam são descartadas em
+// favor da mais recente, em vez de se acumularem; cada frame é processada ou descartada uma vez
+static bool test_tiny_budget(void)
+{
+	VCThreadPool pool(4);
+	VCStreamRunner runner(pool);
+	for (int i = 0; i < 3; i++)
+		CHECK(runner.add(sequence.c_str(), 0.001, cv::CAP_ANY), "add de " << sequence);
+	runner.run();
+
+	int skipped = 0;
+	for (int i = 0; i < runner.count(); i++)
+	{
+		VCStreamStats s = runner.stats(i);
+		CHECK(s.frames + s.skipped == NFRAMES, "vídeo " << i << ": " << s.frames << " processadas + " << s.skipped << " descartadas != " << NFRAMES);
+		CHECK((s.frames > 0) && (s.misses == s.frames), "vídeo " << i << ": " << s.frames << " processadas, " << s.misses << " atrasadas");
+		skipped += s.skipped;
+	}
+	CHECK(skipped > 0, "nenhuma frame descartada com o limite de 1 us");
+
+	printf("tiny budget: %d de %d frames descartadas\n", skipped, runner.count() * NFRAMES);
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 2)
+	{
+		std::cerr << "Uso: " << argv[0] << " <vídeo>\n";
+		return 2;
+	}
+	video = argv[1];
+
+	if (!record_sequence())
+		return 1;
+	int ret = vc_test_run({test_no_budget, test_tiny_budget});
+	std::remove(sequence.c_str());
+	return ret;
+}
@@ -0,0 +1,34 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//              VERIFICAÇÕES DOS TESTES AUTOMÁTICOS
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+// Cada teste é uma função bool test_xxx(void) que termina com false na primeira verificação que
+// falha; o main de cada executável corre todos os testes, mesmo depois de uma falha.
+
+#ifndef VC_TEST_H
+#define VC_TEST_H
+
+#include <initializer_list>
+#include <iostream>
+
+#define CHECK(cond, msg)                           \
+	do                                             \
+	{                                              \
+		if (!(cond))                               \
+		{                                          \
+			std::cerr << "FALHOU: " << msg << "\n"; \
+			return false;                          \
+		}                                          \
+	} while (0)
+
+// Correr os testes por ordem; código de saída do programa (0 se todos passarem)
+inline int vc_test_run(std::initializer_list<bool (*)(void)> tests)
+{
+	bool ok = true;
+
+	for (bool (*test)(void) : tests)
+		ok = test() && ok;
+	return ok ? 0 : 1;
+}
+
+#endif
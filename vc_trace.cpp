@@ -0,0 +1,133 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//         REGISTO DE EVENTOS (CHROME TRACE / PERFETTO)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <vector>
+
+#include "vc_trace.h"
+
+// Eventos guardados por thread (potência de 2); quando o anel enche, perdem-se os mais antigos
+#define VC_TRACE_RING (1 << 16)
+
+struct VCTraceEvent
+{
+	unsigned long long t0;
+	unsigned long long ns;
+	const char *name;
+	int nframe;
+};
+
+// Anel de uma thread: só a própria thread escreve, por isso não precisa de locks.
+// A escrita do ficheiro lê até head (publicado com release).
+struct VCTraceRing
+{
+	int tid;
+	std::atomic<unsigned long long> head{0};
+	VCTraceEvent events[VC_TRACE_RING];
+};
+
+std::atomic<bool> vc_trace_active{false};
+
+static std::atomic<int> trace_frame{0};
+static std::atomic<unsigned long long> trace_epoch{0};
+
+// Os anéis ficam vivos até ao fim do programa (as threads do pool podem terminar antes da escrita)
+static std::mutex rings_mutex;
+static std::vector<std::unique_ptr<VCTraceRing>> rings;
+
+static VCTraceRing *thread_ring(void)
+{
+	static thread_local VCTraceRing *ring = nullptr;
+
+	if (ring == nullptr)
+	{
+		std::unique_ptr<VCTraceRing> r(new VCTraceRing);
+		std::lock_guard<std::mutex> lock(rings_mutex);
+		r->tid = (int)rings.size() + 1;
+		ring = r.get();
+		rings.push_back(std::move(r));
+	}
+
+	return ring;
+}
+
+extern "C" int vc_trace_start(void)
+{
+	std::lock_guard<std::mutex> lock(rings_mutex);
+
+	for (auto &r : rings)
+		r->head.store(0, std::memory_order_relaxed);
+	trace_epoch.store(vc_stage_now(), std::memory_order_relaxed);
+	vc_trace_active.store(true, std::memory_order_release);
+
+	return 1;
+}
+
+extern "C" void vc_trace_frame(int nframe)
+{
+	trace_frame.store(nframe, std::memory_order_relaxed);
+}
+
+extern "C" void vc_trace_complete(const char *name, unsigned long long t0, unsigned long long ns)
+{
+	if (!vc_trace_active.load(std::memory_order_relaxed))
+		return;
+
+	VCTraceRing *ring = thread_ring();
+	unsigned long long head = ring->head.load(std::memory_order_relaxed);
+	VCTraceEvent &e = ring->events[head & (VC_TRACE_RING - 1)];
+
+	e.t0 = t0;
+	e.ns = ns;
+	e.name = name;
+	e.nframe = trace_frame.load(std::memory_order_relaxed);
+	ring->head.store(head + 1, std::memory_order_release);
+}
+
+extern "C" int vc_trace_write(const char *filename)
+{
+	// Parar o registo antes de ler os anéis (chamar com o pipeline parado)
+	vc_trace_active.store(false, std::memory_order_seq_cst);
+
+	FILE *file = fopen(filename, "w");
+	if (file == NULL)
+	{
+		printf("vc_trace_write() - Erro ao abrir o ficheiro %s\n", filename);
+		return 0;
+	}
+
+	unsigned long long epoch = trace_epoch.load(std::memory_order_relaxed);
+	bool first = true;
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	std::lock_guard<std::mutex> lock(rings_mutex);
+	for (auto &r : rings)
+	{
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}", first ? "" : ",\n", r->tid, r->tid);
+		first = false;
+
+		unsigned long long head = r->head.load(std::memory_order_acquire);
+		unsigned long long start = (head > VC_TRACE_RING) ? head - VC_TRACE_RING : 0;
+
+		for (unsigned long long i = start; i < head; i++)
+		{
+			const VCTraceEvent &e = r->events[i & (VC_TRACE_RING - 1)];
+			if (e.t0 < epoch)
+				continue;
+
+			// Eventos completos (ph X): início e duração em microssegundos
+			fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%d}}",
+					e.name, r->tid, (e.t0 - epoch) / 1000.0, e.ns / 1000.0, e.nframe);
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	return 1;
+}
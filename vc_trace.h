@@ -0,0 +1,61 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//         REGISTO DE EVENTOS (CHROME TRACE / PERFETTO)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#ifndef VC_TRACE_H
+#define VC_TRACE_H
+
+#include "vc_stage.h"
+
+#ifdef __cplusplus
+#include <atomic>
+
+extern "C"
+{
+#endif
+
+	// Começar a registar eventos (os eventos anteriores são descartados)
+	int vc_trace_start(void);
+	// Parar o registo e escrever os eventos em JSON (formato Chrome trace, abre no Perfetto)
+	int vc_trace_write(const char *filename);
+	// Registar um evento com início e duração em nanossegundos (relógio de vc_stage_now()).
+	// O nome tem de ser uma string constante: só o ponteiro é guardado.
+	void vc_trace_complete(const char *name, unsigned long long t0, unsigned long long ns);
+	// Número da frame associado aos eventos seguintes
+	void vc_trace_frame(int nframe);
+
+#ifdef __cplusplus
+}
+
+// Verdadeiro entre vc_trace_start() e vc_trace_write(); desligado custa só este teste
+extern std::atomic<bool> vc_trace_active;
+
+// Regista um evento desde a construção até à destruição do objeto (se o registo estiver ativo)
+class VCTraceScope
+{
+public:
+	explicit VCTraceScope(const char *name) : name(name), t0(0)
+	{
+#ifndef VC_NO_TRACE
+		if (vc_trace_active.load(std::memory_order_relaxed))
+			t0 = vc_stage_now();
+#endif
+	}
+	~VCTraceScope()
+	{
+#ifndef VC_NO_TRACE
+		if (t0 != 0)
+			vc_trace_complete(name, t0, vc_stage_now() - t0);
+#endif
+	}
+
+	VCTraceScope(const VCTraceScope &) = delete;
+	VCTraceScope &operator=(const VCTraceScope &) = delete;
+
+private:
+	const char *name;
+	unsigned long long t0;
+};
+#endif
+
+#endif // VC_TRACE_H
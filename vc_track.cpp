@@ -0,0 +1,120 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//             SEGUIMENTO DAS RESISTÊNCIAS (TRACKS)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include <algorithm>
+
+#include "vc_pipeline.hpp"
+#include "vc_track.hpp"
+
+// Interseção sobre união de duas caixas
+static float vc_track_overlap(int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh)
+{
+	int iw = MIN_VC(ax + aw, bx + bw) - MAX_VC(ax, bx);
+	int ih = MIN_VC(ay + ah, by + bh) - MAX_VC(ay, by);
+	if ((iw <= 0) || (ih <= 0))
+		return 0.0f;
+
+	float inter = (float)iw * ih;
+	return inter / ((float)aw * ah + (float)bw * bh - inter);
+}
+
+void VCTracker::update(std::vector<VCDetection> &detections)
+{
+	// Pares deteção/track com sobreposição suficiente, do maior para o menor
+	matches.clear();
+	for (int i = 0; i < (int)detections.size(); i++)
+	{
+		const OVC &b = detections[i].blob;
+		for (int t = 0; t < (int)tracks.size(); t++)
+		{
+			const Track &tr = tracks[t];
+			float overlap = vc_track_overlap(b.x, b.y, b.width, b.height, tr.x + tr.dx, tr.y + tr.dy, tr.width, tr.height);
+			if (overlap >= minoverlap)
+				matches.push_back({overlap, i, t});
+		}
+	}
+	std::sort(matches.begin(), matches.end(), [](const Match &a, const Match &b)
+			  { return a.overlap > b.overlap; });
+
+	// Associação gulosa: cada deteção e cada track no máximo uma vez
+	for (VCDetection &d : detections)
+		d.track = 0;
+	matched.assign(tracks.size(), 0);
+	for (const Match &m : matches)
+	{
+		VCDetection &d = detections[m.detection];
+		Track &tr = tracks[m.track];
+		if ((d.track != 0) || matched[m.track])
+			continue;
+
+		d.track = tr.id;
+		matched[m.track] = 1;
+		tr.dx = d.blob.x - tr.x;
+		tr.dy = d.blob.y - tr.y;
+		tr.x = d.blob.x;
+		tr.y = d.blob.y;
+		tr.width = d.blob.width;
+		tr.height = d.blob.height;
+		tr.missed = 0;
+		tr.blob = d.blob;
+		tr.resistor = d.resistor;
+		tr.decoded = d.decoded;
+	}
+
+	// Tracks sem deteção envelhecem (e mantêm a previsão do deslocamento)
+	int n = 0;
+	for (int t = 0; t < (int)tracks.size(); t++)
+	{
+		if (!matched[t])
+		{
+			tracks[t].missed++;
+			tracks[t].x += tracks[t].dx;
+			tracks[t].y += tracks[t].dy;
+		}
+		if (tracks[t].missed <= maxmissed)
+			tracks[n++] = tracks[t];
+	}
+	tracks.resize(n);
+
+	// Deteções novas
+	for (VCDetection &d : detections)
+	{
+		if (d.track == 0)
+		{
+			d.track = nextid++;
+			tracks.push_back({d.track, d.blob.x, d.blob.y, d.blob.width, d.blob.height, 0, 0, 0, d.blob, d.resistor, d.decoded});
+		}
+	}
+}
+
+void VCTracker::predict(std::vector<VCDetection> &detections)
+{
+	detections.clear();
+
+	for (Track &tr : tracks)
+	{
+		tr.x += tr.dx;
+		tr.y += tr.dy;
+		if (tr.missed != 0)
+			continue;
+
+		// Última deteção com a caixa (e o centro de gravidade) na posição prevista
+		VCDetection d = {};
+		d.blob = tr.blob;
+		d.blob.x = tr.x;
+		d.blob.y = tr.y;
+		d.blob.xc += tr.x - tr.blob.x;
+		d.blob.yc += tr.y - tr.blob.y;
+		d.resistor = tr.resistor;
+		d.decoded = tr.decoded;
+		d.track = tr.id;
+		detections.push_back(d);
+	}
+}
+
+void VCTracker::reset()
+{
+	tracks.clear();
+	nextid = 1;
+}
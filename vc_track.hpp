@@ -0,0 +1,55 @@
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//             SEGUIMENTO DAS RESISTÊNCIAS (TRACKS)
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#pragma once
+
+#include <vector>
+
+extern "C"
+{
+#include "vc.h"
+}
+
+struct VCDetection;
+
+// Identificador estável de cada resistência ao longo das frames: cada deteção é associada ao
+// track com maior sobreposição (IoU) entre a sua caixa e a caixa prevista do track (última caixa
+// mais o último deslocamento). Um track sem deteção durante mais de maxmissed frames termina.
+class VCTracker
+{
+public:
+	explicit VCTracker(int maxmissed = 5, float minoverlap = 0.3f) : maxmissed(maxmissed), minoverlap(minoverlap) {}
+
+	// Preenche VCDetection::track (identificadores a partir de 1) com as deteções de uma frame
+	void update(std::vector<VCDetection> &detections);
+	// Frame sem deteção (ex.: deteção só em algumas frames): detections passa a ter a última
+	// deteção de cada track visível, deslocada pela previsão. Não conta como frame perdida.
+	void predict(std::vector<VCDetection> &detections);
+	void reset();
+
+private:
+	struct Track
+	{
+		int id;
+		int x, y, width, height;
+		int dx, dy; // Deslocamento na última associação
+		int missed;
+		// Última deteção associada (para as frames sem deteção)
+		OVC blob;
+		RVC resistor;
+		int decoded;
+	};
+	struct Match
+	{
+		float overlap;
+		int detection, track;
+	};
+
+	int maxmissed;
+	float minoverlap;
+	int nextid = 1;
+	std::vector<Track> tracks;
+	std::vector<Match> matches;
+	std::vector<char> matched;
+};